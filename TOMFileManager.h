@@ -13,6 +13,461 @@
 
 
 NS_ASSUME_NONNULL_BEGIN
+/*!
+ @typedef TOMFileSearchOptions
+ 
+ @brief Options for @c enumerateFilesMatchingPattern:inDirectory:options:usingBlock:.
+ 
+ @constant TOMFileSearchOptionsNone The pattern is a case sensitive glob, and every file is searched.
+ @constant TOMFileSearchOptionsRegularExpression The pattern is a POSIX extended regular expression instead of a glob.
+ @constant TOMFileSearchOptionsCaseInsensitive The pattern ignores case.
+ @constant TOMFileSearchOptionsSkipHiddenFiles Files and directories whose names begin with a period are skipped, along with everything inside them.
+ @constant TOMFileSearchOptionsSkipPackageContents Packages (like @c .app and @c .bundle directories) are matched like files, but never searched inside.
+ */
+typedef NS_OPTIONS(NSUInteger, TOMFileSearchOptions)
+{
+	TOMFileSearchOptionsNone = 0,
+	TOMFileSearchOptionsRegularExpression = 1 << 0,
+	TOMFileSearchOptionsCaseInsensitive = 1 << 1,
+	TOMFileSearchOptionsSkipHiddenFiles = 1 << 2,
+	TOMFileSearchOptionsSkipPackageContents = 1 << 3
+};
+
+
+
+
+/*!
+ @typedef TOMCopyStrategy
+ 
+ @brief How a copy or move got its data to the destination, as reported by @c TOMTransferReport.
+ 
+ @constant TOMCopyStrategyNone No single strategy applies (like a directory copy), or nothing was copied.
+ @constant TOMCopyStrategyClone The file was cloned, so its data is shared with the original until either one changes. Takes about the same time for any file size.
+ @constant TOMCopyStrategyCopyfile The item was a symbolic link or special file, which has no data to copy, so it was recreated by @c copyfile(3) because the volume can't clone.
+ @constant TOMCopyStrategyReadWrite The data was read and written in large chunks, bypassing the buffer cache, because the volume can't clone. The permissions, times and extended attributes were then copied by @c fcopyfile(3).
+ @constant TOMCopyStrategyRename The item was moved with a single atomic rename, so no data was copied.
+ @constant TOMCopyStrategyCopyAndDelete The item was on another volume, so it was copied to the destination and then deleted.
+ */
+typedef NS_ENUM(NSInteger, TOMCopyStrategy)
+{
+	TOMCopyStrategyNone = 0,
+	TOMCopyStrategyClone,
+	TOMCopyStrategyCopyfile,
+	TOMCopyStrategyReadWrite,
+	TOMCopyStrategyRename,
+	TOMCopyStrategyCopyAndDelete
+};
+
+
+
+
+/*!
+ @typedef TOMDeleteMode
+ 
+ @brief How @c deleteDirectory:mode: deletes a directory.
+ 
+ @constant TOMDeleteModeStandard The directory is deleted on the calling thread, the same as @c deleteDirectory: .
+ @constant TOMDeleteModeParallel The directory's subdirectories are deleted in parallel by a pool of workers, and the call returns once everything is gone.
+ @constant TOMDeleteModeDeferred The directory is moved into a hidden purge area in the Library Directory's Caches, and the call returns straight away. Its contents are deleted by a low priority background worker, which picks up where it left off if the app is killed first.
+ */
+typedef NS_ENUM(NSInteger, TOMDeleteMode)
+{
+	TOMDeleteModeStandard = 0,
+	TOMDeleteModeParallel,
+	TOMDeleteModeDeferred
+};
+
+
+
+
+/*!
+ @typedef TOMRenameOptions
+ 
+ @brief Options for @c renameDirectoryAtPath:to:options:.
+ 
+ @constant TOMRenameOptionsNone An existing empty directory with the new name is replaced.
+ @constant TOMRenameOptionsNoReplace The rename fails if anything with the new name already exists.
+ @constant TOMRenameOptionsExchange The directory and whatever has the new name swap places in one atomic step. Both must exist.
+ */
+typedef NS_OPTIONS(NSUInteger, TOMRenameOptions)
+{
+	TOMRenameOptionsNone = 0,
+	TOMRenameOptionsNoReplace = 1 << 0,
+	TOMRenameOptionsExchange = 1 << 1
+};
+
+
+
+
+/*!
+ @typedef TOMFileOperationType
+ 
+ @brief What a @c TOMFileOperation does.
+ 
+ @constant TOMFileOperationTypeCopy Copies a file or directory into a directory.
+ @constant TOMFileOperationTypeMove Moves a file or directory into a directory.
+ @constant TOMFileOperationTypeDelete Deletes a file or directory.
+ */
+typedef NS_ENUM(NSInteger, TOMFileOperationType)
+{
+	TOMFileOperationTypeCopy = 0,
+	TOMFileOperationTypeMove,
+	TOMFileOperationTypeDelete
+};
+
+
+
+
+/*!
+ @typedef TOMLogLevel
+ 
+ @brief How much a @c TOMFileManager logs.
+ 
+ @constant TOMLogLevelNone Nothing is logged.
+ @constant TOMLogLevelError Only errors are logged.
+ @constant TOMLogLevelInfo Errors, and what each method is doing, are logged.
+ @constant TOMLogLevelDebug Everything is logged, including the most likely reason for each error.
+ */
+typedef NS_ENUM(NSInteger, TOMLogLevel)
+{
+	TOMLogLevelNone = 0,
+	TOMLogLevelError,
+	TOMLogLevelInfo,
+	TOMLogLevelDebug
+};
+
+
+
+
+/*!
+ @typedef TOMCountOptions
+ 
+ @brief Options for @c numberOfItemsInDirectoryAtPath:options:.
+ 
+ @discussion If none of @c TOMCountOptionsFiles , @c TOMCountOptionsDirectories , or @c TOMCountOptionsSymbolicLinks is set, every type of item is counted.
+ 
+ @constant TOMCountOptionsNone Every item directly inside the directory is counted.
+ @constant TOMCountOptionsRecursive Items inside subdirectories are counted too.
+ @constant TOMCountOptionsFiles Regular files are counted.
+ @constant TOMCountOptionsDirectories Directories are counted.
+ @constant TOMCountOptionsSymbolicLinks Symbolic links are counted.
+ @constant TOMCountOptionsSkipHiddenFiles Items whose names begin with a period aren't counted, and neither is anything inside them.
+ */
+typedef NS_OPTIONS(NSUInteger, TOMCountOptions)
+{
+	TOMCountOptionsNone = 0,
+	TOMCountOptionsRecursive = 1 << 0,
+	TOMCountOptionsFiles = 1 << 1,
+	TOMCountOptionsDirectories = 1 << 2,
+	TOMCountOptionsSymbolicLinks = 1 << 3,
+	TOMCountOptionsSkipHiddenFiles = 1 << 4
+};
+
+
+
+
+/*!
+ @typedef TOMSyncOptions
+ 
+ @brief Options for @c syncDirectoryFrom:to:options:report:.
+ 
+ @constant TOMSyncOptionsNone A file is taken as unchanged if it has the same size and modification time in both directories.
+ @constant TOMSyncOptionsCompareContents Files of the same size are compared byte for byte instead of by modification time. Slower, but catches changes that kept the time, and doesn't recopy files that were only touched.
+ @constant TOMSyncOptionsDeleteExtraneous Anything in the destination that isn't in the source is deleted.
+ */
+typedef NS_OPTIONS(NSUInteger, TOMSyncOptions)
+{
+	TOMSyncOptionsNone = 0,
+	TOMSyncOptionsCompareContents = 1 << 0,
+	TOMSyncOptionsDeleteExtraneous = 1 << 1
+};
+
+
+
+
+/*!
+ @typedef TOMHashAlgorithm
+ 
+ @brief The algorithms @c hashOfFileAtPath:algorithm: can fingerprint a file with.
+ 
+ @constant TOMHashAlgorithmXXH64 XXH64, with a seed of 0. A fast 64 bit hash for telling files apart - not for security. The digest is 8 bytes, most significant first.
+ @constant TOMHashAlgorithmCRC32C CRC-32C (Castagnoli), computed with the CPU's CRC instructions where available. For detecting corruption - not for security. The digest is 4 bytes, most significant first.
+ @constant TOMHashAlgorithmSHA256 SHA-256. Much slower than the others, but cryptographically secure. The digest is 32 bytes.
+ */
+typedef NS_ENUM(NSInteger, TOMHashAlgorithm)
+{
+	TOMHashAlgorithmXXH64 = 0,
+	TOMHashAlgorithmCRC32C,
+	TOMHashAlgorithmSHA256
+};
+
+
+
+
+/*!
+ @typedef TOMLinkType
+ 
+ @brief How @c replaceDuplicateFilesInGroups:withLinkType: makes duplicates share their data.
+ 
+ @constant TOMLinkTypeHardLink Each duplicate becomes another name for the same file. Writing through one name changes the contents under every name, and they all share one set of permissions and times.
+ @constant TOMLinkTypeClone Each duplicate becomes a copy-on-write clone, which shares its data until one of them is written to, and keeps its own permissions and times. Needs an APFS volume.
+ */
+typedef NS_ENUM(NSInteger, TOMLinkType)
+{
+	TOMLinkTypeHardLink = 0,
+	TOMLinkTypeClone
+};
+
+
+
+
+/*!
+ @typedef TOMWriteOptions
+ 
+ @brief How @c writeData:toFileAtPath:options: writes a file, and how durable the write is once it returns.
+ 
+ @constant TOMWriteOptionsNone The file is truncated and written in place. A crash part way through can leave it holding part of the data, and the data may still only be in memory when the method returns.
+ @constant TOMWriteOptionsAtomic The data is written to a temporary file, which is flushed all the way to the disk and renamed over the file. The file always holds either all of the old data or all of the new, and the new data survives a crash once the method returns.
+ @constant TOMWriteOptionsGroupCommit The same as @c TOMWriteOptionsAtomic , but the flush that makes a write durable is shared with every other write that finishes around the same time. Each write still waits for its flush, so this only pays off when many writes happen at once.
+ */
+typedef NS_OPTIONS(NSUInteger, TOMWriteOptions)
+{
+	TOMWriteOptionsNone = 0,
+	TOMWriteOptionsAtomic = 1 << 0,
+	TOMWriteOptionsGroupCommit = 1 << 1
+};
+
+
+
+
+/*!
+ @class TOMTransferReport
+ 
+ @brief How much a copy moved, and how fast.
+ 
+ @discussion Returned through the @c report parameter of the copy and move methods that take one.
+ */
+@interface TOMTransferReport : NSObject
+
+/*! @brief The number of files (and symbolic links) that were copied or moved. */
+@property (readonly, nonatomic) NSUInteger numberOfFiles;
+
+/*! @brief The number of bytes of file data that were copied. Zero for a move done by renaming. */
+@property (readonly, nonatomic) unsigned long long numberOfBytes;
+
+/*! @brief How long the copy took, in seconds. */
+@property (readonly, nonatomic) NSTimeInterval duration;
+
+/*! @brief @c numberOfFiles divided by @c duration. */
+@property (readonly, nonatomic) double filesPerSecond;
+
+/*! @brief @c numberOfBytes divided by @c duration. */
+@property (readonly, nonatomic) double bytesPerSecond;
+
+/*! @brief How the data got to the destination. Directory copies report @c TOMCopyStrategyNone. */
+@property (readonly, nonatomic) TOMCopyStrategy strategy;
+
+@end
+
+
+
+
+/*!
+ @class TOMFileOperation
+ 
+ @brief One copy, move or delete, to be run as part of a batch by @c performOperations: .
+ */
+@interface TOMFileOperation : NSObject
+
+/*! @brief What the operation does. */
+@property (readonly, nonatomic) TOMFileOperationType type;
+
+/*! @brief The path of the file or directory to copy, move or delete. */
+@property (readonly, nonatomic) NSString *sourcePath;
+
+/*! @brief The path of the directory to copy or move into, or @c nil for a delete. */
+@property (readonly, nonatomic, nullable) NSString *destinationDirectoryPath;
+
+
+/*! @brief An operation that copies the file or directory at @c sourcePath into @c destinationDirectoryPath. */
++ (instancetype)copyOperationFromPath:(NSString *)sourcePath to:(NSString *)destinationDirectoryPath;
+
+/*! @brief An operation that moves the file or directory at @c sourcePath into @c destinationDirectoryPath. */
++ (instancetype)moveOperationFromPath:(NSString *)sourcePath to:(NSString *)destinationDirectoryPath;
+
+/*! @brief An operation that deletes the file or directory at @c path. */
++ (instancetype)deleteOperationAtPath:(NSString *)path;
+
+@end
+
+
+
+
+/*!
+ @class TOMBatchReport
+ 
+ @brief The results of a batch of operations run by @c performOperations: .
+ */
+@interface TOMBatchReport : NSObject
+
+/*! @brief One @c BOOL per operation, in the order the operations were given: @c YES if it succeeded, and @c NO if an error occured. */
+@property (readonly, nonatomic) NSArray<NSNumber *> *results;
+
+/*! @brief The number of operations that succeeded. */
+@property (readonly, nonatomic) NSUInteger numberOfSucceededOperations;
+
+/*! @brief The number of operations that failed. */
+@property (readonly, nonatomic) NSUInteger numberOfFailedOperations;
+
+/*! @brief The number of stages the batch was split into. Operations in the same stage ran at the same time. */
+@property (readonly, nonatomic) NSUInteger numberOfStages;
+
+/*! @brief How long the whole batch took, in seconds. */
+@property (readonly, nonatomic) NSTimeInterval duration;
+
+@end
+
+
+
+
+/*!
+ @class TOMDirectorySize
+ 
+ @brief How much space a directory and everything inside it takes up, as returned by @c sizeOfDirectoryAtPath: .
+ */
+@interface TOMDirectorySize : NSObject
+
+/*! @brief The combined length of every regular file, in bytes. */
+@property (readonly, nonatomic) unsigned long long logicalSize;
+
+/*! @brief The number of bytes actually allocated on disk, for every file, link and directory - including the directory itself. Sparse and compressed files take up less than their length, and every file takes up at least one block. */
+@property (readonly, nonatomic) unsigned long long allocatedSize;
+
+/*! @brief The number of regular files. */
+@property (readonly, nonatomic) NSUInteger numberOfFiles;
+
+/*! @brief The number of directories, not counting the directory itself. */
+@property (readonly, nonatomic) NSUInteger numberOfDirectories;
+
+@end
+
+
+
+
+/*!
+ @class TOMSyncReport
+ 
+ @brief What a sync copied, and what it could leave alone.
+ 
+ @discussion Returned through the @c report parameter of @c syncDirectoryFrom:to:options:report: .
+ */
+@interface TOMSyncReport : NSObject
+
+/*! @brief The number of files (and symbolic links) that were new or changed, and so were copied. */
+@property (readonly, nonatomic) NSUInteger numberOfFilesCopied;
+
+/*! @brief The number of bytes of file data that were copied. */
+@property (readonly, nonatomic) unsigned long long numberOfBytesCopied;
+
+/*! @brief The number of files (and symbolic links) that were already up to date. */
+@property (readonly, nonatomic) NSUInteger numberOfFilesSkipped;
+
+/*! @brief The number of bytes of file data that didn't need copying. */
+@property (readonly, nonatomic) unsigned long long numberOfBytesSkipped;
+
+/*! @brief The number of files and directories deleted from the destination. A deleted directory counts once, however much was inside it. */
+@property (readonly, nonatomic) NSUInteger numberOfItemsDeleted;
+
+/*! @brief How long the sync took, in seconds. */
+@property (readonly, nonatomic) NSTimeInterval duration;
+
+@end
+
+
+
+
+/*!
+ @class TOMBufferedFileWriter
+ 
+ @brief Appends to a file through a buffer in memory, so many small records cost one system call.
+ 
+ @discussion Returned by @c bufferedWriterForFileAtPath: . The file stays open for as long as the writer does. Appended data is gathered in the buffer and written out in one go when the buffer fills up, once @c flushInterval has passed since the first append that hasn't been written yet, when @c flush or @c synchronize is called, and when the writer is closed or deallocated.
+ 
+ @note
+ • Every method is safe to call from any thread. Each append reaches the file whole, and in the order the appends were made.
+ 
+ • Appended data that is still in the buffer is lost if the app crashes. Call @c synchronize after records that must survive a crash.
+ */
+@interface TOMBufferedFileWriter : NSObject
+
+/*! @brief The path of the file being appended to. */
+@property (readonly, nonatomic) NSString *filePath;
+
+/*! @brief How many bytes are gathered before they are written out. Anything at least this big is written straight through. */
+@property (readonly, nonatomic) NSUInteger bufferSize;
+
+/*! @brief How long appended data waits in the buffer at most, in seconds. @c 0 means it waits until the buffer fills up or is flushed. */
+@property (readonly, nonatomic) NSTimeInterval flushInterval;
+
+
+/*!
+ @brief Appends @c data to the end of the file.
+ 
+ @param data The data you'd like to append.
+ 
+ @return @c BOOL - @c YES if the data was appended, and @c NO if the writer is closed or the buffer couldn't be written out.
+ */
+- (BOOL)appendData:(NSData *)data;
+
+
+/*!
+ @brief Appends @c string to the end of the file, encoded as UTF-8.
+ 
+ @code
+ [telemetryWriter appendString:[NSString stringWithFormat:@"%@ launched\n", [NSDate date]]];
+ @endcode
+ 
+ @param string The string you'd like to append.
+ 
+ @return @c BOOL - @c YES if the string was appended, and @c NO if the writer is closed or the buffer couldn't be written out.
+ */
+- (BOOL)appendString:(NSString *)string;
+
+
+/*!
+ @brief Writes out everything in the buffer.
+ 
+ @discussion Once this returns, other processes reading the file see every append made before it. The data may still only be in memory, and can be lost if the device loses power.
+ 
+ @return @c BOOL - @c YES if the buffer was written out, or was empty, and @c NO if an error occured.
+ */
+- (BOOL)flush;
+
+
+/*!
+ @brief Writes out everything in the buffer, and flushes the file all the way to the disk.
+ 
+ @discussion Much slower than @c flush , since it waits for the drive to empty its cache.
+ 
+ @return @c BOOL - @c YES if everything appended so far is on the disk, and @c NO if an error occured.
+ */
+- (BOOL)synchronize;
+
+
+/*!
+ @brief Writes out everything in the buffer, and closes the file.
+ 
+ @note Appending to a closed writer fails. Deallocating a writer closes it.
+ 
+ @return @c BOOL - @c YES if the buffer was written out and the file closed, and @c NO if an error occured.
+ */
+- (BOOL)close;
+
+@end
+
+
+
+
 /*!
  @class TOMFileManager
  
@@ -38,6 +493,27 @@ NS_ASSUME_NONNULL_BEGIN
 /*! @brief This readonly property holds the string path of the app's Temp Directory. */
 @property (readonly, nonatomic) NSString *tempDirectory;
 
+/*! @brief This readonly property is @c YES while the persistent filename index is answering @c findAndGetPathForFileNamed: lookups. */
+@property (readonly, nonatomic, getter=isFilenameIndexEnabled) BOOL filenameIndexEnabled;
+
+/*! @brief This readonly property is @c YES while existence and type checks are answered from the metadata cache. */
+@property (readonly, nonatomic, getter=isMetadataCacheEnabled) BOOL metadataCacheEnabled;
+
+/*! @brief The number of checks the metadata cache has answered since it was enabled. */
+@property (readonly, nonatomic) NSUInteger metadataCacheHits;
+
+/*! @brief The number of checks the metadata cache had to pass on to the file system since it was enabled. */
+@property (readonly, nonatomic) NSUInteger metadataCacheMisses;
+
+/*! @brief This readonly property is @c YES while call counts, latencies, and system call counts are being recorded. */
+@property (class, readonly, nonatomic, getter=isMetricsEnabled) BOOL metricsEnabled;
+
+/*! @brief How much this manager logs. Defaults to @c TOMLogLevelError , and @c setDebugMode: switches between @c TOMLogLevelError and @c TOMLogLevelDebug . */
+@property (nonatomic) TOMLogLevel logLevel;
+
+/*! @brief The maximum number of asynchronous (@c completionHandler: ) operations this manager runs at once. Defaults to 4, and can't be less than 1. */
+@property (nonatomic) NSInteger maximumConcurrentOperations;
+
 
 
 
@@ -46,7 +522,7 @@ NS_ASSUME_NONNULL_BEGIN
  
  @discussion Assigns the correct paths to `documentsDirectory`, `resourcesDirectory`, `libraryDirectory`, and `tempDirectory`.
  
- It also initializes `debugMode` to `false`, but this can be changed later.
+ It also sets `logLevel` to `TOMLogLevelError`, but this can be changed later.
  
  @code
  TOMFileManager *manager = [[TOMFileManager alloc] init];
@@ -73,480 +549,1699 @@ NS_ASSUME_NONNULL_BEGIN
  
  @param newDirectoryPath The full path for the directory you wish to create.
  
- @return @c BOOL - @c YES if the directory was created, and @c NO if an error occured.
+ @return @c BOOL - @c YES if the directory was created, and @c NO if an error occured.
+ */
+- (BOOL)createDirectoryAtPath:(nonnull NSString *)newDirectoryPath;
+
+
+/*!
+ @brief Creates a new directory at @c newDirectoryPath.
+ 
+ @discussion Creates a new directory at @c newDirectoryPath, if it doesn't already exist.
+ 
+ @code
+ [manager createSubdirectoryNamed:@"Subdirectory" in:manager.documentsDirectory];
+ @endcode
+ 
+ @note
+ • If @c subdirectoryName does not contain "/" at the beginning, it will automatically be added.
+ 
+ • Under the hood, this function builds a path by appending @c subdirectoryName to @c existingDirectoryPath as a path component, and then calls @c createDirectory() using this new path.
+ 
+ @warning @c existingDirectoryPath must be a valid path that is accessible in the app's sandbox.
+ 
+ @param subdirectoryName The name of the subdirectory you wish to create.
+ @param existingDirectoryPath The path of the directory in which you wish to make a subdirectory.
+ 
+ @return @c BOOL - @c YES if the subdirectory was created, and @c NO if an error occured.
+ */
+- (BOOL)createSubdirectoryNamed:(nonnull NSString *)subdirectoryName in:(nonnull NSString *)existingDirectoryPath;
+
+
+
+/*!
+ @brief Copies the contents of one directory into another synchronously.
+ 
+ @discussion Synchronously performs a shallow copy of the contents of @c sourceDirectoryPath into @c destinationDirectoryPath.
+ 
+ @code
+ [manager copyDirectoryFrom:manager.resourcesDirectory to:manager.documentsDirectory];
+ @endcode
+ 
+ @note
+ • If @c destinationDirectoryPath does not exist, it will be created.
+ 
+ • It does not copy the current directory (“.”), parent directory (“..”), or resource forks (files that begin with “._”) but it does copy other hidden files (files that begin with a period character).
+ 
+ @param sourceDirectoryPath The path of the directory who's contents you'd like to copy.
+ @param destinationDirectoryPath The path of the directory into which you'd like the contents of @c directoryPath to be copied.
+ 
+ @return @c BOOL - @c YES if the directory was copied, and @c NO if an error occured.
+ */
+- (BOOL)copyDirectoryFrom:(nonnull NSString *)sourceDirectoryPath to:(nonnull NSString *)destinationDirectoryPath;
+
+
+/*!
+ @brief Copies the contents of one directory into another synchronously.
+ 
+ @discussion Synchronously performs a shallow copy of the contents of @c sourceDirectoryPath into @c destinationDirectoryPath.
+ 
+ @code
+ [manager copyDirectoryFrom:manager.mainBundleDirectory to:manager.documentsDirectory regardlessOfType:NO];
+ @endcode
+ 
+ @note
+ • If @c destinationDirectoryPath does not exist, it will be created.
+ 
+ • It does not copy the current directory (“.”), parent directory (“..”), or resource forks (files that begin with “._”) but it does copy other hidden files (files that begin with a period character).
+ 
+ • A directory can't be copied into itself or into one of its own subdirectories, and doing so returns @c NO.
+ 
+ @warning Ignoring the type if not recommended. Do so at your own risk.
+ 
+ @param sourceDirectoryPath The path of the directory who's contents you'd like to copy.
+ @param destinationDirectoryPath The path of the directory into which you'd like the contents of @c directoryPath to be copied.
+ @param ignoreType If @c YES, continue with copying even if @c sourceDirectoryPath is not a directory
+ 
+ @return @c BOOL - @c YES if the directory was copied, and @c NO if an error occured.
+ */
+- (BOOL)copyDirectoryFrom:(nonnull NSString *)sourceDirectoryPath to:(nonnull NSString *)destinationDirectoryPath regardlessOfType:(BOOL)ignoreType;
+
+
+/*!
+ @brief Copies the contents of one directory into another synchronously, and reports how fast the copy went.
+ 
+ @discussion Performs the same copy as @c copyDirectoryFrom:to: , and hands back the number of files and bytes it copied along with the time it took.
+ 
+ @code
+ TOMTransferReport *report;
+ 
+ if ([manager copyDirectoryFrom:manager.resourcesDirectory to:destinationPath report:&report])
+ {
+     NSLog(@"Copied %.0f files per second.", report.filesPerSecond);
+ }
+ @endcode
+ 
+ @note • The source is walked on the calling thread while its files are copied by a pool of workers, and files are cloned instead of copied when the volume supports it.
+ 
+ @param sourceDirectoryPath The path of the directory who's contents you'd like to copy.
+ @param destinationDirectoryPath The path of the directory into which you'd like the contents of @c directoryPath to be copied.
+ @param report On success, set to a report of the copy. Pass @c NULL if you don't need it.
+ 
+ @return @c BOOL - @c YES if the directory was copied, and @c NO if an error occured.
+ */
+- (BOOL)copyDirectoryFrom:(NSString *)sourceDirectoryPath to:(NSString *)destinationDirectoryPath report:(TOMTransferReport * _Nullable * _Nullable)report;
+
+
+/*!
+ @brief Copies the contents of one directory into another synchronously, and reports how fast the copy went.
+ 
+ @discussion Performs the same copy as @c copyDirectoryFrom:to:regardlessOfType: , and hands back the number of files and bytes it copied along with the time it took.
+ 
+ @code
+ TOMTransferReport *report;
+ [manager copyDirectoryFrom:manager.resourcesDirectory to:destinationPath regardlessOfType:NO report:&report];
+ @endcode
+ 
+ @warning Ignoring the type if not recommended. Do so at your own risk.
+ 
+ @param sourceDirectoryPath The path of the directory who's contents you'd like to copy.
+ @param destinationDirectoryPath The path of the directory into which you'd like the contents of @c directoryPath to be copied.
+ @param ignoreType If @c YES, continue with copying even if @c sourceDirectoryPath is not a directory
+ @param report On success, set to a report of the copy when @c sourceDirectoryPath is a directory. Pass @c NULL if you don't need it.
+ 
+ @return @c BOOL - @c YES if the directory was copied, and @c NO if an error occured.
+ */
+- (BOOL)copyDirectoryFrom:(NSString *)sourceDirectoryPath to:(NSString *)destinationDirectoryPath regardlessOfType:(BOOL)ignoreType report:(TOMTransferReport * _Nullable * _Nullable)report;
+
+
+/*!
+ @brief Makes one directory a copy of another, copying only what changed.
+ 
+ @discussion Unlike @c copyDirectoryFrom:to: , the destination may already exist. Each file in the source is compared with the one at the same place in the destination, and is only copied if that one is missing or differs - by default, in size or modification time. Comparisons and copies run on a pool of workers, and files are cloned instead of copied when the volume supports it.
+ 
+ @code
+ NSString *backupPath = [manager.libraryDirectory stringByAppendingPathComponent:@"Backup"];
+ TOMSyncReport *report;
+ 
+ if ([manager syncDirectoryFrom:manager.documentsDirectory to:backupPath options:TOMSyncOptionsDeleteExtraneous report:&report])
+ {
+     NSLog(@"Copied %llu bytes, skipped %llu.", report.numberOfBytesCopied, report.numberOfBytesSkipped);
+ }
+ @endcode
+ 
+ @note
+ • Copied files keep their modification times, so a file copied by one sync is skipped by the next one unless it changes again.
+ 
+ • If the sync fails part way through, whatever was copied stays, and the next sync picks up from there.
+ 
+ @warning With @c TOMSyncOptionsDeleteExtraneous , anything in @c destinationDirectoryPath that isn't in @c sourceDirectoryPath is deleted.
+ 
+ @param sourceDirectoryPath The path of the directory who's contents you'd like to copy.
+ @param destinationDirectoryPath The path of the directory you'd like to bring up to date. It is created if it doesn't exist.
+ @param options How files are compared, and whether extra files in the destination are deleted.
+ @param report On success, set to a report of what was copied, skipped and deleted. Pass @c NULL if you don't need it.
+ 
+ @return @c BOOL - @c YES if the destination is now up to date, and @c NO if an error occured.
+ */
+- (BOOL)syncDirectoryFrom:(NSString *)sourceDirectoryPath to:(NSString *)destinationDirectoryPath options:(TOMSyncOptions)options report:(TOMSyncReport * _Nullable * _Nullable)report;
+
+
+/*!
+ @brief Moves the contents of one directory into another synchronously.
+ 
+ @discussion Synchronously performs a shallow move of the contents of @c sourceDirectoryPath into @c destinationDirectoryPath.
+ 
+ @code
+ [manager moveDirectoryFrom:manager.mainBundleDirectory to:manager.documentsDirectory];
+ @endcode
+ 
+ @note
+ • If @c destinationDirectoryPath does not exist, it will be created.
+ 
+ • It does not move the current directory (“.”), parent directory (“..”), or resource forks (files that begin with “._”) but it does move other hidden files (files that begin with a period character).
+ 
+ @param sourceDirectoryPath The path of the directory who's contents you'd like to move.
+ @param destinationDirectoryPath The path of the directory into which you'd like the contents of @c directoryPath to be moved.
+ 
+ @return @c BOOL - @c YES if the directory was moved, and @c NO if an error occured.
+ */
+- (BOOL)moveDirectoryFrom:(nonnull NSString *)sourceDirectoryPath to:(nonnull NSString *)destinationDirectoryPath;
+
+
+/*!
+ @brief Moves the contents of one directory into another synchronously.
+ 
+ @discussion Synchronously performs a shallow move of the contents of @c sourceDirectoryPath into @c destinationDirectoryPath.
+ 
+ @code
+ [manager moveDirectoryFrom:manager.resourcesDirectory to:manager.documentsDirectory regardlessOfType:NO];
+ @endcode
+ 
+ @note
+ • If @c destinationDirectoryPath does not exist, it will be created.
+ 
+ • It does not move the current directory (“.”), parent directory (“..”), or resource forks (files that begin with “._”) but it does move other hidden files (files that begin with a period character).
+ 
+ @warning Ignoring the type if not recommended. Do so at your own risk.
+ 
+ @param sourceDirectoryPath The path of the directory who's contents you'd like to move.
+ @param destinationDirectoryPath The path of the directory into which you'd like the contents of @c directoryPath to be moved.
+ @param ignoreType If @c YES, continue with moving even if @c sourceDirectoryPath is not a directory
+ 
+ @return @c BOOL - @c YES if the directory was moved, and @c NO if an error occured.
+ */
+- (BOOL)moveDirectoryFrom:(nonnull NSString *)sourceDirectoryPath to:(nonnull NSString *)destinationDirectoryPath regardlessOfType:(BOOL)ignoreType;
+
+
+/*!
+ @brief Moves the contents of one directory into another synchronously, and reports how the move was done.
+ 
+ @discussion Performs the same move as @c moveDirectoryFrom:to: , and hands back whether the directory was renamed or copied and deleted.
+ 
+ @code
+ TOMTransferReport *report;
+ 
+ if ([manager moveDirectoryFrom:sourcePath to:destinationPath report:&report] && report.strategy == TOMCopyStrategyCopyAndDelete)
+ {
+     NSLog(@"Moved %llu bytes across volumes.", report.numberOfBytes);
+ }
+ @endcode
+ 
+ @note • Within a volume the directory is renamed, which is atomic and takes the same time for any size of directory.
+ @note • Across volumes the directory is copied by a pool of workers, and each file is deleted as soon as its copy is complete. The move is journaled, so if it is interrupted, moving the same directory again (or calling @c resumeInterruptedMoves ) finishes it.
+ 
+ @param sourceDirectoryPath The path of the directory who's contents you'd like to move.
+ @param destinationDirectoryPath The path of the directory into which you'd like the contents of @c directoryPath to be moved.
+ @param report On success, set to a report of the move. Pass @c NULL if you don't need it.
+ 
+ @return @c BOOL - @c YES if the directory was moved, and @c NO if an error occured.
+ */
+- (BOOL)moveDirectoryFrom:(NSString *)sourceDirectoryPath to:(NSString *)destinationDirectoryPath report:(TOMTransferReport * _Nullable * _Nullable)report;
+
+
+/*!
+ @brief Moves the contents of one directory into another synchronously, and reports how the move was done.
+ 
+ @discussion Performs the same move as @c moveDirectoryFrom:to:regardlessOfType: , and hands back whether the directory was renamed or copied and deleted.
+ 
+ @code
+ TOMTransferReport *report;
+ [manager moveDirectoryFrom:sourcePath to:destinationPath regardlessOfType:NO report:&report];
+ @endcode
+ 
+ @warning Ignoring the type if not recommended. Do so at your own risk.
+ 
+ @param sourceDirectoryPath The path of the directory who's contents you'd like to move.
+ @param destinationDirectoryPath The path of the directory into which you'd like the contents of @c directoryPath to be moved.
+ @param ignoreType If @c YES, continue with moving even if @c sourceDirectoryPath is not a directory
+ @param report On success, set to a report of the move. Pass @c NULL if you don't need it.
+ 
+ @return @c BOOL - @c YES if the directory was moved, and @c NO if an error occured.
+ */
+- (BOOL)moveDirectoryFrom:(NSString *)sourceDirectoryPath to:(NSString *)destinationDirectoryPath regardlessOfType:(BOOL)ignoreType report:(TOMTransferReport * _Nullable * _Nullable)report;
+
+
+/*!
+ @brief Finishes any directory moves across volumes that were interrupted.
+ 
+ @discussion A directory moved to another volume is copied and deleted a file at a time, with a journal recording the move until it's done. If the app is killed part way through, call this (at launch, for example) to finish those moves.
+ 
+ @code
+ [manager resumeInterruptedMoves];
+ @endcode
+ 
+ @return @c BOOL - @c YES if every interrupted move was finished (or there were none), and @c NO if any of them failed again.
+ */
+- (BOOL)resumeInterruptedMoves;
+
+
+/*!
+ @brief Renames the directory located at @c directoryPath to @c newName.
+ 
+ @discussion Renames the directory with a single atomic system call. It fails if something named @c newName already exists.
+ 
+ @code
+ NSString *directoryToRename = [manager.documentsDirectory stringByAppendingPathComponent:@"Subdirectory"];
+ [manager renameDirectoryAtPath:directoryToRename to:@"RenamedDirectory"];
+ @endcode
+ 
+ @warning Do not attempt to use this method to rename files
+ 
+ @param directoryPath The path of the directory you'd like to rename.
+ @param newName The new name you'd like to give the directory.
+ 
+ @return @c BOOL - @c YES if the directory was renamed, and @c NO if an error occured.
+ */
+- (BOOL)renameDirectoryAtPath:(nonnull NSString *)directoryPath to:(nonnull NSString *)newName;
+
+
+/*!
+ @brief Renames the directory located at @c directoryPath to @c newName.
+ 
+ @discussion Renames the directory with a single atomic system call. It fails if something named @c newName already exists.
+ 
+ @code
+ NSString *directoryToRename = [manager.documentsDirectory stringByAppendingPathComponent:@"SubDirectory"];
+ [manager renameDirectoryAtPath:directoryToRename to:@"RenamedDirectory" regardlessOfType:NO];
+ @endcode
+ 
+ @warning Do not attempt to use this method to rename files
+ 
+ @warning Ignoring the type if not recommended. Do so at your own risk.
+ 
+ @param directoryPath The path of the directory you'd like to rename.
+ @param newName The new name you'd like to give the directory.
+ @param ignoreType If @c YES, continue with renaming even if `directoryPath` is not a directory
+ 
+ @return @c BOOL - @c YES if the directory was renamed, and @c NO if an error occured.
+ */
+- (BOOL)renameDirectoryAtPath:(nonnull NSString *)directoryPath to:(nonnull NSString *)newName regardlessOfType:(BOOL)ignoreType;
+
+
+/*!
+ @brief Renames the directory located at @c directoryPath to @c newName, using @c options.
+ 
+ @discussion Renames the directory with a single atomic system call, so it is never half renamed and nothing is ever copied. With @c TOMRenameOptionsExchange this publishes a freshly built directory over a live one, without any moment where readers see a half built tree.
+ 
+ @code
+ // Build the new version next to the live one, then swap them
+ [manager renameDirectoryAtPath:stagingDirectoryPath to:@"Live" options:TOMRenameOptionsExchange];
+ [manager deleteDirectory:stagingDirectoryPath mode:TOMDeleteModeDeferred];
+ @endcode
+ 
+ @note • After an exchange, @c directoryPath holds what used to be at @c newName.
+ @note • @c renameDirectoryAtPath:to: uses @c TOMRenameOptionsNoReplace .
+ 
+ @param directoryPath The path of the directory you'd like to rename.
+ @param newName The new name you'd like to give the directory.
+ @param options Whether an existing directory named @c newName may be replaced, or should be exchanged with.
+ 
+ @return @c BOOL - @c YES if the directory was renamed, and @c NO if an error occured.
+ */
+- (BOOL)renameDirectoryAtPath:(NSString *)directoryPath to:(NSString *)newName options:(TOMRenameOptions)options;
+
+
+/*!
+ @brief Renames the directory located at @c directoryPath to @c newName, using @c options.
+ 
+ @discussion The same as @c renameDirectoryAtPath:to:options: , but can also rename things that aren't directories.
+ 
+ @code
+ [manager renameDirectoryAtPath:directoryPath to:@"Renamed" regardlessOfType:NO options:TOMRenameOptionsNoReplace];
+ @endcode
+ 
+ @warning Ignoring the type if not recommended. Do so at your own risk.
+ 
+ @param directoryPath The path of the directory you'd like to rename.
+ @param newName The new name you'd like to give the directory.
+ @param ignoreType If @c YES, continue with renaming even if @c directoryPath is not a directory
+ @param options Whether an existing directory named @c newName may be replaced, or should be exchanged with.
+ 
+ @return @c BOOL - @c YES if the directory was renamed, and @c NO if an error occured.
+ */
+- (BOOL)renameDirectoryAtPath:(NSString *)directoryPath to:(NSString *)newName regardlessOfType:(BOOL)ignoreType options:(TOMRenameOptions)options;
+
+
+/*!
+ @brief Deletes a directory and its contents.
+ 
+ @discussion Deletes a directory and its contents.
+ 
+ @code
+ [manager deleteDirectory:manager.documentsDirectory];
+ @endcode
+ 
+ @param directoryPath The path of the directory you'd like to delete.
+ 
+ @return @c BOOL - @c YES if the directory was deleted, and @c NO if an error occured.
+ */
+- (BOOL)deleteDirectory:(nonnull NSString *)directoryPath;
+
+
+/*!
+ @brief Deletes a directory and its contents.
+ 
+ @discussion Deletes a directory and its contents.
+ 
+ @code
+ [manager deleteDirectory:manager.documentsDirectory regardlessOfType:NO];
+ @endcode
+ 
+ @param directoryPath The path of the directory you'd like to delete.
+ @param ignoreType If @c YES, continue with deleting even if @c directoryPath is not a directory
+ 
+ 
+ @return @c BOOL - @c YES if the directory was deleted, and @c NO if an error occured.
+ */
+- (BOOL)deleteDirectory:(nonnull NSString *)directoryPath regardlessOfType:(BOOL)ignoreType;
+
+
+/*!
+ @brief Deletes a directory and its contents, in parallel or in the background.
+ 
+ @discussion Deletes a directory and its contents using @c mode. Large trees (like caches) can take seconds to delete one entry at a time, so @c TOMDeleteModeParallel spreads the work over a pool of workers, and @c TOMDeleteModeDeferred takes it off the calling thread entirely.
+ 
+ @code
+ NSString *cacheDirectory = [manager.libraryDirectory stringByAppendingPathComponent:@"Caches/Thumbnails"];
+ [manager deleteDirectory:cacheDirectory mode:TOMDeleteModeDeferred];
+ @endcode
+ 
+ @note
+ • With @c TOMDeleteModeDeferred the directory is gone from @c directoryPath when this returns, and a new directory can be created there right away. Only the disk space is reclaimed later.
+ 
+ • A directory on a different volume than the Library Directory can't be deferred, so it is deleted in parallel instead.
+ 
+ • The Library Directory and its Caches hold the purge area, so deferring either of them defers everything inside it instead, and the directory itself is left in place.
+ 
+ @param directoryPath The path of the directory you'd like to delete.
+ @param mode How to delete the directory.
+ 
+ @return @c BOOL - @c YES if the directory was deleted (or moved to the purge area), and @c NO if an error occured.
+ */
+- (BOOL)deleteDirectory:(NSString *)directoryPath mode:(TOMDeleteMode)mode;
+
+
+/*!
+ @brief Returns the filepath of a file located in the desired directory.
+ 
+ @discussion Returns the filepath of a file named @c filename located in the directory @c directoryPath, therefore verifying it exists in the expected location.
+ 
+ @code
+ NSString *exampleFilePath = [manager getPathForFileNamed:@"example.png" inDirectory:manager.documentsDirectory];
+ @endcode
+ 
+ @note @c filename is compared against each file's whole name, so @c "foo.png" won't match @c "xfoo.png". A name with more than one path component, like @c "Images/foo.png", also has to match the end of the file's path.
+ 
+ @warning @c directoryPath must be a directory, not a file.
+ 
+ @param filename The name of the file who's full path you'd like to retrieve.
+ @param directoryPath The path of the directory which contains the file @c filename.
+ 
+ @return @c NSString - The full path for the desired file.
+ */
+- (NSString *)getPathForFileNamed:(NSString *)filename inDirectory:(NSString *)directoryPath;
+
+
+/*!
+ @brief Returns the filepath of a file located in an unknown directory.
+ 
+ @discussion Recursively searches all accessible directories in the app's sandbox and returns the path to the first instance of a file named @ filename.
+ 
+ @code
+ NSString *exampleFilePath = [manager findAndGetPathForFileNamed:@"example.png"];
+ @endcode
+ 
+ @note
+ • For use when the directory the desired file is located in is not known.
+ 
+ • The directories are searched in parallel, but if the file exists in more than one of them, the Documents Directory still wins over the Resources Directory, which wins over the Library Directory, which wins over the Temp Directory.
+ 
+ @param filename The name of the file you'd like to retrieve the path of, but don't know the directory of.
+ 
+ @return @c NSString - The full path for the desired file.
+ */
+- (NSString *)findAndGetPathForFileNamed:(NSString *)filename;
+
+
+/*!
+ @brief Returns the filepaths of many files located in unknown directories.
+ 
+ @discussion Searches all accessible directories in the app's sandbox for every file named in @c filenames at once. Each directory is walked a single time no matter how many names are requested, and the search stops as soon as every name has been found.
+ 
+ @code
+ NSDictionary *paths = [manager findAndGetPathsForFileNames:[NSSet setWithObjects:@"example.png", @"example.txt", nil]];
+ NSString *exampleImagePath = paths[@"example.png"];
+ @endcode
+ 
+ @note Each name resolves to the same path @c findAndGetPathForFileNamed: would have returned for it.
+ 
+ @param filenames The names of the files you'd like to retrieve the paths of.
+ 
+ @return @c NSDictionary - The full path of each file that was found, keyed by its name. Names that weren't found are left out.
+ */
+- (NSDictionary<NSString *, NSString *> *)findAndGetPathsForFileNames:(NSSet<NSString *> *)filenames;
+
+
+/*!
+ @brief Finds every file in a directory whose name matches a pattern.
+ 
+ @discussion Recursively searches @c directoryPath for files whose names match @c pattern, and hands each one to @c block as soon as it's found, instead of collecting them all first.
+ 
+ @code
+ [manager enumerateFilesMatchingPattern:@"*.log" inDirectory:manager.libraryDirectory options:TOMFileSearchOptionsSkipHiddenFiles usingBlock:^(NSString *filePath, BOOL *stop) {
+     [manager deleteFileAtPath:filePath];
+ }];
+ @endcode
+ 
+ @note By default @c pattern is a glob (like @c "cache-*.bin") matched against each file's name. Pass @c TOMFileSearchOptionsRegularExpression to use a regular expression instead.
+ 
+ @warning @c directoryPath must be a directory, not a file.
+ 
+ @param pattern The glob or regular expression each file's name is matched against.
+ @param directoryPath The path of the directory to search.
+ @param options Options that control how @c pattern is matched, and which parts of the directory are searched.
+ @param block The block to call with the full path of each matching file. Set @c *stop to @c YES to end the search early.
+ 
+ @return @c BOOL - @c YES if the search ran, and @c NO if @c directoryPath or @c pattern was invalid.
+ */
+- (BOOL)enumerateFilesMatchingPattern:(NSString *)pattern inDirectory:(NSString *)directoryPath options:(TOMFileSearchOptions)options usingBlock:(void (^)(NSString *filePath, BOOL *stop))block;
+
+
+/*!
+ @brief Finds files in a directory whose names match a pattern, down to a limited depth.
+ 
+ @discussion Recursively searches @c directoryPath for files whose names match @c pattern, and hands each one to @c block as soon as it's found. The search never goes deeper than @c maximumDepth, and stops after @c maximumResults matches.
+ 
+ @code
+ [manager enumerateFilesMatchingPattern:@"^cache-[0-9]+\\.bin$" inDirectory:manager.tempDirectory options:TOMFileSearchOptionsRegularExpression maximumDepth:2 maximumResults:10 usingBlock:^(NSString *filePath, BOOL *stop) {
+     NSLog(@"%@", filePath);
+ }];
+ @endcode
+ 
+ @warning @c directoryPath must be a directory, not a file.
+ 
+ @param pattern The glob or regular expression each file's name is matched against.
+ @param directoryPath The path of the directory to search.
+ @param options Options that control how @c pattern is matched, and which parts of the directory are searched.
+ @param maximumDepth How many levels of directories to search - @c 1 only searches @c directoryPath itself. Pass @c NSUIntegerMax for no limit.
+ @param maximumResults The number of matches after which the search stops. Pass @c NSUIntegerMax for no limit.
+ @param block The block to call with the full path of each matching file. Set @c *stop to @c YES to end the search early.
+ 
+ @return @c BOOL - @c YES if the search ran, and @c NO if @c directoryPath or @c pattern was invalid.
+ */
+- (BOOL)enumerateFilesMatchingPattern:(NSString *)pattern inDirectory:(NSString *)directoryPath options:(TOMFileSearchOptions)options maximumDepth:(NSUInteger)maximumDepth maximumResults:(NSUInteger)maximumResults usingBlock:(void (^)(NSString *filePath, BOOL *stop))block;
+
+
+/*!
+ @brief Enables the persistent filename index.
+ 
+ @discussion Loads the on-disk filename index from the app's Caches Directory, or builds it with one walk of the sandbox if it doesn't exist yet. While enabled, @c findAndGetPathForFileNamed: (and so the find & copy, move, and delete methods) looks files up in the index instead of walking every directory.
+ 
+ @code
+ [manager enableFilenameIndex];
+ NSString *exampleFilePath = [manager findAndGetPathForFileNamed:@"example.png"];
+ @endcode
+ 
+ @note
+ • The index is kept current by this manager's own create, copy, move, rename, and delete methods.
+ 
+ • Changes made by anything else are picked up through directory modification times: a hit revalidates the directory it was found in, and a miss revalidates every indexed directory before giving up.
+ 
+ @return @c BOOL - @c YES if the index is ready to use.
+ */
+- (BOOL)enableFilenameIndex;
+
+
+/*!
+ @brief Disables the persistent filename index.
+ 
+ @discussion Saves any pending changes to the filename index, then goes back to walking the sandbox for every lookup. The index stays on disk, so enabling it again is cheap.
+ 
+ @code
+ [manager disableFilenameIndex];
+ @endcode
+ 
+ @return @c Void - there isn't anything to return.
+ */
+- (void)disableFilenameIndex;
+
+
+/*!
+ @brief Throws away the filename index and builds it again.
+ 
+ @discussion Walks the Documents, Resources, Library, and Temp directories once and replaces the filename index with the result.
+ 
+ @code
+ [manager rebuildFilenameIndex];
+ @endcode
+ 
+ @return @c BOOL - @c YES if the index was rebuilt, and @c NO if the index is not enabled.
+ */
+- (BOOL)rebuildFilenameIndex;
+
+
+/*!
+ @brief Enables the metadata cache.
+ 
+ @discussion Remembers whether each checked path exists, whether it is a directory, whether it can be read, and its size and modification time, for @c timeToLive seconds. While enabled, @c fileExistsAtPath: and the file copy, move, and delete methods answer their checks from the cache, instead of asking the file system again each time.
+ 
+ @code
+ [manager enableMetadataCacheWithTimeToLive:5.0];
+ 
+ BOOL exists = [manager fileExistsAtPath:exampleFilePath];
+ NSLog(@"%lu hits, %lu misses", (unsigned long)manager.metadataCacheHits, (unsigned long)manager.metadataCacheMisses);
+ @endcode
+ 
+ @note
+ • The cache is kept current by this manager's own create, copy, move, rename, and delete methods.
+ 
+ • Changes made by anything else may go unnoticed for up to @c timeToLive seconds.
+ 
+ • Enabling the cache again starts it over empty, with the hit and miss counts reset.
+ 
+ @param timeToLive How long, in seconds, a cached check stays valid.
+ 
+ @return @c Void - there isn't anything to return.
+ */
+- (void)enableMetadataCacheWithTimeToLive:(NSTimeInterval)timeToLive;
+
+
+/*!
+ @brief Disables the metadata cache.
+ 
+ @discussion Throws away every cached check, and goes back to asking the file system every time.
+ 
+ @code
+ [manager disableMetadataCache];
+ @endcode
+ 
+ @return @c Void - there isn't anything to return.
+ */
+- (void)disableMetadataCache;
+
+
+/*!
+ @brief Copies a file to a specified directory synchronously.
+ 
+ @discussion Synchronously performs a shallow copy of the file with the path @c filePath to a directory with the path @c directoryPath.
+ 
+ @code
+ NSString *exampleFilePath = [manager.resourcesDirectory stringByAppendingPathComponent:@"example.txt"];
+ [manager copyFileAtPath:exampleFilePath to:manager.documentsDirectory];
+ @endcode
+ 
+ @note If @c directoryPath doesn't exist, it is created.
+ 
+ @param filePath The path of the file you'd like to copy.
+ @param destinationDirectoryPath The path of the directory into which you'd like the file to be copied.
+ 
+ @return @c BOOL - @c YES if the file was copied, and @c NO if an error occured.
+ */
+- (BOOL)copyFileAtPath:(NSString *)filePath to:(NSString *)destinationDirectoryPath;
+
+
+/*!
+ @brief Copies a file to a specified directory synchronously.
+ 
+ @discussion Synchronously performs a shallow copy of the file with the path @c filePath to a directory with the path @c directoryPath.
+ 
+ @code
+ NSString *exampleFilePath = [manager.resourcesDirectory stringByAppendingPathComponent:@"example.txt"];
+ [manager copyFileAtPath:exampleFilePath to:manager.documentsDirectory regardlessOfType:NO];
+ @endcode
+ 
+ @note If @c directoryPath doesn't exist, it is created.
+ 
+ @warning Ignoring the type if not recommended. Do so at your own risk.
+ 
+ @param filePath The path of the file you'd like to copy.
+ @param destinationDirectoryPath The path of the directory into which you'd like the file to be copied.
+ @param ignoreType If @c YES, continue with copying even if @c filePath is not a file.
+ 
+ @return @c BOOL - @c YES if the file was copied, and @c NO if an error occured.
+ */
+- (BOOL)copyFileAtPath:(nonnull NSString *)filePath to:(nonnull NSString *)destinationDirectoryPath regardlessOfType:(BOOL)ignoreType;
+
+
+/*!
+ @brief Copies a file to a specified directory synchronously, and reports how the copy was done.
+ 
+ @discussion Performs the same copy as @c copyFileAtPath:to: , and hands back the strategy that moved the data along with the number of bytes and the time it took.
+ 
+ @code
+ TOMTransferReport *report;
+ 
+ if ([manager copyFileAtPath:exampleFilePath to:manager.documentsDirectory report:&report] && report.strategy == TOMCopyStrategyClone)
+ {
+     NSLog(@"The copy shares its data with the original.");
+ }
+ @endcode
+ 
+ @note • The file is cloned when the volume supports it. Otherwise its data is read and written in large chunks that bypass the buffer cache, and @c fcopyfile(3) carries over only its permissions, times and extended attributes. Symbolic links and special files have no data, so they are recreated by @c copyfile(3).
+ 
+ @param filePath The path of the file you'd like to copy.
+ @param destinationDirectoryPath The path of the directory into which you'd like the file to be copied.
+ @param report On success, set to a report of the copy. Pass @c NULL if you don't need it.
+ 
+ @return @c BOOL - @c YES if the file was copied, and @c NO if an error occured.
+ */
+- (BOOL)copyFileAtPath:(NSString *)filePath to:(NSString *)destinationDirectoryPath report:(TOMTransferReport * _Nullable * _Nullable)report;
+
+
+/*!
+ @brief Copies a file to a specified directory synchronously, and reports how the copy was done.
+ 
+ @discussion Performs the same copy as @c copyFileAtPath:to:regardlessOfType: , and hands back the strategy that moved the data along with the number of bytes and the time it took.
+ 
+ @code
+ TOMTransferReport *report;
+ [manager copyFileAtPath:exampleFilePath to:manager.documentsDirectory regardlessOfType:NO report:&report];
+ @endcode
+ 
+ @warning Ignoring the type if not recommended. Do so at your own risk.
+ 
+ @param filePath The path of the file you'd like to copy.
+ @param destinationDirectoryPath The path of the directory into which you'd like the file to be copied.
+ @param ignoreType If @c YES, continue with copying even if @c filePath is not a file.
+ @param report On success, set to a report of the copy when @c filePath is a file. Pass @c NULL if you don't need it.
+ 
+ @return @c BOOL - @c YES if the file was copied, and @c NO if an error occured.
+ */
+- (BOOL)copyFileAtPath:(NSString *)filePath to:(NSString *)destinationDirectoryPath regardlessOfType:(BOOL)ignoreType report:(TOMTransferReport * _Nullable * _Nullable)report;
+
+
+/*!
+ @brief Finds, then copies a file to a specified directory.
+ 
+ @discussion Recursively searches all accessible directories for a file named @c filename, then copies the first found instance to a directory with the path @c directoryPath.
+ 
+ @code
+ [manager findAndCopyFileNamed:@"example.txt" to:manager.documentsDirectory];
+ @endcode
+ 
+ @note
+ • If @c directoryPath doesn't exist, it is created.
+ 
+ • Under the hood, this simply calls @c findAndGetPathForFile() then @c copyFile()
+ 
+ @param filename The name of the file you'd like to find and copy.
+ @param destinationDirectoryPath The path of the directory into which you'd like the file to be copied, once found.
+ 
+ @return @c BOOL - @c YES if the file was copied, and @c NO if an error occured.
+ */
+- (BOOL)findAndCopyFileNamed:(NSString *)filename to:(NSString *)destinationDirectoryPath;
+
+
+/*!
+ @brief Moves a file to a specified directory synchronously.
+ 
+ @discussion Synchronously performs a shallow move of the file with the path @c filePath to a directory with the path @c directoryPath.
+ 
+ @code
+ NSString *exampleFilePath = [manager.mainBundleDirectory stringByAppendingPathComponent:@"example.txt"];
+ [manager moveFileAtPath:exampleFilePath to:manager.documentsDirectory];
+ @endcode
+ 
+ @note If @c directoryPath doesn't exist, it is created.
+ 
+ @param filePath The path of the file you'd like to move.
+ @param destinationDirectoryPath The path of the directory into which you'd like the file to be moved.
+ 
+ @return @c BOOL - @c YES if the file was moved, and @c NO if an error occured.
+ */
+- (BOOL)moveFileAtPath:(NSString *)filePath to:(NSString *)destinationDirectoryPath;
+
+
+/*!
+ @brief Moves a file to a specified directory synchronously.
+ 
+ @discussion Synchronously performs a shallow move of the file with the path @c filePath to a directory with the path @c directoryPath.
+ 
+ @code
+ NSString *exampleFilePath = [manager.mainBundleDirectory stringByAppendingPathComponent:@"example.txt"];
+ [manager moveFileAtPath:exampleFilePath to:manager.documentsDirectory regardlessOfType:NO];
+ @endcode
+ 
+ @note If @c directoryPath doesn't exist, it is created.
+ 
+ @warning Ignoring the type if not recommended. Do so at your own risk.
+ 
+ @param filePath The path of the file you'd like to move.
+ @param destinationDirectoryPath The path of the directory into which you'd like the file to be moved.
+ @param ignoreType If @c YES, continue with moving even if @c filePath is not a file.
+ 
+ @return @c BOOL - @c YES if the file was moved, and @c NO if an error occured.
+ */
+- (BOOL)moveFileAtPath:(nonnull NSString *)filePath to:(nonnull NSString *)destinationDirectoryPath regardlessOfType:(BOOL)ignoreType;
+
+
+/*!
+ @brief Finds, then moves a file to a specified directory.
+ 
+ @discussion Recursively searches all accessible directories for a file named @c filename, then moves the first found instance to a directory with the path @c directoryPath.
+ 
+ @code
+ [manager findAndCopyFile:@"example.txt" to:manager.documentsDirectory];
+ @endcode
+ 
+ @note
+ • If @c directoryPath doesn't exist, it is created.
+ 
+ • Under the hood, this simply calls @c findAndGetPathForFile() then @c copyFile()
+ 
+ @param filename The name of the file you'd like to find and move.
+ @param destinationDirectoryPath The path of the directory into which you'd like the file to be moved, once found.
+ 
+ @return @c BOOL - @c YES if the file was moved, and @c NO if an error occured.
+ */
+- (BOOL)findAndMoveFileNamed:(NSString *)filename to:(NSString *)destinationDirectoryPath;
+
+
+
+/*!
+ @brief Deletes the file located at @c filePath.
+ 
+ @discussion Deletes the file located at @c filePath.
+ 
+ @code
+ NSString *exampleFilePath = [manager.documentsDirectory stringByAppendingPathComponent:@"example.txt"];
+ [manager deleteFile:exampleFilePath];
+ @endcode
+ 
+ @param filePath The path of the file you'd like to delete.
+ 
+ @return @c BOOL - @c YES if the file was deleted, and @c NO if an error occured.
+ */
+- (BOOL)deleteFileAtPath:(NSString *)filePath;
+
+
+/*!
+ @brief Deletes the file located at @c filePath.
+ 
+ @discussion Deletes the file located at @c filePath.
+ 
+ @code
+ NSString *exampleFilePath = [manager.documentsDirectory stringByAppendingPathComponent:@"example.txt"];
+ [manager deleteFile:exampleFilePath regardlessOfType:NO];
+ @endcode
+ 
+ @param filePath The path of the file you'd like to delete.
+ @param ignoreType If @c YES, continue with deleting even if @c filePath is not a file
+ 
+ @return @c BOOL - @c YES if the file was deleted, and @c NO if an error occured.
+ */
+- (BOOL)deleteFileAtPath:(NSString *)filePath regardlessOfType:(BOOL)ignoreType;
+
+
+/*!
+ @brief Finds, then deletes a file named @c filename.
+ 
+ @discussion Recursively searches all available directories for a file named @c filename, then deletes the first found instance.
+ 
+ @code
+ [manager findAndDeleteFile:@"example.txt"];
+ @endcode
+ 
+ @param filename The name of the file you'd like to delete, once found.
+ 
+ @return @c BOOL - @c YES if the file was deleted, and @c NO if an error occured.
+ */
+- (BOOL)findAndDeleteFileNamed:(NSString *)filename;
+
+
+/*!
+ @brief Runs a batch of copy, move and delete operations.
+ 
+ @discussion Runs every operation in @c operations, and reports whether each one succeeded. Running them as a batch is much cheaper than calling @c copyFileAtPath:to: , @c moveFileAtPath:to: and @c deleteFileAtPath: one at a time, since every source and destination is looked up once for the whole batch instead of several times per call.
+ 
+ @code
+ NSArray *operations = @[[TOMFileOperation copyOperationFromPath:imagePath to:backupDirectory],
+                         [TOMFileOperation moveOperationFromPath:downloadPath to:manager.documentsDirectory],
+                         [TOMFileOperation deleteOperationAtPath:stalePath]];
+ 
+ TOMBatchReport *report = [manager performOperations:operations];
+ @endcode
+ 
+ @note
+ • The batch behaves as if the operations ran in order. Operations that involve the same paths (or paths inside each other) run one after the other, and every other operation runs at the same time.
+ 
+ • Operations work on both files and directories, and a destination directory that doesn't exist is created.
+ 
+ • A failed operation doesn't stop the batch.
+ 
+ @param operations The operations to run.
+ 
+ @return @c TOMBatchReport - The result of every operation, in the order they were given.
+ */
+- (TOMBatchReport *)performOperations:(NSArray<TOMFileOperation *> *)operations;
+
+
+/*!
+ @brief Checks if a file exists at the given path.
+ 
+ @discussion Checks if @c filePath is an existing file. Really, it's just a call through to @c NSFileManager, primarily provided for consistency.
+ 
+ @code
+ NSString *exampleFilePath = [manager.documentsDirectory stringByAppendingPathComponent:@"example.txt"];
+ [manager fileExistsAtPath:exampleFilePath];
+ @endcode
+ 
+ @param filePath The path to the file you would like to verify the existence of.
+ 
+ @return @c BOOL - @c YES if the file exists, and @c NO if it doesn't.
+ */
+- (BOOL)fileExistsAtPath:(NSString  *)filePath;
+
+
+/*!
+ @brief Returns the number of files in a directory.
+ 
+ @discussion Returns the number of files in @c directoryPath. The same as @c numberOfItemsInDirectoryAtPath:options: with @c TOMCountOptionsNone .
+ 
+ @code
+ NSUInteger fileCount = [manager numberOfFilesInDirectoryAtPath:manager.documentsDirectory];
+ @endcode
+ 
+ @param directoryPath The path you'd like to count the contents of.
+ 
+ @return @c NSUInteger - The number of files in the specified directory.
+ */
+- (NSUInteger)numberOfFilesInDirectoryAtPath:(NSString *)directoryPath;
+
+
+/*!
+ @brief Returns the number of items in a directory that match @c options.
+ 
+ @discussion Reads the directory's entries and counts them as they go by, instead of building a list of their names, so counting a directory with a million entries takes no more memory than counting one with ten. With @c TOMCountOptionsRecursive , each subdirectory is counted in parallel.
+ 
+ @code
+ // Every regular file anywhere under Caches
+ NSString *cachesPath = [manager.libraryDirectory stringByAppendingPathComponent:@"Caches"];
+ NSUInteger fileCount = [manager numberOfItemsInDirectoryAtPath:cachesPath options:TOMCountOptionsRecursive | TOMCountOptionsFiles];
+ @endcode
+ 
+ @note
+ • Symbolic links are counted, but never followed.
+ 
+ • Directories that can't be read are skipped.
+ 
+ @param directoryPath The path you'd like to count the contents of.
+ @param options Whether to count inside subdirectories, which types of item to count, and whether to skip hidden items.
+ 
+ @return @c NSUInteger - The number of matching items, or 0 if @c directoryPath is not a directory.
+ */
+- (NSUInteger)numberOfItemsInDirectoryAtPath:(NSString *)directoryPath options:(TOMCountOptions)options;
+
+
+/*!
+ @brief Returns how much space a directory and everything inside it takes up.
+ 
+ @discussion Adds up the logical and allocated sizes of everything under @c directoryPath , like du(1), with each of its subdirectories totalled in parallel. The manager remembers what it found in each directory, so later calls only stat the contents of directories that have gained, lost or renamed an entry since.
+ 
+ @code
+ TOMDirectorySize *cachesSize = [manager sizeOfDirectoryAtPath:[manager.libraryDirectory stringByAppendingPathComponent:@"Caches"]];
+ 
+ if (cachesSize.allocatedSize > 500 * 1024 * 1024)
+ {
+     [self trimCaches];
+ }
+ @endcode
+ 
+ @note
+ • Symbolic links are sized as links, never followed.
+ 
+ • A file with several hard links is counted once for each of them.
+ 
+ • Writing to an existing file doesn't change its directory, so growth made by anything other than this manager isn't seen until the directory changes. Use @c sizeOfDirectoryAtPath:usingCache: with @c NO to re-read everything.
+ 
+ @param directoryPath The path of the directory you'd like the size of.
+ 
+ @return @c TOMDirectorySize - The directory's size, or @c nil if @c directoryPath is not a directory.
+ */
+- (nullable TOMDirectorySize *)sizeOfDirectoryAtPath:(NSString *)directoryPath;
+
+
+/*!
+ @brief Returns how much space a directory and everything inside it takes up, optionally ignoring what was remembered from earlier calls.
+ 
+ @discussion The same as @c sizeOfDirectoryAtPath: , but with @c useCache set to @c NO every directory is read and every entry stat'd again. The cache is refreshed with what is found either way.
+ 
+ @code
+ TOMDirectorySize *documentsSize = [manager sizeOfDirectoryAtPath:manager.documentsDirectory usingCache:NO];
+ @endcode
+ 
+ @param directoryPath The path of the directory you'd like the size of.
+ @param useCache If @c NO , the sizes remembered from earlier calls aren't trusted.
+ 
+ @return @c TOMDirectorySize - The directory's size, or @c nil if @c directoryPath is not a directory.
+ */
+- (nullable TOMDirectorySize *)sizeOfDirectoryAtPath:(NSString *)directoryPath usingCache:(BOOL)useCache;
+
+
+/*!
+ @brief Forgets the directory sizes remembered by @c sizeOfDirectoryAtPath: .
+ 
+ @code
+ [manager clearDirectorySizeCache];
+ @endcode
+ 
+ @return @c Void - there isn't anything to return.
+ */
+- (void)clearDirectorySizeCache;
+
+
+
+/*!
+ @brief Watches a directory and everything inside it for changes, whoever makes them.
+ 
+ @discussion Every directory in the tree is watched with a vnode dispatch source, and directories added later are watched as soon as they appear. Changes are gathered for a tenth of a second after the first one, then handed over together as the set of directories that changed. While a watch is running, the filename index, metadata cache and directory size cache drop what they knew about those directories as soon as the change is reported, instead of waiting to expire or to be re-walked.
+ 
+ @code
+ id documentsWatch = [manager watchDirectoryAtPath:manager.documentsDirectory usingBlock:^(NSSet<NSString *> *changedDirectoryPaths) {
+     [self reloadDocumentList];
+ }];
+ 
+ // Later
+ [manager stopWatching:documentsWatch];
+ @endcode
+ 
+ @note
+ • A directory reports entries being added, removed or renamed - writing to an existing file doesn't change its directory, so it isn't reported.
+ 
+ • Each watched directory holds a file descriptor, and a watch stops taking on new directories once it holds 1024 of them. The first directory it has to leave unwatched is logged as an error.
+ 
+ • @c block is called on the main queue.
+ 
+ @param directoryPath The path of the directory you'd like to watch.
+ @param block The block to call with the paths of the directories that changed, or @c nil to only keep the manager's caches current.
+ 
+ @return @c id - An object to pass to @c stopWatching: , or @c nil if @c directoryPath is not a directory.
+ */
+- (nullable id)watchDirectoryAtPath:(NSString *)directoryPath usingBlock:(nullable void (^)(NSSet<NSString *> *changedDirectoryPaths))block;
+
+
+/*!
+ @brief Stops a watch started by @c watchDirectoryAtPath:usingBlock: .
+ 
+ @code
+ [manager stopWatching:documentsWatch];
+ @endcode
+ 
+ @note Changes that were already gathered may still be handed to the watch's block once more.
+ 
+ @param watch The object returned by @c watchDirectoryAtPath:usingBlock: .
+ 
+ @return @c Void - there isn't anything to return.
+ */
+- (void)stopWatching:(id)watch;
+
+
+/*!
+ @brief Returns the data for the file at @c filePath.
+ 
+ @discussion Creates a data object by reading every byte from the file at a @c filePath.
+ 
+ @code
+ NSString *exampleFilePath = [manager.documentsDirectory stringByAppendingPathComponent:@"example.txt"];
+ NSData *fileData = [manager retrieveDataForFileAtPath:exampleFilePath];
+ @endcode
+ 
+ @param filePath The path to the file you'd like to get the data for.
+ 
+ @return @c NSData - The data for the requested file - @c NULL if file doesn't exist.
+ */
+- (NSData*)retrieveDataForFileAtPath:(NSString *)filePath;
+
+
+/*!
+ @brief Returns the data for the file at @c filePath, without reading it into memory.
+ 
+ @discussion Maps the file at @c filePath into memory and returns a data object backed by the mapping. Nothing is copied up front - pages are read from disk as they're accessed, and the system can drop them again under memory pressure.
+ 
+ @code
+ NSString *modelFilePath = [manager.documentsDirectory stringByAppendingPathComponent:@"model.bin"];
+ NSData *modelData = [manager retrieveMappedDataForFileAtPath:modelFilePath];
+ @endcode
+ 
+ @note The file is expected to be read front to back, so the system is asked to read ahead aggressively.
+ 
+ @warning Don't truncate or rewrite the file while the returned data is alive - accessing pages that no longer exist will crash.
+ 
+ @param filePath The path to the file you'd like to get the data for.
+ 
+ @return @c NSData - The data for the requested file - @c NULL if the file doesn't exist or couldn't be mapped.
+ */
+- (NSData *)retrieveMappedDataForFileAtPath:(NSString *)filePath;
+
+
+/*!
+ @brief Returns part of the data for the file at @c filePath.
+ 
+ @discussion Creates a data object by reading only the bytes in @c range from the file at @c filePath.
+ 
+ @code
+ NSString *exampleFilePath = [manager.documentsDirectory stringByAppendingPathComponent:@"example.bin"];
+ NSData *headerData = [manager retrieveDataForFileAtPath:exampleFilePath range:NSMakeRange(0, 512)];
+ @endcode
+ 
+ @note If @c range runs past the end of the file, only the bytes up to the end of the file are returned.
+ 
+ @param filePath The path to the file you'd like to get the data for.
+ @param range The byte range of the file you'd like to read.
+ 
+ @return @c NSData - The requested bytes of the file - @c NULL if the file doesn't exist or couldn't be read.
+ */
+- (NSData *)retrieveDataForFileAtPath:(NSString *)filePath range:(NSRange)range;
+
+
+/*!
+ @brief Reads the file at @c filePath in fixed-size chunks.
+ 
+ @discussion Reads the file at @c filePath from start to finish, handing each chunk to @c block as it's read. Only one chunk is ever held in memory, so the memory used stays the same no matter how large the file is.
+ 
+ @code
+ NSString *exampleFilePath = [manager.documentsDirectory stringByAppendingPathComponent:@"example.bin"];
+ [manager readFileAtPath:exampleFilePath chunkSize:(1024 * 1024) usingBlock:^(NSData *chunk, BOOL *stop) {
+     CC_SHA256_Update(&context, chunk.bytes, (CC_LONG)chunk.length);
+ }];
+ @endcode
+ 
+ @note Every chunk is exactly @c chunkSize bytes long, except for the last one.
+ 
+ @warning The same buffer is reused for every chunk, so @c chunk is only valid until @c block returns. Copy it if you need to keep it.
+ 
+ @param filePath The path to the file you'd like to read.
+ @param chunkSize The number of bytes to read at a time. Pass @c 0 to use the default of 1 MB.
+ @param block The block to call with each chunk. Set @c *stop to @c YES to stop reading early.
+ 
+ @return @c BOOL - @c YES if the file was read (or reading was stopped by @c block), and @c NO if an error occured.
+ */
+- (BOOL)readFileAtPath:(NSString *)filePath chunkSize:(NSUInteger)chunkSize usingBlock:(void (^)(NSData *chunk, BOOL *stop))block;
+
+
+/*!
+ @brief Returns a fingerprint of the contents of the file at @c filePath.
+ 
+ @discussion Streams the file through @c algorithm a chunk at a time, so only one chunk is ever held in memory no matter how large the file is.
+ 
+ @code
+ NSData *digest = [manager hashOfFileAtPath:exampleFilePath algorithm:TOMHashAlgorithmSHA256];
+ @endcode
+ 
+ @note With the log level set to @c TOMLogLevelInfo , each hash logs how many bytes per second it went through.
+ 
+ @param filePath The path to the file you'd like to hash.
+ @param algorithm The algorithm to hash the file with.
+ 
+ @return @c NSData - The file's digest - @c nil if the file doesn't exist or couldn't be read.
+ */
+- (nullable NSData *)hashOfFileAtPath:(NSString *)filePath algorithm:(TOMHashAlgorithm)algorithm;
+
+
+/*!
+ @brief Returns a fingerprint of the contents of each file in @c filePaths.
+ 
+ @discussion The same as @c hashOfFileAtPath:algorithm: , for many files at once. The files are hashed in parallel, each streamed on its own.
+ 
+ @code
+ NSDictionary<NSString *, NSData *> *digests = [manager hashesOfFilesAtPaths:downloadedFilePaths algorithm:TOMHashAlgorithmXXH64];
+ @endcode
+ 
+ @param filePaths The paths to the files you'd like to hash.
+ @param algorithm The algorithm to hash the files with.
+ 
+ @return @c NSDictionary - Each path mapped to its file's digest. Files that don't exist or couldn't be read are left out.
+ */
+- (NSDictionary<NSString *, NSData *> *)hashesOfFilesAtPaths:(NSArray<NSString *> *)filePaths algorithm:(TOMHashAlgorithm)algorithm;
+
+
+/*!
+ @brief Finds files with identical contents anywhere in the documents, library and temp directories.
+ 
+ @discussion The same as @c findDuplicateFilesInDirectories: with @c documentsDirectory , @c libraryDirectory and @c tempDirectory .
+ 
+ @code
+ NSArray<NSArray<NSString *> *> *duplicateGroups = [manager findDuplicateFiles];
+ @endcode
+ 
+ @return @c NSArray - The groups of identical files, as described for @c findDuplicateFilesInDirectories: .
  */
-- (BOOL)createDirectoryAtPath:(nonnull NSString *)newDirectoryPath;
+- (NSArray<NSArray<NSString *> *> *)findDuplicateFiles;
 
 
 /*!
- @brief Creates a new directory at @c newDirectoryPath.
+ @brief Finds files with identical contents anywhere in @c directoryPaths.
  
- @discussion Creates a new directory at @c newDirectoryPath, if it doesn't already exist.
+ @discussion Reads as little as it can: files are first grouped by size, and only files that share a size have their first and last 4 KB hashed. Only files that still match after that are hashed in full. The directories are walked in parallel, and the files in each round are hashed in parallel.
  
  @code
- [manager createSubdirectoryNamed:@"Subdirectory" in:manager.documentsDirectory];
+ NSArray<NSArray<NSString *> *> *duplicateGroups = [manager findDuplicateFilesInDirectories:@[manager.documentsDirectory]];
+ 
+ for (NSArray<NSString *> *group in duplicateGroups)
+ {
+     NSLog(@"Identical: %@", group);
+ }
  @endcode
  
  @note
- • If @c subdirectoryName does not contain "/" at the beginning, it will automatically be added.
+ • Only regular files are compared. Empty files and symbolic links are left out.
  
- • Under the hood, this function builds a path by appending @c subdirectoryName to @c existingDirectoryPath as a path component, and then calls @c createDirectory() using this new path.
+ • Hard links to the same file are already sharing their data, so only one of them is listed.
  
- @warning @c existingDirectoryPath must be a valid path that is accessible in the app's sandbox.
+ • Matches are found by hash. @c replaceDuplicateFilesInGroups:withLinkType: compares the files byte for byte before replacing anything.
  
- @param subdirectoryName The name of the subdirectory you wish to create.
- @param existingDirectoryPath The path of the directory in which you wish to make a subdirectory.
+ @param directoryPaths The paths of the directories you'd like to look for duplicates in.
  
- @return @c BOOL - @c YES if the subdirectory was created, and @c NO if an error occured.
+ @return @c NSArray - One array per group of identical files, each holding at least two paths in sorted order. Groups of larger files come first.
  */
-- (BOOL)createSubdirectoryNamed:(nonnull NSString *)subdirectoryName in:(nonnull NSString *)existingDirectoryPath;
-
+- (NSArray<NSArray<NSString *> *> *)findDuplicateFilesInDirectories:(NSArray<NSString *> *)directoryPaths;
 
 
 /*!
- @brief Copies the contents of one directory into another synchronously.
+ @brief Frees the space taken up by duplicate files, by making them share their data.
  
- @discussion Synchronously performs a shallow copy of the contents of @c sourceDirectoryPath into @c destinationDirectoryPath.
+ @discussion In each group, every file after the first is replaced with a hard link to, or a clone of, the first one. Each replacement is made under a temporary name and renamed into place, so a duplicate's path never stops existing.
  
  @code
- [manager copyDirectoryFrom:manager.resourcesDirectory to:manager.documentsDirectory];
+ NSArray<NSArray<NSString *> *> *duplicateGroups = [manager findDuplicateFiles];
+ [manager replaceDuplicateFilesInGroups:duplicateGroups withLinkType:TOMLinkTypeClone];
  @endcode
  
- @note
- • If @c destinationDirectoryPath does not exist, it will be created.
+ @note • Each file is compared with the first one byte for byte just before it is replaced, and is skipped if they differ.
+ @note • Hard links and clones can't cross volumes.
  
- • It does not copy the current directory (“.”), parent directory (“..”), or resource forks (files that begin with “._”) but it does copy other hidden files (files that begin with a period character).
+ @warning With @c TOMLinkTypeHardLink , writing to any file in a group changes all of them.
  
- @param sourceDirectoryPath The path of the directory who's contents you'd like to copy.
- @param destinationDirectoryPath The path of the directory into which you'd like the contents of @c directoryPath to be copied.
+ @param duplicateGroups Groups of identical files, as returned by @c findDuplicateFilesInDirectories: .
+ @param linkType Whether to replace duplicates with hard links or clones.
  
- @return @c BOOL - @c YES if the directory was copied, and @c NO if an error occured.
+ @return @c NSUInteger - The number of files that were replaced.
  */
-- (BOOL)copyDirectoryFrom:(nonnull NSString *)sourceDirectoryPath to:(nonnull NSString *)destinationDirectoryPath;
+- (NSUInteger)replaceDuplicateFilesInGroups:(NSArray<NSArray<NSString *> *> *)duplicateGroups withLinkType:(TOMLinkType)linkType;
 
 
 /*!
- @brief Copies the contents of one directory into another synchronously.
+ @brief Writes @c data to the file at @c filePath, replacing whatever it held.
  
- @discussion Synchronously performs a shallow copy of the contents of @c sourceDirectoryPath into @c destinationDirectoryPath.
+ @discussion With @c atomically , the data is written to a temporary file next to @c filePath, flushed to the disk, and renamed into place, and then the directory is flushed too. A crash leaves the file holding either its old contents or all of @c data - never a mix, and never nothing.
  
  @code
- [manager copyDirectoryFrom:manager.mainBundleDirectory to:manager.documentsDirectory regardlessOfType:NO];
+ [manager writeData:settingsData toFileAtPath:settingsPath atomically:YES];
  @endcode
  
- @note
- • If @c destinationDirectoryPath does not exist, it will be created.
- 
- • It does not copy the current directory (“.”), parent directory (“..”), or resource forks (files that begin with “._”) but it does copy other hidden files (files that begin with a period character).
- 
- @warning Ignoring the type if not recommended. Do so at your own risk.
+ @note • @c writeData:toFileAtPath:options: can share the flushes between writes that happen at once.
+ @note • An atomic write keeps the permissions of the file it replaces.
  
- @param sourceDirectoryPath The path of the directory who's contents you'd like to copy.
- @param destinationDirectoryPath The path of the directory into which you'd like the contents of @c directoryPath to be copied.
- @param ignoreType If @c YES, continue with copying even if @c sourceDirectoryPath is not a directory
+ @param data The data you'd like to write.
+ @param filePath The path of the file you'd like to write to. Its directory must already exist.
+ @param atomically If @c YES, the file is replaced in one step, and the data is on the disk when this returns.
  
- @return @c BOOL - @c YES if the directory was copied, and @c NO if an error occured.
+ @return @c BOOL - @c YES if the file was written, and @c NO if an error occured.
  */
-- (BOOL)copyDirectoryFrom:(nonnull NSString *)sourceDirectoryPath to:(nonnull NSString *)destinationDirectoryPath regardlessOfType:(BOOL)ignoreType;
+- (BOOL)writeData:(NSData *)data toFileAtPath:(NSString *)filePath atomically:(BOOL)atomically;
 
 
 /*!
- @brief Moves the contents of one directory into another synchronously.
+ @brief Writes @c data to the file at @c filePath, using @c options.
  
- @discussion Synchronously performs a shallow move of the contents of @c sourceDirectoryPath into @c destinationDirectoryPath.
+ @discussion Making a write durable means asking the drive to empty its cache, which takes milliseconds no matter how little was written. With @c TOMWriteOptionsGroupCommit , each write only orders its own data ahead of what comes after it, and then waits for a flush shared with every other write that finished around the same time. Each directory is flushed once per group, and the drive's cache is emptied once per group, so many small files written at once cost about as much as one.
  
  @code
- [manager moveDirectoryFrom:manager.mainBundleDirectory to:manager.documentsDirectory];
+ // Called from many threads at once, these share their flushes
+ [manager writeData:recordData toFileAtPath:recordPath options:TOMWriteOptionsGroupCommit];
  @endcode
  
- @note
- • If @c destinationDirectoryPath does not exist, it will be created.
- 
- • It does not move the current directory (“.”), parent directory (“..”), or resource forks (files that begin with “._”) but it does move other hidden files (files that begin with a period character).
+ @note • Writes from one thread happen one after another, so they can't share anything. Use @c writeDataForFiles:options: , or the asynchronous version of this method.
+ @note • If a shared flush fails, every write in its group returns @c NO .
  
- @param sourceDirectoryPath The path of the directory who's contents you'd like to move.
- @param destinationDirectoryPath The path of the directory into which you'd like the contents of @c directoryPath to be moved.
+ @param data The data you'd like to write.
+ @param filePath The path of the file you'd like to write to. Its directory must already exist.
+ @param options Whether to replace the file in one step, and whether to share the flush that makes the write durable.
  
- @return @c BOOL - @c YES if the directory was moved, and @c NO if an error occured.
+ @return @c BOOL - @c YES if the file was written, and @c NO if an error occured.
  */
-- (BOOL)moveDirectoryFrom:(nonnull NSString *)sourceDirectoryPath to:(nonnull NSString *)destinationDirectoryPath;
+- (BOOL)writeData:(NSData *)data toFileAtPath:(NSString *)filePath options:(TOMWriteOptions)options;
 
 
 /*!
- @brief Moves the contents of one directory into another synchronously.
+ @brief Writes many files at once, using @c options.
  
- @discussion Synchronously performs a shallow move of the contents of @c sourceDirectoryPath into @c destinationDirectoryPath.
+ @discussion The files are written in parallel, so with @c TOMWriteOptionsGroupCommit they share their flushes, as described for @c writeData:toFileAtPath:options: .
  
  @code
- [manager moveDirectoryFrom:manager.resourcesDirectory to:manager.documentsDirectory regardlessOfType:NO];
+ NSUInteger written = [manager writeDataForFiles:@{ firstPath : firstData, secondPath : secondData } options:TOMWriteOptionsGroupCommit];
  @endcode
  
- @note
- • If @c destinationDirectoryPath does not exist, it will be created.
+ @param dataByFilePath The data you'd like to write, keyed by the path of the file to write it to.
+ @param options Whether to replace the files in one step, and whether to share the flushes that make the writes durable.
  
- • It does not move the current directory (“.”), parent directory (“..”), or resource forks (files that begin with “._”) but it does move other hidden files (files that begin with a period character).
+ @return @c NSUInteger - The number of files that were written.
+ */
+- (NSUInteger)writeDataForFiles:(NSDictionary<NSString *, NSData *> *)dataByFilePath options:(TOMWriteOptions)options;
+
+
+/*!
+ @brief Returns a writer that appends to the file at @c filePath through a buffer.
  
- @warning Ignoring the type if not recommended. Do so at your own risk.
+ @discussion The same as @c bufferedWriterForFileAtPath:bufferSize:flushInterval: , with a 64 KB buffer that is written out at least once a second.
  
- @param sourceDirectoryPath The path of the directory who's contents you'd like to move.
- @param destinationDirectoryPath The path of the directory into which you'd like the contents of @c directoryPath to be moved.
- @param ignoreType If @c YES, continue with moving even if @c sourceDirectoryPath is not a directory
+ @code
+ TOMBufferedFileWriter *telemetryWriter = [manager bufferedWriterForFileAtPath:[manager.libraryDirectory stringByAppendingPathComponent:@"Telemetry.log"]];
  
- @return @c BOOL - @c YES if the directory was moved, and @c NO if an error occured.
+ [telemetryWriter appendString:@"launched\n"];
+ @endcode
+ 
+ @param filePath The path of the file you'd like to append to. It is created if it doesn't exist.
+ 
+ @return @c TOMBufferedFileWriter - The writer, or @c nil if the file couldn't be opened.
  */
-- (BOOL)moveDirectoryFrom:(nonnull NSString *)sourceDirectoryPath to:(nonnull NSString *)destinationDirectoryPath regardlessOfType:(BOOL)ignoreType;
+- (nullable TOMBufferedFileWriter *)bufferedWriterForFileAtPath:(NSString *)filePath;
 
 
 /*!
- @brief Renames the directory located at @c directoryPath to @c newName.
+ @brief Returns a writer that appends to the file at @c filePath through a buffer of @c bufferSize bytes.
  
- @discussion Under the hood, what this really does is creates a new directory at the same level as @c directoryPath with the name of @c newName, then moves the contents of @c directoryPath to @c newName's directory.
+ @discussion Opening and closing a file for every record costs several system calls each time. The writer keeps the file open instead, and gathers records in its buffer until it is full, or until @c flushInterval has passed, so a steady stream of small records costs about one write per buffer. See @c TOMBufferedFileWriter .
  
  @code
- NSString *directoryToRename = [manager.documentsDirectory stringByAppendingPathComponent:@"Subdirectory"];
- [manager renameDirectoryAtPath:directoryToRename to:@"RenamedDirectory"];
+ TOMBufferedFileWriter *telemetryWriter = [manager bufferedWriterForFileAtPath:telemetryPath bufferSize:256 * 1024 flushInterval:5];
  @endcode
  
- @warning Do not attempt to use this method to rename files
- 
- @param directoryPath The path of the directory you'd like to rename.
- @param newName The new name you'd like to give the directory.
+ @param filePath The path of the file you'd like to append to. It is created if it doesn't exist.
+ @param bufferSize How many bytes to gather before writing them out.
+ @param flushInterval How long appended data may wait in the buffer at most, in seconds, or @c 0 to wait until the buffer fills up or is flushed.
  
- @return @c BOOL - @c YES if the directory was renamed, and @c NO if an error occured.
+ @return @c TOMBufferedFileWriter - The writer, or @c nil if the file couldn't be opened.
  */
-- (BOOL)renameDirectoryAtPath:(nonnull NSString *)directoryPath to:(nonnull NSString *)newName;
+- (nullable TOMBufferedFileWriter *)bufferedWriterForFileAtPath:(NSString *)filePath bufferSize:(NSUInteger)bufferSize flushInterval:(NSTimeInterval)flushInterval;
 
 
 /*!
- @brief Renames the directory located at @c directoryPath to @c newName.
+ @brief Asynchronously creates a new directory at @c newDirectoryPath.
  
- @discussion Under the hood, what this really does is creates a new directory at the same level as @c directoryPath with the name of @c newName, then moves the contents of @c directoryPath to @c newName's directory.
+ @discussion The asynchronous version of @c createDirectoryAtPath: .
  
  @code
- NSString *directoryToRename = [manager.documentsDirectory stringByAppendingPathComponent:@"SubDirectory"];
- [manager renameDirectoryAtPath:directoryToRename to:@"RenamedDirectory" regardlessOfType:NO];
+ [manager createDirectoryAtPath:examplePath completionHandler:^(BOOL success) {
+     NSLog(@"Created: %d", success);
+ }];
  @endcode
  
- @warning Do not attempt to use this method to rename files
- 
- @warning Ignoring the type if not recommended. Do so at your own risk.
+ @note • The operation runs on this manager's operation queue, which runs at most @c maximumConcurrentOperations operations at once.
+ @note • @c completionHandler is called on the main queue.
  
- @param directoryPath The path of the directory you'd like to rename.
- @param newName The new name you'd like to give the directory.
- @param ignoreType If @c YES, continue with renaming even if `directoryPath` is not a directory
+ @param newDirectoryPath The path of the directory you'd like to create.
+ @param completionHandler The block to call once the operation has finished. @c success is @c YES if the operation succeeded, and @c NO if an error occured.
  
- @return @c BOOL - @c YES if the directory was renamed, and @c NO if an error occured.
+ @return @c Void - the result is handed to @c completionHandler.
  */
-- (BOOL)renameDirectoryAtPath:(nonnull NSString *)directoryPath to:(nonnull NSString *)newName regardlessOfType:(BOOL)ignoreType;
+- (void)createDirectoryAtPath:(NSString *)newDirectoryPath completionHandler:(nullable void (^)(BOOL success))completionHandler;
 
 
 /*!
- @brief Deletes a directory and its contents.
+ @brief Asynchronously copies the directory at @c sourceDirectoryPath into @c destinationDirectoryPath.
  
- @discussion Deletes a directory and its contents.
+ @discussion The asynchronous version of @c copyDirectoryFrom:to: .
  
  @code
- [manager deleteDirectory:manager.documentsDirectory];
+ [manager copyDirectoryFrom:sourcePath to:destinationPath completionHandler:^(BOOL success) {
+     NSLog(@"Copied: %d", success);
+ }];
  @endcode
  
- @param directoryPath The path of the directory you'd like to delete.
+ @note • The operation runs on this manager's operation queue, which runs at most @c maximumConcurrentOperations operations at once.
+ @note • @c completionHandler is called on the main queue.
  
- @return @c BOOL - @c YES if the directory was deleted, and @c NO if an error occured.
+ @param sourceDirectoryPath The path of the directory you'd like to copy.
+ @param destinationDirectoryPath The path of the directory you'd like to copy it into.
+ @param completionHandler The block to call once the operation has finished. @c success is @c YES if the operation succeeded, and @c NO if an error occured.
+ 
+ @return @c Void - the result is handed to @c completionHandler.
  */
-- (BOOL)deleteDirectory:(nonnull NSString *)directoryPath;
+- (void)copyDirectoryFrom:(NSString *)sourceDirectoryPath to:(NSString *)destinationDirectoryPath completionHandler:(nullable void (^)(BOOL success))completionHandler;
 
 
 /*!
- @brief Deletes a directory and its contents.
+ @brief Asynchronously moves the directory at @c sourceDirectoryPath into @c destinationDirectoryPath.
  
- @discussion Deletes a directory and its contents.
+ @discussion The asynchronous version of @c moveDirectoryFrom:to: .
  
  @code
- [manager deleteDirectory:manager.documentsDirectory regardlessOfType:NO];
+ [manager moveDirectoryFrom:sourcePath to:destinationPath completionHandler:^(BOOL success) {
+     NSLog(@"Moved: %d", success);
+ }];
  @endcode
  
- @param directoryPath The path of the directory you'd like to delete.
- @param ignoreType If @c YES, continue with deleting even if @c directoryPath is not a directory
+ @note • The operation runs on this manager's operation queue, which runs at most @c maximumConcurrentOperations operations at once.
+ @note • @c completionHandler is called on the main queue.
  
+ @param sourceDirectoryPath The path of the directory you'd like to move.
+ @param destinationDirectoryPath The path of the directory you'd like to move it into.
+ @param completionHandler The block to call once the operation has finished. @c success is @c YES if the operation succeeded, and @c NO if an error occured.
  
- @return @c BOOL - @c YES if the directory was deleted, and @c NO if an error occured.
+ @return @c Void - the result is handed to @c completionHandler.
  */
-- (BOOL)deleteDirectory:(nonnull NSString *)directoryPath regardlessOfType:(BOOL)ignoreType;
+- (void)moveDirectoryFrom:(NSString *)sourceDirectoryPath to:(NSString *)destinationDirectoryPath completionHandler:(nullable void (^)(BOOL success))completionHandler;
 
 
 /*!
- @brief Returns the filepath of a file located in the desired directory.
+ @brief Asynchronously deletes the directory at @c directoryPath.
  
- @discussion Returns the filepath of a file named @c filename located in the directory @c directoryPath, therefore verifying it exists in the expected location.
+ @discussion The asynchronous version of @c deleteDirectory: .
  
  @code
- NSString *exampleFilePath = [manager getPathForFileNamed:@"example.png" inDirectory:manager.documentsDirectory];
+ [manager deleteDirectory:examplePath completionHandler:^(BOOL success) {
+     NSLog(@"Deleted: %d", success);
+ }];
  @endcode
  
- @warning @c directoryPath must be a directory, not a file.
+ @note • The operation runs on this manager's operation queue, which runs at most @c maximumConcurrentOperations operations at once.
+ @note • @c completionHandler is called on the main queue.
  
- @param filename The name of the file who's full path you'd like to retrieve.
- @param directoryPath The path of the directory which contains the file @c filename.
+ @param directoryPath The path of the directory you'd like to delete.
+ @param completionHandler The block to call once the operation has finished. @c success is @c YES if the operation succeeded, and @c NO if an error occured.
  
- @return @c NSString - The full path for the desired file.
+ @return @c Void - the result is handed to @c completionHandler.
  */
-- (NSString *)getPathForFileNamed:(NSString *)filename inDirectory:(NSString *)directoryPath;
+- (void)deleteDirectory:(NSString *)directoryPath completionHandler:(nullable void (^)(BOOL success))completionHandler;
 
 
 /*!
- @brief Returns the filepath of a file located in an unknown directory.
+ @brief Asynchronously searches the sandbox for a file named @c filename.
  
- @discussion Recursively searches all accessible directories in the app's sandbox and returns the path to the first instance of a file named @ filename.
+ @discussion The asynchronous version of @c findAndGetPathForFileNamed: .
  
  @code
- NSString *exampleFilePath = [manager findAndGetPathForFileNamed:@"example.png"];
+ [manager findAndGetPathForFileNamed:@"example.png" completionHandler:^(NSString *filePath) {
+     imageView.image = [UIImage imageWithContentsOfFile:filePath];
+ }];
  @endcode
  
- @note For use when the directory the desired file is located in is not known.
+ @note • The operation runs on this manager's operation queue, which runs at most @c maximumConcurrentOperations operations at once.
+ @note • @c completionHandler is called on the main queue.
  
- @param filename The name of the file you'd like to retrieve the path of, but don't know the directory of.
+ @param filename The name of the file you'd like to find.
+ @param completionHandler The block to call once the search has finished. @c filePath is the full path of the file, or @c nil if it wasn't found.
  
- @return @c NSString - The full path for the desired file.
+ @return @c Void - the result is handed to @c completionHandler.
  */
-- (NSString *)findAndGetPathForFileNamed:(NSString *)filename;
+- (void)findAndGetPathForFileNamed:(NSString *)filename completionHandler:(void (^)(NSString * _Nullable filePath))completionHandler;
 
 
 /*!
- @brief Copies a file to a specified directory synchronously.
+ @brief Asynchronously copies the file at @c filePath into @c destinationDirectoryPath.
  
- @discussion Synchronously performs a shallow copy of the file with the path @c filePath to a directory with the path @c directoryPath.
+ @discussion The asynchronous version of @c copyFileAtPath:to: .
  
  @code
- NSString *exampleFilePath = [manager.resourcesDirectory stringByAppendingPathComponent:@"example.txt"];
- [manager copyFileAtPath:exampleFilePath to:manager.documentsDirectory];
+ [manager copyFileAtPath:exampleFilePath to:manager.tempDirectory completionHandler:^(BOOL success) {
+     NSLog(@"Copied: %d", success);
+ }];
  @endcode
  
- @note If @c directoryPath doesn't exist, it is created.
+ @note • The operation runs on this manager's operation queue, which runs at most @c maximumConcurrentOperations operations at once.
+ @note • @c completionHandler is called on the main queue.
  
  @param filePath The path of the file you'd like to copy.
- @param destinationDirectoryPath The path of the directory into which you'd like the file to be copied.
+ @param destinationDirectoryPath The path of the directory you'd like to copy it into.
+ @param completionHandler The block to call once the operation has finished. @c success is @c YES if the operation succeeded, and @c NO if an error occured.
  
- @return @c BOOL - @c YES if the file was copied, and @c NO if an error occured.
+ @return @c Void - the result is handed to @c completionHandler.
  */
-- (BOOL)copyFileAtPath:(NSString *)filePath to:(NSString *)destinationDirectoryPath;
+- (void)copyFileAtPath:(NSString *)filePath to:(NSString *)destinationDirectoryPath completionHandler:(nullable void (^)(BOOL success))completionHandler;
 
 
 /*!
- @brief Copies a file to a specified directory synchronously.
+ @brief Asynchronously moves the file at @c filePath into @c destinationDirectoryPath.
  
- @discussion Synchronously performs a shallow copy of the file with the path @c filePath to a directory with the path @c directoryPath.
+ @discussion The asynchronous version of @c moveFileAtPath:to: .
  
  @code
- NSString *exampleFilePath = [manager.resourcesDirectory stringByAppendingPathComponent:@"example.txt"];
- [manager copyFileAtPath:exampleFilePath to:manager.documentsDirectory regardlessOfType:NO];
+ [manager moveFileAtPath:exampleFilePath to:manager.tempDirectory completionHandler:^(BOOL success) {
+     NSLog(@"Moved: %d", success);
+ }];
  @endcode
  
- @note If @c directoryPath doesn't exist, it is created.
- 
- @warning Ignoring the type if not recommended. Do so at your own risk.
+ @note • The operation runs on this manager's operation queue, which runs at most @c maximumConcurrentOperations operations at once.
+ @note • @c completionHandler is called on the main queue.
  
- @param filePath The path of the file you'd like to copy.
- @param destinationDirectoryPath The path of the directory into which you'd like the file to be copied.
- @param ignoreType If @c YES, continue with copying even if @c filePath is not a file.
+ @param filePath The path of the file you'd like to move.
+ @param destinationDirectoryPath The path of the directory you'd like to move it into.
+ @param completionHandler The block to call once the operation has finished. @c success is @c YES if the operation succeeded, and @c NO if an error occured.
  
- @return @c BOOL - @c YES if the file was copied, and @c NO if an error occured.
+ @return @c Void - the result is handed to @c completionHandler.
  */
-- (BOOL)copyFileAtPath:(nonnull NSString *)filePath to:(nonnull NSString *)destinationDirectoryPath regardlessOfType:(BOOL)ignoreType;
+- (void)moveFileAtPath:(NSString *)filePath to:(NSString *)destinationDirectoryPath completionHandler:(nullable void (^)(BOOL success))completionHandler;
 
 
 /*!
- @brief Finds, then copies a file to a specified directory.
+ @brief Asynchronously deletes the file at @c filePath.
  
- @discussion Recursively searches all accessible directories for a file named @c filename, then copies the first found instance to a directory with the path @c directoryPath.
+ @discussion The asynchronous version of @c deleteFileAtPath: .
  
  @code
- [manager findAndCopyFileNamed:@"example.txt" to:manager.documentsDirectory];
+ [manager deleteFileAtPath:exampleFilePath completionHandler:^(BOOL success) {
+     NSLog(@"Deleted: %d", success);
+ }];
  @endcode
  
- @note
- • If @c directoryPath doesn't exist, it is created.
- 
- • Under the hood, this simply calls @c findAndGetPathForFile() then @c copyFile()
+ @note • The operation runs on this manager's operation queue, which runs at most @c maximumConcurrentOperations operations at once.
+ @note • @c completionHandler is called on the main queue.
  
- @param filename The name of the file you'd like to find and copy.
- @param destinationDirectoryPath The path of the directory into which you'd like the file to be copied, once found.
+ @param filePath The path of the file you'd like to delete.
+ @param completionHandler The block to call once the operation has finished. @c success is @c YES if the operation succeeded, and @c NO if an error occured.
  
- @return @c BOOL - @c YES if the file was copied, and @c NO if an error occured.
+ @return @c Void - the result is handed to @c completionHandler.
  */
-- (BOOL)findAndCopyFileNamed:(NSString *)filename to:(NSString *)destinationDirectoryPath;
+- (void)deleteFileAtPath:(NSString *)filePath completionHandler:(nullable void (^)(BOOL success))completionHandler;
 
 
 /*!
- @brief Moves a file to a specified directory synchronously.
+ @brief Asynchronously reads the contents of the file at @c filePath.
  
- @discussion Synchronously performs a shallow move of the file with the path @c filePath to a directory with the path @c directoryPath.
+ @discussion The asynchronous version of @c retrieveDataForFileAtPath: .
  
  @code
- NSString *exampleFilePath = [manager.mainBundleDirectory stringByAppendingPathComponent:@"example.txt"];
- [manager moveFileAtPath:exampleFilePath to:manager.documentsDirectory];
+ [manager retrieveDataForFileAtPath:exampleFilePath completionHandler:^(NSData *data) {
+     [self displayData:data];
+ }];
  @endcode
  
- @note If @c directoryPath doesn't exist, it is created.
+ @note • The operation runs on this manager's operation queue, which runs at most @c maximumConcurrentOperations operations at once.
+ @note • @c completionHandler is called on the main queue.
  
- @param filePath The path of the file you'd like to move.
- @param destinationDirectoryPath The path of the directory into which you'd like the file to be moved.
+ @param filePath The path of the file you'd like to read.
+ @param completionHandler The block to call once the file has been read. @c data is the file's contents, or @c nil if it couldn't be read.
  
- @return @c BOOL - @c YES if the file was moved, and @c NO if an error occured.
+ @return @c Void - the result is handed to @c completionHandler.
  */
-- (BOOL)moveFileAtPath:(NSString *)filePath to:(NSString *)destinationDirectoryPath;
+- (void)retrieveDataForFileAtPath:(NSString *)filePath completionHandler:(void (^)(NSData * _Nullable data))completionHandler;
 
 
 /*!
- @brief Moves a file to a specified directory synchronously.
+ @brief Asynchronously writes @c data to the file at @c filePath, using @c options.
  
- @discussion Synchronously performs a shallow move of the file with the path @c filePath to a directory with the path @c directoryPath.
+ @discussion The asynchronous version of @c writeData:toFileAtPath:options: . Writes started close together run side by side, so with @c TOMWriteOptionsGroupCommit they share their flushes.
  
  @code
- NSString *exampleFilePath = [manager.mainBundleDirectory stringByAppendingPathComponent:@"example.txt"];
- [manager moveFileAtPath:exampleFilePath to:manager.documentsDirectory regardlessOfType:NO];
+ [manager writeData:recordData toFileAtPath:recordPath options:TOMWriteOptionsGroupCommit completionHandler:^(BOOL success) {
+     NSLog(@"Saved: %d", success);
+ }];
  @endcode
  
- @note If @c directoryPath doesn't exist, it is created.
- 
- @warning Ignoring the type if not recommended. Do so at your own risk.
+ @note • The operation runs on this manager's operation queue, which runs at most @c maximumConcurrentOperations operations at once.
+ @note • @c completionHandler is called on the main queue.
  
- @param filePath The path of the file you'd like to move.
- @param destinationDirectoryPath The path of the directory into which you'd like the file to be moved.
- @param ignoreType If @c YES, continue with moving even if @c filePath is not a file.
+ @param data The data you'd like to write.
+ @param filePath The path of the file you'd like to write to.
+ @param options Whether to replace the file in one step, and whether to share the flush that makes the write durable.
+ @param completionHandler The block to call once the operation has finished. @c success is @c YES if the operation succeeded, and @c NO if an error occured.
  
- @return @c BOOL - @c YES if the file was moved, and @c NO if an error occured.
+ @return @c Void - the result is handed to @c completionHandler.
  */
-- (BOOL)moveFileAtPath:(nonnull NSString *)filePath to:(nonnull NSString *)destinationDirectoryPath regardlessOfType:(BOOL)ignoreType;
+- (void)writeData:(NSData *)data toFileAtPath:(NSString *)filePath options:(TOMWriteOptions)options completionHandler:(nullable void (^)(BOOL success))completionHandler;
 
 
 /*!
- @brief Finds, then moves a file to a specified directory.
+ @brief Asynchronously works out how much space a directory and everything inside it takes up.
  
- @discussion Recursively searches all accessible directories for a file named @c filename, then moves the first found instance to a directory with the path @c directoryPath.
+ @discussion The asynchronous version of @c sizeOfDirectoryAtPath: .
  
  @code
- [manager findAndCopyFile:@"example.txt" to:manager.documentsDirectory];
+ [manager sizeOfDirectoryAtPath:manager.tempDirectory completionHandler:^(TOMDirectorySize *size) {
+     self.tempSizeLabel.text = [NSByteCountFormatter stringFromByteCount:(long long)size.allocatedSize countStyle:NSByteCountFormatterCountStyleFile];
+ }];
  @endcode
  
- @note
- • If @c directoryPath doesn't exist, it is created.
- 
- • Under the hood, this simply calls @c findAndGetPathForFile() then @c copyFile()
+ @note • The operation runs on this manager's operation queue, which runs at most @c maximumConcurrentOperations operations at once.
+ @note • @c completionHandler is called on the main queue.
  
- @param filename The name of the file you'd like to find and move.
- @param destinationDirectoryPath The path of the directory into which you'd like the file to be moved, once found.
+ @param directoryPath The path of the directory you'd like the size of.
+ @param completionHandler The block to call once the directory has been sized. @c size is @c nil if @c directoryPath is not a directory.
  
- @return @c BOOL - @c YES if the file was moved, and @c NO if an error occured.
+ @return @c Void - the result is handed to @c completionHandler.
  */
-- (BOOL)findAndMoveFileNamed:(NSString *)filename to:(NSString *)destinationDirectoryPath;
+- (void)sizeOfDirectoryAtPath:(NSString *)directoryPath completionHandler:(void (^)(TOMDirectorySize * _Nullable size))completionHandler;
+
 
+/*!
+ @brief Waits until every asynchronous operation started on this manager has finished.
+ 
+ @discussion Blocks the calling thread until every operation started by one of the @c completionHandler: methods has finished. Completion handlers are called on the main queue afterwards, so they may not have run yet when this returns.
+ 
+ @warning Don't call this from the main queue while waiting on a completion handler, or it will never be called.
+ 
+ @return @c Void - there isn't anything to return.
+ */
+- (void)waitUntilAllOperationsAreFinished;
 
 
 /*!
- @brief Deletes the file located at @c filePath.
+ @brief Starts recording metrics.
  
- @discussion Deletes the file located at @c filePath.
+ @discussion Records how many times each method is called and how long each call takes, along with how many directory entries were visited, how many bytes were read and written, and how many system calls of each kind were made.
  
  @code
- NSString *exampleFilePath = [manager.documentsDirectory stringByAppendingPathComponent:@"example.txt"];
- [manager deleteFile:exampleFilePath];
+ [TOMFileManager enableMetrics];
+ [manager findAndGetPathForFileNamed:@"example.png"];
+ NSLog(@"%@", [TOMFileManager metricsSnapshot]);
  @endcode
  
- @param filePath The path of the file you'd like to delete.
+ @note
+ • Metrics are shared by every @c TOMFileManager in the process.
  
- @return @c BOOL - @c YES if the file was deleted, and @c NO if an error occured.
+ • While metrics are disabled, they cost next to nothing.
+ 
+ @return @c Void - there isn't anything to return.
  */
-- (BOOL)deleteFileAtPath:(NSString *)filePath;
++ (void)enableMetrics;
 
 
 /*!
- @brief Deletes the file located at @c filePath.
+ @brief Stops recording metrics.
  
- @discussion Deletes the file located at @c filePath.
+ @discussion Stops recording metrics. Everything recorded so far is kept, until @c resetMetrics is called.
  
  @code
- NSString *exampleFilePath = [manager.documentsDirectory stringByAppendingPathComponent:@"example.txt"];
- [manager deleteFile:exampleFilePath regardlessOfType:NO];
+ [TOMFileManager disableMetrics];
  @endcode
  
- @param filePath The path of the file you'd like to delete.
- @param ignoreType If @c YES, continue with deleting even if @c filePath is not a file
+ @return @c Void - there isn't anything to return.
+ */
++ (void)disableMetrics;
+
+
+/*!
+ @brief Sets every recorded metric back to zero.
  
- @return @c BOOL - @c YES if the file was deleted, and @c NO if an error occured.
+ @code
+ [TOMFileManager resetMetrics];
+ @endcode
+ 
+ @return @c Void - there isn't anything to return.
  */
-- (BOOL)deleteFileAtPath:(NSString *)filePath regardlessOfType:(BOOL)ignoreType;
++ (void)resetMetrics;
 
 
 /*!
- @brief Finds, then deletes a file named @c filename.
+ @brief Returns a snapshot of the recorded metrics.
  
- @discussion Recursively searches all available directories for a file named @c filename, then deletes the first found instance.
+ @discussion Returns a dictionary with three keys:
+ 
+ • @c "enabled" - whether metrics are being recorded.
+ 
+ • @c "counters" - @c entriesVisited , @c bytesRead , @c bytesWritten , and a count of each kind of system call (@c openCalls , @c statCalls , @c readCalls , @c writeCalls , @c mkdirCalls , @c unlinkCalls , @c renameCalls , @c cloneCalls , @c copyfileCalls , @c syncCalls , @c mmapCalls , @c accessCalls ).
+ 
+ • @c "methods" - for every method that has been called, its @c calls , @c totalNanoseconds , @c meanNanoseconds , @c p50Nanoseconds and @c p99Nanoseconds , and a @c latencyHistogram of power of two buckets.
  
  @code
- [manager findAndDeleteFile:@"example.txt"];
+ NSDictionary *metrics = [TOMFileManager metricsSnapshot];
+ NSNumber *bytesRead = metrics[@"counters"][@"bytesRead"];
  @endcode
  
- @param filename The name of the file you'd like to delete, once found.
+ @note The percentiles are the upper bounds of the histogram buckets they fall in, so they are accurate to within a factor of two.
  
- @return @c BOOL - @c YES if the file was deleted, and @c NO if an error occured.
+ @return @c NSDictionary - The recorded metrics.
  */
-- (BOOL)findAndDeleteFileNamed:(NSString *)filename;
++ (NSDictionary<NSString *, id> *)metricsSnapshot;
 
 
 /*!
- @brief Checks if a file exists at the given path.
+ @brief Returns a snapshot of the recorded metrics as JSON.
  
- @discussion Checks if @c filePath is an existing file. Really, it's just a call through to @c NSFileManager, primarily provided for consistency.
+ @discussion The same as @c metricsSnapshot , encoded as JSON with sorted keys.
  
  @code
- NSString *exampleFilePath = [manager.documentsDirectory stringByAppendingPathComponent:@"example.txt"];
- [manager fileExistsAtPath:exampleFilePath];
+ [[TOMFileManager metricsJSONData] writeToFile:metricsPath atomically:YES];
  @endcode
  
- @param filePath The path to the file you would like to verify the existence of.
- 
- @return @c BOOL - @c YES if the file exists, and @c NO if it doesn't.
+ @return @c NSData - The recorded metrics as JSON, or @c nil if an error occured.
  */
-- (BOOL)fileExistsAtPath:(NSString  *)filePath;
++ (nullable NSData *)metricsJSONData;
 
 
 /*!
- @brief Returns the number of files in a directory.
+ @brief Sets the block every log message is handed to.
  
- @discussion Returns the number of files in @c directoryPath.
+ @discussion Log messages are handed to @c handler on a background queue, one at a time and in order, instead of being written with @c NSLog() . Passing @c nil goes back to @c NSLog() .
  
  @code
- NSUInteger fileCount = [manager numberOfFilesInDirectoryAtPath:manager.documentsDirectory];
+ [TOMFileManager setLogHandler:^(TOMLogLevel level, NSString *message) {
+     os_log(OS_LOG_DEFAULT, "%{public}@", message);
+ }];
  @endcode
  
- @param directoryPath The path you'd like to count the contents of.
+ @note
+ • Logging never waits on the handler. Messages are queued in a fixed size buffer, and if the handler falls far enough behind to fill it, new messages are dropped and the number dropped is logged once there is room.
  
- @return @c NSUInteger - The number of files in the specified directory.
+ • The handler is shared by every @c TOMFileManager in the process.
+ 
+ • Building with @c TOM_MAXIMUM_LOG_LEVEL defined to a @c TOMLogLevel compiles out every message above that level.
+ 
+ @param handler The block to hand log messages to, or @c nil to use @c NSLog() .
+ 
+ @return @c Void - there isn't anything to return.
  */
-- (NSUInteger)numberOfFilesInDirectoryAtPath:(NSString *)directoryPath;
++ (void)setLogHandler:(nullable void (^)(TOMLogLevel level, NSString *message))handler;
 
 
 /*!
- @brief Returns the data for the file at @c filePath.
- 
- @discussion Creates a data object by reading every byte from the file at a @c filePath.
+ @brief Waits until every log message so far has been handed to the log handler.
  
  @code
- NSString *exampleFilePath = [manager.documentsDirectory stringByAppendingPathComponent:@"example.txt"];
- NSData *fileData = [manager retrieveDataForFileAtPath:exampleFilePath];
+ [TOMFileManager flushLog];
  @endcode
  
- @param filePath The path to the file you'd like to get the data for.
- 
- @return @c NSData - The data for the requested file - @c NULL if file doesn't exist.
+ @return @c Void - there isn't anything to return.
  */
-- (NSData*)retrieveDataForFileAtPath:(NSString *)filePath;
++ (void)flushLog;
 
 
 /*!
  @brief Sets the TOMFileManager object into Debug Mode.
  
- @discussion Sets the TOMFileManager object into Debug Mode. This will print all @c NSLog() statements, instead of just the ones containing errors. By default, Debug Mode is off.
+ @discussion Sets the TOMFileManager object into Debug Mode, by setting @c logLevel to @c TOMLogLevelDebug , or back to @c TOMLogLevelError . This will log everything, instead of just errors. By default, Debug Mode is off.
  
  @code
  [manager setDebugMode:YES];
@@ -556,7 +2251,7 @@ NS_ASSUME_NONNULL_BEGIN
  
  @return @c Void - there isn't anything to return.
  */
-- (void)setDebugMode:(BOOL *)debugMode;
+- (void)setDebugMode:(BOOL)debugMode;
 
 
 
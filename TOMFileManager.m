@@ -8,1164 +8,8982 @@
 
 #import "TOMFileManager.h"
 
+#include <CommonCrypto/CommonDigest.h>
+#include <copyfile.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <os/lock.h>
+#include <regex.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <sys/clonefile.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#elif defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
 
 
 
-@implementation TOMFileManager
+
+
+/*
+ * TOMFilenameIndex
+ *    A persistent name -> directory index over the sandbox roots, used by findAndGetPathForFileNamed: when enabled.
+ *    Every indexed directory remembers its own mtime, the names of the files it holds and the names of its subdirectories,
+ *    so a directory that changed behind our back can be rescanned on its own instead of re-walking the whole tree.
+ */
+@interface TOMFilenameIndex : NSObject
+
+// The manager whose log level this logs at
+@property (weak, nonatomic) TOMFileManager *manager;
+
+- (id)initWithRootPaths:(NSArray *)rootPaths storePath:(NSString *)storePath;
+- (BOOL)load;
+- (void)rebuild;
+- (BOOL)save;
+- (NSString *)pathForFileNamed:(NSString *)filename;
+- (NSDictionary *)pathsForFileNames:(NSArray *)filenames;
+- (void)noteChangeAtPath:(NSString *)path;
+- (void)noteChangeInDirectoryAtPath:(NSString *)directoryPath;
+
+@end
+
+
+
+
+
+// The chunk size used when a caller of readFileAtPath:chunkSize:usingBlock: doesn't pick one
+static const size_t TOMDefaultChunkSize = 1024 * 1024;
+
+// How much of a file to ask the kernel to read ahead of the first access
+static const size_t TOMReadAheadLength = 4 * 1024 * 1024;
+
+// How many asynchronous operations a manager runs at once until told otherwise
+static const NSInteger TOMDefaultMaximumConcurrentOperations = 4;
+
+// How many files a directory copy keeps in flight at once
+static const long TOMCopyWorkerCount = 8;
+
+// How many paths the metadata cache remembers before it starts dropping entries
+static const NSUInteger TOMMetadataCacheCapacity = 4096;
+
+// How many directories the directory size cache remembers before it starts over
+static const NSUInteger TOMDirectorySizeCacheCapacity = 16384;
+
+// How long a directory watch gathers changes after the first one, before handing them over together
+static const NSTimeInterval TOMWatchCoalescingInterval = 0.1;
+
+// How many directories one watch holds a descriptor for at most
+static const NSUInteger TOMWatchMaximumDirectoryCount = 1024;
+
+// How much of the start and of the end of a file the duplicate finder hashes, before deciding to hash all of it
+static const size_t TOMDuplicatePartialLength = 4096;
+
+// How much a buffered writer gathers before writing it out, unless told otherwise
+static const NSUInteger TOMBufferedWriterDefaultBufferSize = 64 * 1024;
+
+// How long appended data waits in a buffered writer at most, unless told otherwise
+static const NSTimeInterval TOMBufferedWriterDefaultFlushInterval = 1.0;
+
+
+static int64_t TOMModificationTimeOfStat(const struct stat *fileStat)
 {
-	BOOL debugMode;
+	return ((int64_t)fileStat->st_mtimespec.tv_sec * (int64_t)NSEC_PER_SEC) + (int64_t)fileStat->st_mtimespec.tv_nsec;
 }
 
 
 
 
-- (id)init
+
+/*
+ * TOMMetrics
+ *    Process wide counters behind the manager's metrics class methods. Every manager feeds the same counters, since they all
+ *    share the one file system. While metrics are disabled, recording anything costs a single relaxed atomic load.
+ */
+typedef NS_ENUM(NSInteger, TOMMetricsCounter)
 {
-	debugMode = false;
-	
-	
-	NSArray *paths = NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES);
-	_documentsDirectory = [paths objectAtIndex:0];
-	
-	
-	_resourcesDirectory = [[NSBundle mainBundle]resourcePath];
-	
-	
-	paths = NSSearchPathForDirectoriesInDomains(NSLibraryDirectory, NSUserDomainMask, YES);
-	_libraryDirectory = [paths objectAtIndex:0];
-	
-	
-	_tempDirectory = [[[NSFileManager defaultManager] temporaryDirectory] path];
-	
-	
-	return self;
-}
+	TOMMetricsCounterEntriesVisited = 0,
+	TOMMetricsCounterBytesRead,
+	TOMMetricsCounterBytesWritten,
+	TOMMetricsCounterOpenCalls,
+	TOMMetricsCounterStatCalls,
+	TOMMetricsCounterReadCalls,
+	TOMMetricsCounterWriteCalls,
+	TOMMetricsCounterMkdirCalls,
+	TOMMetricsCounterUnlinkCalls,
+	TOMMetricsCounterRenameCalls,
+	TOMMetricsCounterCloneCalls,
+	TOMMetricsCounterCopyfileCalls,
+	TOMMetricsCounterSyncCalls,
+	TOMMetricsCounterMmapCalls,
+	TOMMetricsCounterAccessCalls,
+	TOMMetricsCounterCount
+};
 
 
+static const char * const TOMMetricsCounterNames[TOMMetricsCounterCount] = {
+	"entriesVisited",
+	"bytesRead",
+	"bytesWritten",
+	"openCalls",
+	"statCalls",
+	"readCalls",
+	"writeCalls",
+	"mkdirCalls",
+	"unlinkCalls",
+	"renameCalls",
+	"cloneCalls",
+	"copyfileCalls",
+	"syncCalls",
+	"mmapCalls",
+	"accessCalls"
+};
 
 
-- (BOOL)createDirectoryAtPath:(nonnull NSString *)newDirectoryPath
+typedef NS_ENUM(NSInteger, TOMMetricsMethod)
 {
-	NSError *error;
-	
-	
-	if (![[NSFileManager defaultManager] fileExistsAtPath:newDirectoryPath])
-	{
-		if (debugMode)
-		{
-			NSLog(@"[TOMFileManager] INFO: Creating directory: '%@'.", newDirectoryPath);
-		}
-		
-		[[NSFileManager defaultManager] createDirectoryAtPath:newDirectoryPath withIntermediateDirectories:NO attributes:nil error:&error];
-		
-		if (error)
-		{
-			NSLog(@"[TOMFileManager] ERROR: Could not create directory: '%@'.", newDirectoryPath);
-			NSLog(@"   RESULTING ERROR: %@", error);
-			
-			return NO;
-		}
-		
-		return YES;
-	}
-	else
+	TOMMetricsMethodCreateDirectory = 0,
+	TOMMetricsMethodCopyDirectory,
+	TOMMetricsMethodSyncDirectory,
+	TOMMetricsMethodMoveDirectory,
+	TOMMetricsMethodRenameDirectory,
+	TOMMetricsMethodDeleteDirectory,
+	TOMMetricsMethodGetPathForFile,
+	TOMMetricsMethodFindAndGetPathForFile,
+	TOMMetricsMethodFindAndGetPathsForFiles,
+	TOMMetricsMethodEnumerateFiles,
+	TOMMetricsMethodCopyFile,
+	TOMMetricsMethodMoveFile,
+	TOMMetricsMethodDeleteFile,
+	TOMMetricsMethodPerformOperations,
+	TOMMetricsMethodFileExists,
+	TOMMetricsMethodNumberOfItems,
+	TOMMetricsMethodSizeOfDirectory,
+	TOMMetricsMethodRetrieveData,
+	TOMMetricsMethodRetrieveMappedData,
+	TOMMetricsMethodRetrieveDataInRange,
+	TOMMetricsMethodReadFile,
+	TOMMetricsMethodHashFile,
+	TOMMetricsMethodHashFiles,
+	TOMMetricsMethodFindDuplicates,
+	TOMMetricsMethodReplaceDuplicates,
+	TOMMetricsMethodWriteData,
+	TOMMetricsMethodWriteFiles,
+	TOMMetricsMethodOpenBufferedWriter,
+	TOMMetricsMethodCount
+};
+
+
+static const char * const TOMMetricsMethodNames[TOMMetricsMethodCount] = {
+	"createDirectoryAtPath:",
+	"copyDirectoryFrom:to:",
+	"syncDirectoryFrom:to:options:report:",
+	"moveDirectoryFrom:to:",
+	"renameDirectoryAtPath:to:",
+	"deleteDirectory:",
+	"getPathForFileNamed:inDirectory:",
+	"findAndGetPathForFileNamed:",
+	"findAndGetPathsForFileNames:",
+	"enumerateFilesMatchingPattern:inDirectory:",
+	"copyFileAtPath:to:",
+	"moveFileAtPath:to:",
+	"deleteFileAtPath:",
+	"performOperations:",
+	"fileExistsAtPath:",
+	"numberOfItemsInDirectoryAtPath:options:",
+	"sizeOfDirectoryAtPath:",
+	"retrieveDataForFileAtPath:",
+	"retrieveMappedDataForFileAtPath:",
+	"retrieveDataForFileAtPath:range:",
+	"readFileAtPath:chunkSize:usingBlock:",
+	"hashOfFileAtPath:algorithm:",
+	"hashesOfFilesAtPaths:algorithm:",
+	"findDuplicateFilesInDirectories:",
+	"replaceDuplicateFilesInGroups:withLinkType:",
+	"writeData:toFileAtPath:options:",
+	"writeDataForFiles:options:",
+	"bufferedWriterForFileAtPath:"
+};
+
+
+// Latencies are bucketed by powers of two nanoseconds - bucket i holds [2^i, 2^(i+1)), and the last one everything longer
+enum { TOMMetricsLatencyBucketCount = 40 };
+
+
+typedef struct TOMMethodMetrics
+{
+	atomic_ullong calls;
+	atomic_ullong totalNanoseconds;
+	atomic_ullong latencyBuckets[TOMMetricsLatencyBucketCount];
+} TOMMethodMetrics;
+
+
+static atomic_bool TOMMetricsEnabled;
+static atomic_ullong TOMMetricsCounters[TOMMetricsCounterCount];
+static TOMMethodMetrics TOMMetricsMethods[TOMMetricsMethodCount];
+
+
+
+
+static inline void TOMMetricsCount(TOMMetricsCounter counter, uint64_t amount)
+{
+	if (atomic_load_explicit(&TOMMetricsEnabled, memory_order_relaxed))
 	{
-		NSLog(@"[TOMFileManager] ERROR: Could not create directory: '%@'.", newDirectoryPath);
-		
-		if (debugMode)
-		{
-			NSLog(@"   MOST LIKELY REASON: Directory already exists.");
-		}
-		
-		return NO;
+		atomic_fetch_add_explicit(&TOMMetricsCounters[counter], amount, memory_order_relaxed);
 	}
-	
-	
-	return NO;
 }
 
 
 
 
-- (BOOL)createSubdirectoryNamed:(nonnull NSString *)subdirectoryName in:(nonnull NSString *)existingDirectoryPath
+typedef struct TOMMetricsScope
 {
-	NSString *correctedSubdirectoryName;
+	TOMMetricsMethod method;
+	uint64_t startTime;
+} TOMMetricsScope;
+
+
+static inline TOMMetricsScope TOMMetricsScopeBegin(TOMMetricsMethod method)
+{
+	TOMMetricsScope scope = { method, 0 };
 	
 	
-	correctedSubdirectoryName = subdirectoryName;
-	if ([correctedSubdirectoryName hasPrefix:@"/"])
+	if (atomic_load_explicit(&TOMMetricsEnabled, memory_order_relaxed))
 	{
-		correctedSubdirectoryName = [correctedSubdirectoryName substringFromIndex:1];
+		scope.startTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
 	}
 	
+	return scope;
+}
+
+
+static inline void TOMMetricsScopeEnd(TOMMetricsScope *scope)
+{
+	if (scope->startTime == 0)
+	{
+		return;
+	}
 	
-	NSString *newDirectoryPath = [existingDirectoryPath stringByAppendingPathComponent:correctedSubdirectoryName];
 	
+	uint64_t nanoseconds = clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - scope->startTime;
+	int bucket = (nanoseconds == 0) ? 0 : MIN(63 - __builtin_clzll(nanoseconds), TOMMetricsLatencyBucketCount - 1);
+	TOMMethodMetrics *metrics = &TOMMetricsMethods[scope->method];
 	
-	return [self createDirectoryAtPath:newDirectoryPath];
+	atomic_fetch_add_explicit(&metrics->calls, 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&metrics->totalNanoseconds, nanoseconds, memory_order_relaxed);
+	atomic_fetch_add_explicit(&metrics->latencyBuckets[bucket], 1, memory_order_relaxed);
 }
 
 
+/*
+ * Times the rest of the enclosing method, however it returns.
+ */
+#define TOMMetricsMeasure(method) TOMMetricsScope TOMMetricsMethodScope __attribute__((cleanup(TOMMetricsScopeEnd), unused)) = TOMMetricsScopeBegin(method)
 
 
-- (BOOL)copyDirectoryFrom:(nonnull NSString *)sourceDirectoryPath to:(nonnull NSString *)destinationDirectoryPath
+
+
+
+/*
+ * TOMLog
+ *    Messages are formatted on the calling thread, then pushed onto a fixed size lock-free ring and handed to the log
+ *    handler on a background queue, so a method that logs never waits on NSLog. Whoever fills a slot schedules a drain
+ *    unless one is already pending, and a full ring drops messages (and says how many) rather than block the caller.
+ */
+typedef struct TOMLogSlot
 {
-	return [self copyDirectoryFrom:sourceDirectoryPath to:destinationDirectoryPath regardlessOfType:NO];
-}
+	atomic_size_t sequence;
+	TOMLogLevel level;
+	void *message;
+} TOMLogSlot;
 
 
+enum { TOMLogCapacity = 1024 };
 
 
-- (BOOL)copyDirectoryFrom:(nonnull NSString *)sourceDirectoryPath to:(nonnull NSString *)destinationDirectoryPath regardlessOfType:(BOOL)ignoreType
+static TOMLogSlot TOMLogSlots[TOMLogCapacity];
+static atomic_size_t TOMLogWritePosition;
+static size_t TOMLogReadPosition;
+static atomic_bool TOMLogDrainScheduled;
+static atomic_ulong TOMLogDroppedCount;
+static dispatch_queue_t TOMLogQueue;
+static void (^TOMLogHandler)(TOMLogLevel level, NSString *message);
+
+
+
+
+static void TOMLogDeliver(TOMLogLevel level, NSString *message)
 {
-	NSError *error;
-	BOOL sourceIsDirectory = false;
+	if (TOMLogHandler != nil)
+	{
+		TOMLogHandler(level, message);
+	}
+	else
+	{
+		NSLog(@"%@", message);
+	}
+}
+
+
+/*
+ * Only ever runs on TOMLogQueue.
+ */
+static void TOMLogDrain(void *context)
+{
+	// Cleared before reading, so a message published from here on schedules another drain instead of being missed
+	atomic_store(&TOMLogDrainScheduled, false);
 	
 	
-	if ([[NSFileManager defaultManager] fileExistsAtPath:sourceDirectoryPath isDirectory:&sourceIsDirectory])
+	while (YES)
 	{
-		if (sourceIsDirectory)
+		TOMLogSlot *slot = &TOMLogSlots[TOMLogReadPosition % TOMLogCapacity];
+		
+		if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != TOMLogReadPosition + 1)
 		{
-			if (debugMode)
-			{
-				NSLog(@"[TOMFileManager] INFO: Copying contents of directory: '%@'.\nTo directory: '%@'.", sourceDirectoryPath, destinationDirectoryPath);
-			}
-			
-			[[NSFileManager defaultManager] copyItemAtPath:sourceDirectoryPath toPath:destinationDirectoryPath error:&error];
-			
-			if (error)
-			{
-				NSLog(@"[TOMFileManager] ERROR: Could not copy directory: '%@'.", sourceDirectoryPath);
-				NSLog(@"   RESULTING ERROR: %@", error);
-				
-				return NO;
-			}
-			
-			return YES;
+			break;
 		}
-		else
+		
+		TOMLogLevel level = slot->level;
+		NSString *message = CFBridgingRelease(slot->message);
+		
+		slot->message = NULL;
+		atomic_store_explicit(&slot->sequence, TOMLogReadPosition + TOMLogCapacity, memory_order_release);
+		TOMLogReadPosition++;
+		
+		@autoreleasepool
 		{
-			if (ignoreType)
-			{
-				if (debugMode)
-				{
-					NSLog(@"[TOMFileManager] INFO: Copying contents of directory: '%@'.\nTo directory: '%@'.", sourceDirectoryPath, destinationDirectoryPath);
-				}
-				
-				[[NSFileManager defaultManager] copyItemAtPath:sourceDirectoryPath toPath:destinationDirectoryPath error:&error];
-				
-				if (error)
-				{
-					NSLog(@"[TOMFileManager] ERROR: Could not copy directory: '%@'.", sourceDirectoryPath);
-					NSLog(@"   RESULTING ERROR: %@", error);
-					
-					return NO;
-				}
-				
-				return YES;
-			}
-			else
-			{
-				NSLog(@"[TOMFileManager] ERROR: Could not copy directory: '%@'.", sourceDirectoryPath);
-				
-				if (debugMode)
-				{
-					NSLog(@"   MOST LIKELY REASON: Source is not a directory.");
-				}
-				
-				return NO;
-			}
+			TOMLogDeliver(level, message);
 		}
 	}
-	else
+	
+	
+	unsigned long droppedCount = atomic_exchange(&TOMLogDroppedCount, 0);
+	
+	if (droppedCount > 0)
 	{
-		NSLog(@"[TOMFileManager] ERROR: Could not copy directory: '%@'.", sourceDirectoryPath);
-		
-		if (debugMode)
-		{
-			NSLog(@"   MOST LIKELY REASON: Directory does not exist.");
-		}
-		
-		return NO;
+		TOMLogDeliver(TOMLogLevelError, [NSString stringWithFormat:@"[TOMFileManager] ERROR: Dropped %lu log messages.", droppedCount]);
 	}
 }
 
 
-
-
-- (BOOL)moveDirectoryFrom:(nonnull NSString *)sourceDirectoryPath to:(nonnull NSString *)destinationDirectoryPath
+static void TOMLogStart(void)
 {
-	return [self moveDirectoryFrom:sourceDirectoryPath to:destinationDirectoryPath regardlessOfType:NO];
+	static dispatch_once_t onceToken;
+	
+	dispatch_once(&onceToken, ^{
+		for (size_t slotIndex = 0; slotIndex < TOMLogCapacity; slotIndex++)
+		{
+			atomic_init(&TOMLogSlots[slotIndex].sequence, slotIndex);
+		}
+		
+		TOMLogQueue = dispatch_queue_create("TOMFileManager.log", dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0));
+	});
 }
 
 
-
-
-- (BOOL)moveDirectoryFrom:(nonnull NSString *)sourceDirectoryPath to:(nonnull NSString *)destinationDirectoryPath regardlessOfType:(BOOL)ignoreType
+static void TOMLogWrite(TOMLogLevel level, NSString *message)
 {
-	NSError *error;
-	BOOL sourceIsDirectory = false;
+	TOMLogStart();
 	
 	
-	if ([[NSFileManager defaultManager] fileExistsAtPath:sourceDirectoryPath isDirectory:&sourceIsDirectory])
+	size_t position = atomic_load_explicit(&TOMLogWritePosition, memory_order_relaxed);
+	
+	while (YES)
 	{
-		if (sourceIsDirectory)
+		TOMLogSlot *slot = &TOMLogSlots[position % TOMLogCapacity];
+		intptr_t lag = (intptr_t)atomic_load_explicit(&slot->sequence, memory_order_acquire) - (intptr_t)position;
+		
+		if (lag == 0)
 		{
-			if (debugMode)
-			{
-				NSLog(@"[TOMFileManager] INFO: Moving contents of directory: '%@'.\nTo directory: '%@'.", sourceDirectoryPath, destinationDirectoryPath);
-			}
-			
-			[[NSFileManager defaultManager] moveItemAtPath:sourceDirectoryPath toPath:destinationDirectoryPath error:&error];
-			
-			if (error)
+			// Claim the slot - a failed exchange reloads `position` with whatever another writer claimed
+			if (atomic_compare_exchange_weak_explicit(&TOMLogWritePosition, &position, position + 1, memory_order_relaxed, memory_order_relaxed))
 			{
-				NSLog(@"[TOMFileManager] ERROR: Could not move directory: '%@'.", sourceDirectoryPath);
-				NSLog(@"   RESULTING ERROR: %@", error);
+				slot->level = level;
+				slot->message = (void *)CFBridgingRetain(message);
+				atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
 				
-				return NO;
+				break;
 			}
-			
-			return YES;
+		}
+		else if (lag < 0)
+		{
+			// The ring is full - the slot still holds a message from one lap ago
+			atomic_fetch_add_explicit(&TOMLogDroppedCount, 1, memory_order_relaxed);
+			return;
 		}
 		else
 		{
-			if (ignoreType)
-			{
-				if (debugMode)
-				{
-					NSLog(@"[TOMFileManager] INFO: Moving contents of directory: '%@'.\nTo directory: '%@'.", sourceDirectoryPath, destinationDirectoryPath);
-				}
-				
-				[[NSFileManager defaultManager] moveItemAtPath:sourceDirectoryPath toPath:destinationDirectoryPath error:&error];
-				
-				if (error)
-				{
-					NSLog(@"[TOMFileManager] ERROR: Could not move directory: '%@'.", sourceDirectoryPath);
-					NSLog(@"   RESULTING ERROR: %@", error);
-					
-					return NO;
-				}
-				
-				return YES;
-			}
-			else
-			{
-				NSLog(@"[TOMFileManager] ERROR: Could not move directory: '%@'.", sourceDirectoryPath);
-				
-				if (debugMode)
-				{
-					NSLog(@"   MOST LIKELY REASON: Source is not a directory.");
-				}
-				
-				return NO;
-			}
+			position = atomic_load_explicit(&TOMLogWritePosition, memory_order_relaxed);
 		}
 	}
-	else
+	
+	
+	if (!atomic_exchange(&TOMLogDrainScheduled, true))
 	{
-		NSLog(@"[TOMFileManager] ERROR: Could not move directory: '%@'.", sourceDirectoryPath);
-		
-		if (debugMode)
-		{
-			NSLog(@"   MOST LIKELY REASON: Directory does not exist.");
-		}
-		
-		return NO;
+		dispatch_async_f(TOMLogQueue, NULL, TOMLogDrain);
 	}
 }
 
 
+// Messages above this level are compiled out - build with TOM_MAXIMUM_LOG_LEVEL=1 to keep nothing but errors
+#ifndef TOM_MAXIMUM_LOG_LEVEL
+#define TOM_MAXIMUM_LOG_LEVEL TOMLogLevelDebug
+#endif
 
 
-- (BOOL)renameDirectoryAtPath:(nonnull NSString *)directoryPath to:(nonnull NSString *)newName
+/*
+ * Nothing is formatted unless the level is enabled, and errno comes out the same as it went in. Only usable inside
+ * TOMFileManager's methods, since the runtime level is the manager's own.
+ */
+#define TOMLogEnabled(level) ((level) <= TOM_MAXIMUM_LOG_LEVEL && (level) <= _logLevel)
+#define TOMLog(level, format, ...) do { int TOMLogSavedErrno = errno; if (TOMLogEnabled(level)) { TOMLogWrite((level), [[NSString alloc] initWithFormat:(format), ##__VA_ARGS__]); } errno = TOMLogSavedErrno; } while (0)
+#define TOMLogError(format, ...) TOMLog(TOMLogLevelError, format, ##__VA_ARGS__)
+#define TOMLogInfo(format, ...) TOMLog(TOMLogLevelInfo, format, ##__VA_ARGS__)
+#define TOMLogDebug(format, ...) TOMLog(TOMLogLevelDebug, format, ##__VA_ARGS__)
+
+
+/*
+ * The same, for the objects a manager hands work to, which log at their manager's level. Once the manager is gone,
+ * they log nothing.
+ */
+#define TOMLogForManager(manager, level, format, ...) do { int TOMLogSavedErrno = errno; if ((level) <= TOM_MAXIMUM_LOG_LEVEL && (level) <= [(manager) logLevel]) { TOMLogWrite((level), [[NSString alloc] initWithFormat:(format), ##__VA_ARGS__]); } errno = TOMLogSavedErrno; } while (0)
+
+
+
+
+
+/*
+ * TOMWalkDirectory
+ *    A readdir based walk that hands the visitor each entry's path and name as raw bytes, along with the entry type from
+ *    the directory entry itself. Entries are only stat'd when the file system doesn't report a type, and no objects are
+ *    allocated per entry - the path lives in one buffer that is reused for the whole walk.
+ */
+typedef struct TOMWalkEntry
 {
-	return [self renameDirectoryAtPath:directoryPath to:newName regardlessOfType:NO];
-}
+	const char *path;
+	size_t pathLength;
+	const char *name;
+	size_t nameLength;
+	unsigned char type;
+	size_t depth;
+} TOMWalkEntry;
 
 
+typedef NS_ENUM(NSInteger, TOMWalkAction)
+{
+	TOMWalkActionContinue,
+	TOMWalkActionSkipDescendants,
+	TOMWalkActionStop
+};
 
 
-- (BOOL)renameDirectoryAtPath:(nonnull NSString *)directoryPath to:(nonnull NSString *)newName regardlessOfType:(BOOL)ignoreType
+typedef TOMWalkAction (^TOMWalkVisitor)(const TOMWalkEntry *entry);
+
+
+static BOOL TOMWalkDirectoryDescriptor(int directoryDescriptor, char *pathBuffer, size_t pathLength, size_t depth, BOOL recursive, TOMWalkVisitor visitor)
 {
-	NSError *error;
-	BOOL sourceIsDirectory = false;
-	
-	NSString *pathOfNewName;
+	DIR *directory = fdopendir(directoryDescriptor);
+	struct dirent *directoryEntry;
+	TOMWalkEntry walkEntry;
+	BOOL finished = YES;
 	
 	
-	
-	if (![newName hasPrefix:@"/"])
-	{
-		pathOfNewName = [[directoryPath stringByDeletingLastPathComponent] stringByAppendingPathComponent:newName];
-	}
-	else
+	if (directory == NULL)
 	{
-		pathOfNewName = [[directoryPath stringByDeletingLastPathComponent] stringByAppendingString:newName];
+		close(directoryDescriptor);
+		return YES;
 	}
 	
 	
-	if ([[NSFileManager defaultManager] fileExistsAtPath:pathOfNewName isDirectory:&sourceIsDirectory])
+	while ((directoryEntry = readdir(directory)) != NULL)
 	{
-		if (sourceIsDirectory)
+		const char *name = directoryEntry->d_name;
+		size_t nameLength = directoryEntry->d_namlen;
+		
+		if (name[0] == '.' && (nameLength == 1 || (nameLength == 2 && name[1] == '.')))
 		{
-			if (debugMode)
-			{
-				NSLog(@"[TOMFileManager] INFO: Renaming directory: '%@'.\nTo: '%@'.", directoryPath, pathOfNewName);
-			}
+			continue;
+		}
+		
+		TOMMetricsCount(TOMMetricsCounterEntriesVisited, 1);
+		
+		if (pathLength + 1 + nameLength >= PATH_MAX)
+		{
+			continue;
+		}
+		
+		
+		pathBuffer[pathLength] = '/';
+		memcpy(pathBuffer + pathLength + 1, name, nameLength + 1);
+		
+		walkEntry.path = pathBuffer;
+		walkEntry.pathLength = pathLength + 1 + nameLength;
+		walkEntry.name = pathBuffer + pathLength + 1;
+		walkEntry.nameLength = nameLength;
+		walkEntry.type = directoryEntry->d_type;
+		walkEntry.depth = depth;
+		
+		if (walkEntry.type == DT_UNKNOWN)
+		{
+			struct stat entryStat;
 			
-			[self createDirectoryAtPath:pathOfNewName];
-			[self moveDirectoryFrom:directoryPath to:pathOfNewName];
+			TOMMetricsCount(TOMMetricsCounterStatCalls, 1);
 			
-			if (error)
+			if (fstatat(dirfd(directory), name, &entryStat, AT_SYMLINK_NOFOLLOW) == 0)
 			{
-				NSLog(@"[TOMFileManager] ERROR: Could not rename directory: '%@'.", directoryPath);
-				NSLog(@"   RESULTING ERROR: %@", error);
-				
-				return NO;
+				walkEntry.type = IFTODT(entryStat.st_mode);
 			}
-			
-			return YES;
 		}
-		else
+		
+		
+		TOMWalkAction action = visitor(&walkEntry);
+		
+		if (action == TOMWalkActionStop)
 		{
-			if (ignoreType)
-			{
-				if (debugMode)
-				{
-					NSLog(@"[TOMFileManager] INFO: Renaming directory: '%@'.\nTo: '%@'.", directoryPath, pathOfNewName);
-				}
-				
-				[self createDirectoryAtPath:pathOfNewName];
-				[self moveDirectoryFrom:directoryPath to:pathOfNewName];
-				
-				if (error)
-				{
-					NSLog(@"[TOMFileManager] ERROR: Could not rename directory: '%@'.", directoryPath);
-					NSLog(@"   RESULTING ERROR: %@", error);
-					
-					return NO;
-				}
-				
-				return YES;
-			}
-			else
+			finished = NO;
+			break;
+		}
+		
+		if (recursive && walkEntry.type == DT_DIR && action != TOMWalkActionSkipDescendants)
+		{
+			TOMMetricsCount(TOMMetricsCounterOpenCalls, 1);
+			int subdirectoryDescriptor = openat(dirfd(directory), name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+			
+			if (subdirectoryDescriptor >= 0 && !TOMWalkDirectoryDescriptor(subdirectoryDescriptor, pathBuffer, walkEntry.pathLength, depth + 1, recursive, visitor))
 			{
-				NSLog(@"[TOMFileManager] ERROR: Could not rename directory: '%@'.", directoryPath);
-				
-				if (debugMode)
-				{
-					NSLog(@"   MOST LIKELY REASON: Source is not a directory.");
-				}
-				
-				return NO;
+				finished = NO;
+				break;
 			}
 		}
 	}
-	else
+	
+	
+	pathBuffer[pathLength] = '\0';
+	closedir(directory);
+	
+	return finished;
+}
+
+
+/*
+ * Returns NO if the visitor stopped the walk, and YES once every entry has been visited.
+ */
+static BOOL TOMWalkDirectory(const char *directoryPath, BOOL recursive, TOMWalkVisitor visitor)
+{
+	char pathBuffer[PATH_MAX];
+	size_t pathLength = strlen(directoryPath);
+	
+	
+	if (pathLength >= PATH_MAX)
+	{
+		return YES;
+	}
+	
+	memcpy(pathBuffer, directoryPath, pathLength + 1);
+	
+	while (pathLength > 1 && pathBuffer[pathLength - 1] == '/')
+	{
+		pathBuffer[--pathLength] = '\0';
+	}
+	
+	
+	TOMMetricsCount(TOMMetricsCounterOpenCalls, 1);
+	int directoryDescriptor = open(pathBuffer, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	
+	if (directoryDescriptor < 0)
+	{
+		return YES;
+	}
+	
+	return TOMWalkDirectoryDescriptor(directoryDescriptor, pathBuffer, (pathLength == 1) ? 0 : pathLength, 0, recursive, visitor);
+}
+
+
+// The hidden directory in Library/Caches that deleteDirectory:mode: moves directories into until they can be purged
+static const char TOMPurgeDirectoryName[] = ".TOMPurge";
+
+
+/*
+ * Whether `entry` is a purge directory. Nothing in one is still meant to exist, so searches never look inside.
+ */
+static BOOL TOMWalkEntryIsPurgeDirectory(const TOMWalkEntry *entry)
+{
+	return entry->type == DT_DIR && entry->nameLength == sizeof(TOMPurgeDirectoryName) - 1 && memcmp(entry->name, TOMPurgeDirectoryName, sizeof(TOMPurgeDirectoryName) - 1) == 0;
+}
+
+
+/*
+ * Whether numberOfItemsInDirectoryAtPath:options: counts `entry`. With no type options set, every type is counted.
+ */
+static BOOL TOMWalkEntryMatchesCountOptions(const TOMWalkEntry *entry, TOMCountOptions options)
+{
+	TOMCountOptions typeOptions = options & (TOMCountOptionsFiles | TOMCountOptionsDirectories | TOMCountOptionsSymbolicLinks);
+	
+	
+	switch (entry->type)
 	{
-		NSLog(@"[TOMFileManager] ERROR: Could not rename directory: '%@'.", directoryPath);
+		case DT_REG:
+			return typeOptions == 0 || (typeOptions & TOMCountOptionsFiles);
 		
-		if (debugMode)
-		{
-			NSLog(@"   MOST LIKELY REASON: Directory does not exist.");
-		}
+		case DT_DIR:
+			return typeOptions == 0 || (typeOptions & TOMCountOptionsDirectories);
 		
-		return NO;
+		case DT_LNK:
+			return typeOptions == 0 || (typeOptions & TOMCountOptionsSymbolicLinks);
+		
+		default:
+			return typeOptions == 0;
 	}
 }
 
 
 
 
-- (BOOL)deleteDirectory:(nonnull NSString *)directoryPath
+
+/*
+ * TOMFilenameMatcher
+ *    Compares a walk entry's name bytes against a file name without allocating. The name is kept as UTF-8 in both its
+ *    decomposed and precomposed forms, since either can end up on disk. A file name with more than one path component
+ *    also has to match the end of the entry's path, in the same form as the name. An empty name, or one with no UTF-8
+ *    form, matches nothing.
+ */
+typedef struct TOMFilenameMatcher
 {
-	return [self deleteDirectory:directoryPath regardlessOfType:NO];
-}
+	const char *names[2];
+	size_t nameLengths[2];
+	const char *pathSuffixes[2];
+	size_t pathSuffixLengths[2];
+	NSUInteger nameCount;
+} TOMFilenameMatcher;
 
 
+/*
+ * The UTF-8 bytes of `string`, or nil if it has none.
+ */
+static NSData *TOMFilenameMatcherBytes(NSString *string)
+{
+	const char *bytes = [string UTF8String];
+	
+	return (bytes == NULL) ? nil : [NSData dataWithBytes:bytes length:strlen(bytes)];
+}
 
 
-- (BOOL)deleteDirectory:(nonnull NSString *)directoryPath regardlessOfType:(BOOL)ignoreType
+static TOMFilenameMatcher TOMFilenameMatcherMake(NSString *filename, NSMutableArray *storage)
 {
-	NSError *error;
-	BOOL sourceIsDirectory = false;
+	TOMFilenameMatcher matcher;
+	BOOL hasPathSuffix = ([filename rangeOfString:@"/"].location != NSNotFound);
+	NSString *suffix = [filename hasPrefix:@"/"] ? filename : [@"/" stringByAppendingString:filename];
+	NSArray *filenameForms = @[[filename decomposedStringWithCanonicalMapping], [filename precomposedStringWithCanonicalMapping]];
+	NSArray *suffixForms = @[[suffix decomposedStringWithCanonicalMapping], [suffix precomposedStringWithCanonicalMapping]];
 	
 	
-	if ([[NSFileManager defaultManager] fileExistsAtPath:directoryPath isDirectory:&sourceIsDirectory])
+	memset(&matcher, 0, sizeof(matcher));
+	
+	if ([[filename lastPathComponent] length] == 0)
 	{
-		if (sourceIsDirectory)
+		return matcher;
+	}
+	
+	for (NSUInteger formIndex = 0; formIndex < [filenameForms count]; formIndex++)
+	{
+		NSData *nameForm = TOMFilenameMatcherBytes([[filenameForms objectAtIndex:formIndex] lastPathComponent]);
+		NSData *suffixForm = hasPathSuffix ? TOMFilenameMatcherBytes([suffixForms objectAtIndex:formIndex]) : [NSData data];
+		
+		if (nameForm == nil || suffixForm == nil)
 		{
-			if (debugMode)
-			{
-				NSLog(@"[TOMFileManager] INFO: Deleting directory: '%@'.\n", directoryPath);
-			}
-			
-			[[NSFileManager defaultManager] removeItemAtPath:directoryPath error:&error];
-			
-			if (error)
-			{
-				NSLog(@"[TOMFileManager] ERROR: Could not delete directory: '%@'.", directoryPath);
-				NSLog(@"   RESULTING ERROR: %@", error);
-				
-				return NO;
-			}
-			
-			return YES;
+			// Nothing on disk can be named something that has no UTF-8 form
+			matcher.nameCount = 0;
+			return matcher;
 		}
-		else
+		
+		if (matcher.nameCount == 1 && [nameForm isEqualToData:[storage objectAtIndex:[storage count] - 2]] && [suffixForm isEqualToData:[storage lastObject]])
 		{
-			if (ignoreType)
-			{
-				if (debugMode)
-				{
-					NSLog(@"[TOMFileManager] INFO: Deleting directory: '%@'.\n", directoryPath);
-				}
-				
-				[[NSFileManager defaultManager] removeItemAtPath:directoryPath error:&error];
-				
-				if (error)
-				{
-					NSLog(@"[TOMFileManager] ERROR: Could not delete directory: '%@'.", directoryPath);
-					NSLog(@"   RESULTING ERROR: %@", error);
-					
-					return NO;
-				}
-				
-				return YES;
-			}
-			else
-			{
-				NSLog(@"[TOMFileManager] ERROR: Could not delete directory: '%@'.", directoryPath);
-				
-				if (debugMode)
-				{
-					NSLog(@"   MOST LIKELY REASON: It is not a directory.");
-				}
-				
-				return NO;
-			}
+			continue;
 		}
+		
+		[storage addObject:nameForm];
+		[storage addObject:suffixForm];
+		matcher.names[matcher.nameCount] = [nameForm bytes];
+		matcher.nameLengths[matcher.nameCount] = [nameForm length];
+		matcher.pathSuffixes[matcher.nameCount] = hasPathSuffix ? [suffixForm bytes] : NULL;
+		matcher.pathSuffixLengths[matcher.nameCount] = [suffixForm length];
+		matcher.nameCount++;
 	}
-	else
+	
+	
+	return matcher;
+}
+
+
+static BOOL TOMFilenameMatcherMatches(const TOMFilenameMatcher *matcher, const TOMWalkEntry *entry)
+{
+	for (NSUInteger nameIndex = 0; nameIndex < matcher->nameCount; nameIndex++)
 	{
-		NSLog(@"[TOMFileManager] ERROR: Could not move directory: '%@'.", directoryPath);
+		if (entry->nameLength != matcher->nameLengths[nameIndex] || memcmp(entry->name, matcher->names[nameIndex], entry->nameLength) != 0)
+		{
+			continue;
+		}
 		
-		if (debugMode)
+		if (matcher->pathSuffixes[nameIndex] == NULL)
 		{
-			NSLog(@"   MOST LIKELY REASON: Directory does not exist.");
+			return YES;
 		}
 		
-		return NO;
+		size_t suffixLength = matcher->pathSuffixLengths[nameIndex];
+		
+		if (entry->pathLength >= suffixLength && memcmp(entry->path + entry->pathLength - suffixLength, matcher->pathSuffixes[nameIndex], suffixLength) == 0)
+		{
+			return YES;
+		}
 	}
+	
+	
+	return NO;
 }
 
 
 
 
-- (NSString *)getPathForFileNamed:(NSString *)filename inDirectory:(NSString *)directoryPath
+
+/*
+ * TOMFilenameSet
+ *    A fixed-size, open addressing hash table of TOMFilenameMatchers keyed by their name bytes, for matching a walk entry
+ *    against many file names at once without allocating.
+ */
+typedef struct TOMFilenameSetSlot
+{
+	const char *name;
+	size_t nameLength;
+	NSUInteger matcherIndex;
+} TOMFilenameSetSlot;
+
+
+typedef struct TOMFilenameSet
+{
+	TOMFilenameMatcher *matchers;
+	NSUInteger matcherCount;
+	TOMFilenameSetSlot *slots;
+	size_t slotMask;
+} TOMFilenameSet;
+
+
+static uint64_t TOMHashBytes(const char *bytes, size_t length)
 {
-	BOOL fileFound = false;
-	NSURL *directoryURL = [NSURL fileURLWithPath:directoryPath ]; // URL pointing to the directory you want to browse
-	NSArray *keys = [NSArray arrayWithObject:NSURLIsDirectoryKey];
+	uint64_t hash = 14695981039346656037ULL;
 	
 	
-	BOOL isDirectory = false;
-	if ([[NSFileManager defaultManager] fileExistsAtPath:directoryPath isDirectory:&isDirectory])
-	{
-		if (!isDirectory)
-		{
-			NSLog(@"[TOMFileManager] ERROR: Search Location is not a directory.");
-			return nil;
-		}
-	}
-	else
+	for (size_t byteIndex = 0; byteIndex < length; byteIndex++)
 	{
-		NSLog(@"[TOMFileManager] ERROR: Search Location does not exist.");
-		return nil;
+		hash ^= (uint8_t)bytes[byteIndex];
+		hash *= 1099511628211ULL;
 	}
 	
 	
-	NSDirectoryEnumerator *enumerator = [[NSFileManager defaultManager]
-										 enumeratorAtURL:directoryURL
-										 includingPropertiesForKeys:keys
-										 options:0
-										 errorHandler:^(NSURL *url, NSError *error)
-										 {
-											 // Handle the error.
-											 // Return YES if the enumeration should continue after the error.
-											 return YES;
-										 }];
+	return hash;
+}
+
+
+static TOMFilenameSet TOMFilenameSetMake(NSArray *filenames, NSMutableArray *storage)
+{
+	TOMFilenameSet set;
+	size_t slotCount = 4;
 	
 	
-	if (debugMode)
+	// Every matcher can take two slots, and the table is kept at most half full
+	while (slotCount < [filenames count] * 4)
 	{
-		NSLog(@"[TOMFileManager] INFO: Retrieving file: '%@'.\nFrom directory: '%@'.", filename, directoryPath);
+		slotCount *= 2;
 	}
 	
+	set.matcherCount = [filenames count];
+	set.matchers = calloc(MAX(set.matcherCount, 1), sizeof(TOMFilenameMatcher));
+	set.slots = calloc(slotCount, sizeof(TOMFilenameSetSlot));
+	set.slotMask = slotCount - 1;
 	
-	for (NSURL *url in enumerator)
+	
+	for (NSUInteger matcherIndex = 0; matcherIndex < set.matcherCount; matcherIndex++)
 	{
-		NSError *error;
-		if (![url resourceValuesForKeys:keys error:&error])
+		TOMFilenameMatcher *matcher = &set.matchers[matcherIndex];
+		
+		*matcher = TOMFilenameMatcherMake([filenames objectAtIndex:matcherIndex], storage);
+		
+		for (NSUInteger nameIndex = 0; nameIndex < matcher->nameCount; nameIndex++)
 		{
-			if (!error)
-			{
-				if([[url absoluteString] hasSuffix:filename])
-				{
-					fileFound = true;
-					return url.path;
-				}
-			}
-			else
+			size_t slotIndex = TOMHashBytes(matcher->names[nameIndex], matcher->nameLengths[nameIndex]) & set.slotMask;
+			
+			while (set.slots[slotIndex].name != NULL)
 			{
-				NSLog(@"[TOMFileManager] ERROR: Could not check resource value for key.");
-				NSLog(@"   RESULTING ERROR: %@", [error localizedDescription]);
+				slotIndex = (slotIndex + 1) & set.slotMask;
 			}
+			
+			set.slots[slotIndex].name = matcher->names[nameIndex];
+			set.slots[slotIndex].nameLength = matcher->nameLengths[nameIndex];
+			set.slots[slotIndex].matcherIndex = matcherIndex;
 		}
 	}
 	
 	
-	if (!fileFound)
-	{
-		NSLog(@"ERROR: File Not Found In Directory");
-		return NULL;
-	}
-	else
-	{
-		NSLog(@"ERROR: File Found But Not Returned");
-		return NULL;
-	}
+	return set;
 }
 
 
+static void TOMFilenameSetFree(TOMFilenameSet *set)
+{
+	free(set->matchers);
+	free(set->slots);
+	
+	set->matchers = NULL;
+	set->slots = NULL;
+}
 
 
-- (NSString *)findAndGetPathForFileNamed:(NSString *)filename
+/*
+ * Returns the index of the next matcher that matches `entry`, or NSNotFound once there are no more. `probe` must start
+ * out as SIZE_MAX, and is passed back in unchanged to continue from the last match.
+ */
+static NSUInteger TOMFilenameSetNextMatch(const TOMFilenameSet *set, const TOMWalkEntry *entry, size_t *probe)
 {
-	BOOL fileFound = false;
-	NSURL *documentsDirectoryURL = [NSURL fileURLWithPath:[self documentsDirectory]];
-	NSURL *resourcesDirectoryURL = [NSURL fileURLWithPath:[self resourcesDirectory]];
-	NSURL *libraryDirectoryURL = [NSURL fileURLWithPath:[self libraryDirectory]];
-	NSURL *tempDirectoryURL = [NSURL fileURLWithPath:[self tempDirectory]];
-	NSArray *keys = [NSArray arrayWithObject:NSURLIsDirectoryKey];
-	
-	
-	NSDirectoryEnumerator *documentsEnumerator = [[NSFileManager defaultManager]
-												  enumeratorAtURL:documentsDirectoryURL
-												  includingPropertiesForKeys:keys
-												  options:0
-												  errorHandler:^(NSURL *url, NSError *error)
-												  {
-													  // Handle the error.
-													  // Return YES if the enumeration should continue after the error.
-													  return YES;
-												  }];
-	
-	NSDirectoryEnumerator *resourcesEnumerator = [[NSFileManager defaultManager]
-												  enumeratorAtURL:resourcesDirectoryURL
-												  includingPropertiesForKeys:keys
-												  options:0
-												  errorHandler:^(NSURL *url, NSError *error)
-												  {
-													  // Handle the error.
-													  // Return YES if the enumeration should continue after the error.
-													  return YES;
-												  }];
-	
-	NSDirectoryEnumerator *libraryEnumerator = [[NSFileManager defaultManager]
-												enumeratorAtURL:libraryDirectoryURL
-												includingPropertiesForKeys:keys
-												options:0
-												errorHandler:^(NSURL *url, NSError *error)
-												{
-													// Handle the error.
-													// Return YES if the enumeration should continue after the error.
-													return YES;
-												}];
-	
-	NSDirectoryEnumerator *tempEnumerator = [[NSFileManager defaultManager]
-											 enumeratorAtURL:tempDirectoryURL
-											 includingPropertiesForKeys:keys
-											 options:0
-											 errorHandler:^(NSURL *url, NSError *error)
-											 {
-												 // Handle the error.
-												 // Return YES if the enumeration should continue after the error.
-												 return YES;
-											 }];
-	
-	
-	if (debugMode)
-	{
-		NSLog(@"[TOMFileManager] INFO: Searching Documents Directory for file: '%@'.", filename);
-	}
-	
-	for (NSURL *url in documentsEnumerator)
-	{
-		NSError *error;
-		if (![url resourceValuesForKeys:keys error:&error])
-		{
-			if (!error)
-			{
-				if([[url absoluteString] hasSuffix:filename])
-				{
-					fileFound = true;
-					return url.path;
-				}
-			}
-			else
-			{
-				NSLog(@"[TOMFileManager] ERROR: Could not check resource value for key.");
-				NSLog(@"   RESULTING ERROR: %@", [error localizedDescription]);
-			}
-		}
-	}
-	
+	size_t slotIndex = (*probe == SIZE_MAX) ? (TOMHashBytes(entry->name, entry->nameLength) & set->slotMask) : ((*probe + 1) & set->slotMask);
 	
-	if (debugMode)
-	{
-		NSLog(@"[TOMFileManager] INFO: Searching Resources Directory for file: '%@'.", filename);
-	}
 	
-	for (NSURL *url in resourcesEnumerator)
+	while (set->slots[slotIndex].name != NULL)
 	{
-		NSError *error;
-		if (![url resourceValuesForKeys:keys error:&error])
+		const TOMFilenameSetSlot *slot = &set->slots[slotIndex];
+		
+		if (slot->nameLength == entry->nameLength && memcmp(slot->name, entry->name, entry->nameLength) == 0 && TOMFilenameMatcherMatches(&set->matchers[slot->matcherIndex], entry))
 		{
-			if (!error)
-			{
-				if([[url absoluteString] hasSuffix:filename])
-				{
-					fileFound = true;
-					return url.path;
-				}
-			}
-			else
-			{
-				NSLog(@"[TOMFileManager] ERROR: Could not check resource value for key.");
-				NSLog(@"   RESULTING ERROR: %@", [error localizedDescription]);
-			}
+			*probe = slotIndex;
+			return slot->matcherIndex;
 		}
+		
+		slotIndex = (slotIndex + 1) & set->slotMask;
 	}
 	
 	
-	if (debugMode)
-	{
-		NSLog(@"[TOMFileManager] INFO: Searching Library Directory for file: '%@'.", filename);
-	}
+	return NSNotFound;
+}
+
+
+
+
+
+/*
+ * TOMPatternMatcher
+ *    Matches a walk entry's name bytes against a shell wildcard or regular expression pattern. Like TOMFilenameMatcher,
+ *    the pattern is kept in both its decomposed and precomposed forms, since either can end up on disk, and a name matches
+ *    if either form does. The forms are taken as UTF-8, so any pattern can be matched, even one with no file system
+ *    representation.
+ */
+typedef struct TOMPatternMatcher
+{
+	char *patterns[2];
+	regex_t regularExpressions[2];
+	NSUInteger patternCount;
+	BOOL isRegularExpression;
+	BOOL caseInsensitive;
+} TOMPatternMatcher;
+
+
+/*
+ * Returns 0 on success, or the regcomp(3) error (REG_BADPAT for a pattern that isn't valid Unicode), with its
+ * description written into `errorDescription`. On failure there is nothing to free.
+ */
+static int TOMPatternMatcherMake(TOMPatternMatcher *matcher, NSString *pattern, BOOL isRegularExpression, BOOL caseInsensitive, char *errorDescription, size_t errorDescriptionSize)
+{
+	NSString *decomposedPattern = [pattern decomposedStringWithCanonicalMapping];
+	NSString *precomposedPattern = [pattern precomposedStringWithCanonicalMapping];
+	
 	
-	for (NSURL *url in libraryEnumerator)
+	memset(matcher, 0, sizeof(*matcher));
+	
+	// Lone surrogates have no UTF-8 form, and no name on disk could match them anyway
+	if ([decomposedPattern UTF8String] == NULL || [precomposedPattern UTF8String] == NULL)
 	{
-		NSError *error;
-		if (![url resourceValuesForKeys:keys error:&error])
-		{
-			if (!error)
-			{
-				if([[url absoluteString] hasSuffix:filename])
-				{
-					fileFound = true;
-					return url.path;
-				}
-			}
-			else
-			{
-				NSLog(@"[TOMFileManager] ERROR: Could not check resource value for key.");
-				NSLog(@"   RESULTING ERROR: %@", [error localizedDescription]);
-			}
-		}
+		strlcpy(errorDescription, "Pattern is not valid Unicode", errorDescriptionSize);
+		return REG_BADPAT;
 	}
 	
+	matcher->isRegularExpression = isRegularExpression;
+	matcher->caseInsensitive = caseInsensitive;
+	matcher->patterns[matcher->patternCount++] = strdup([decomposedPattern UTF8String]);
 	
-	if (debugMode)
+	if (![precomposedPattern isEqualToString:decomposedPattern])
 	{
-		NSLog(@"[TOMFileManager] INFO: Searching Temp Directory for file: '%@'.", filename);
+		matcher->patterns[matcher->patternCount++] = strdup([precomposedPattern UTF8String]);
 	}
 	
-	for (NSURL *url in tempEnumerator)
+	
+	for (NSUInteger patternIndex = 0; isRegularExpression && patternIndex < matcher->patternCount; patternIndex++)
 	{
-		NSError *error;
-		if (![url resourceValuesForKeys:keys error:&error])
+		int regularExpressionError = regcomp(&matcher->regularExpressions[patternIndex], matcher->patterns[patternIndex], REG_EXTENDED | REG_NOSUB | (caseInsensitive ? REG_ICASE : 0));
+		
+		if (regularExpressionError != 0)
 		{
-			if (!error)
+			regerror(regularExpressionError, &matcher->regularExpressions[patternIndex], errorDescription, errorDescriptionSize);
+			
+			for (NSUInteger compiledIndex = 0; compiledIndex < patternIndex; compiledIndex++)
 			{
-				if([[url absoluteString] hasSuffix:filename])
-				{
-					fileFound = true;
-					return url.path;
-				}
+				regfree(&matcher->regularExpressions[compiledIndex]);
 			}
-			else
+			
+			for (NSUInteger freedIndex = 0; freedIndex < matcher->patternCount; freedIndex++)
 			{
-				NSLog(@"[TOMFileManager] ERROR: Could not check resource value for key.");
-				NSLog(@"   RESULTING ERROR: %@", [error localizedDescription]);
+				free(matcher->patterns[freedIndex]);
 			}
+			
+			return regularExpressionError;
 		}
 	}
 	
 	
-	if (!fileFound)
-	{
-		NSLog(@"ERROR: File Not Found In Directory");
-		return NULL;
+	return 0;
+}
+
+
+static BOOL TOMPatternMatcherMatches(const TOMPatternMatcher *matcher, const TOMWalkEntry *entry)
+{
+	for (NSUInteger patternIndex = 0; patternIndex < matcher->patternCount; patternIndex++)
+	{
+		if (matcher->isRegularExpression)
+		{
+			if (regexec(&matcher->regularExpressions[patternIndex], entry->name, 0, NULL, 0) == 0)
+			{
+				return YES;
+			}
+		}
+		else if (fnmatch(matcher->patterns[patternIndex], entry->name, matcher->caseInsensitive ? FNM_CASEFOLD : 0) == 0)
+		{
+			return YES;
+		}
+	}
+	
+	
+	return NO;
+}
+
+
+static void TOMPatternMatcherFree(TOMPatternMatcher *matcher)
+{
+	for (NSUInteger patternIndex = 0; patternIndex < matcher->patternCount; patternIndex++)
+	{
+		if (matcher->isRegularExpression)
+		{
+			regfree(&matcher->regularExpressions[patternIndex]);
+		}
+		
+		free(matcher->patterns[patternIndex]);
+	}
+	
+	matcher->patternCount = 0;
+}
+
+
+
+
+
+
+static NSString * const TOMFilenameIndexVersionKey = @"Version";
+static NSString * const TOMFilenameIndexRootsKey = @"Roots";
+static NSString * const TOMFilenameIndexDirectoriesKey = @"Directories";
+static NSString * const TOMFilenameIndexModificationTimeKey = @"ModificationTime";
+static NSString * const TOMFilenameIndexFilesKey = @"Files";
+static NSString * const TOMFilenameIndexSubdirectoriesKey = @"Subdirectories";
+static const NSInteger TOMFilenameIndexVersion = 1;
+
+
+
+
+
+@implementation TOMFilenameIndex
+{
+	NSArray *roots;
+	NSString *storePath;
+	
+	// Directory path -> { ModificationTime, Files, Subdirectories }
+	NSMutableDictionary *directories;
+	
+	// Precomposed file name -> directory paths containing a file with that name, in whichever form it has on disk
+	NSMutableDictionary *names;
+	
+	dispatch_queue_t queue;
+	BOOL dirty;
+	BOOL saveScheduled;
+}
+
+
+
+
+- (id)initWithRootPaths:(NSArray *)rootPaths storePath:(NSString *)path
+{
+	self = [super init];
+	
+	if (self)
+	{
+		NSMutableArray *standardizedRoots = [[NSMutableArray alloc] initWithCapacity:[rootPaths count]];
+		
+		for (NSString *rootPath in rootPaths)
+		{
+			[standardizedRoots addObject:[rootPath stringByStandardizingPath]];
+		}
+		
+		roots = standardizedRoots;
+		storePath = [path copy];
+		directories = [[NSMutableDictionary alloc] init];
+		names = [[NSMutableDictionary alloc] init];
+		queue = dispatch_queue_create("TOMFileManager.FilenameIndex", DISPATCH_QUEUE_SERIAL);
+	}
+	
+	return self;
+}
+
+
+
+
+- (BOOL)load
+{
+	NSDictionary *store = [NSDictionary dictionaryWithContentsOfFile:storePath];
+	
+	
+	if ([[store objectForKey:TOMFilenameIndexVersionKey] integerValue] != TOMFilenameIndexVersion)
+	{
+		return NO;
+	}
+	
+	// The sandbox container moves between installs, which invalidates every stored path
+	if (![[store objectForKey:TOMFilenameIndexRootsKey] isEqualToArray:roots])
+	{
+		return NO;
+	}
+	
+	
+	dispatch_sync(queue, ^{
+		[self->directories removeAllObjects];
+		[self->names removeAllObjects];
+		
+		NSDictionary *storedDirectories = [store objectForKey:TOMFilenameIndexDirectoriesKey];
+		
+		for (NSString *directoryPath in storedDirectories)
+		{
+			NSDictionary *storedRecord = [storedDirectories objectForKey:directoryPath];
+			NSMutableDictionary *record = [NSMutableDictionary dictionaryWithCapacity:3];
+			
+			[record setObject:[storedRecord objectForKey:TOMFilenameIndexModificationTimeKey] forKey:TOMFilenameIndexModificationTimeKey];
+			[record setObject:[[storedRecord objectForKey:TOMFilenameIndexFilesKey] mutableCopy] forKey:TOMFilenameIndexFilesKey];
+			[record setObject:[[storedRecord objectForKey:TOMFilenameIndexSubdirectoriesKey] mutableCopy] forKey:TOMFilenameIndexSubdirectoriesKey];
+			[self->directories setObject:record forKey:directoryPath];
+			
+			for (NSString *filename in [record objectForKey:TOMFilenameIndexFilesKey])
+			{
+				[self addName:filename inDirectory:directoryPath];
+			}
+		}
+	});
+	
+	
+	return YES;
+}
+
+
+
+
+- (void)rebuild
+{
+	dispatch_sync(queue, ^{
+		[self->directories removeAllObjects];
+		[self->names removeAllObjects];
+		
+		for (NSString *rootPath in self->roots)
+		{
+			[self scanDirectoryAtPath:rootPath];
+		}
+		
+		self->dirty = YES;
+	});
+	
+	
+	[self save];
+}
+
+
+
+
+- (BOOL)save
+{
+	__block NSData *storeData = nil;
+	
+	
+	// Serialize on the queue, since the records are mutated in place - only the write itself happens off of it
+	dispatch_sync(queue, ^{
+		if (self->dirty)
+		{
+			NSDictionary *store = @{TOMFilenameIndexVersionKey : @(TOMFilenameIndexVersion),
+									TOMFilenameIndexRootsKey : self->roots,
+									TOMFilenameIndexDirectoriesKey : self->directories};
+			
+			storeData = [NSPropertyListSerialization dataWithPropertyList:store format:NSPropertyListBinaryFormat_v1_0 options:0 error:nil];
+			self->dirty = NO;
+		}
+	});
+	
+	
+	if (storeData == nil)
+	{
+		return YES;
+	}
+	
+	
+	[[NSFileManager defaultManager] createDirectoryAtPath:[storePath stringByDeletingLastPathComponent] withIntermediateDirectories:YES attributes:nil error:nil];
+	
+	if (![storeData writeToFile:storePath atomically:YES])
+	{
+		TOMLogForManager(_manager, TOMLogLevelError, @"[TOMFileManager] ERROR: Could not save filename index: '%@'.", storePath);
+		return NO;
+	}
+	
+	return YES;
+}
+
+
+
+
+- (NSString *)pathForFileNamed:(NSString *)filename
+{
+	__block NSString *foundPath = nil;
+	
+	
+	dispatch_sync(queue, ^{
+		// A hit only needs its own directory revalidated - a miss only has to look again in the directories that changed
+		foundPath = [self validatedPathForFileNamed:filename inDirectories:nil];
+		
+		if (foundPath == nil)
+		{
+			foundPath = [self validatedPathForFileNamed:filename inDirectories:[self revalidateAllDirectories]];
+		}
+	});
+	
+	
+	[self scheduleSave];
+	
+	return foundPath;
+}
+
+
+
+
+- (NSDictionary *)pathsForFileNames:(NSArray *)filenames
+{
+	NSMutableDictionary *foundPaths = [[NSMutableDictionary alloc] initWithCapacity:[filenames count]];
+	
+	
+	dispatch_sync(queue, ^{
+		NSMutableArray *missingFilenames = [[NSMutableArray alloc] init];
+		
+		for (NSString *filename in filenames)
+		{
+			NSString *foundPath = [self validatedPathForFileNamed:filename inDirectories:nil];
+			
+			if (foundPath != nil)
+			{
+				[foundPaths setObject:foundPath forKey:filename];
+			}
+			else
+			{
+				[missingFilenames addObject:filename];
+			}
+		}
+		
+		
+		// One revalidation pass covers every miss
+		if ([missingFilenames count] > 0)
+		{
+			NSSet *changedDirectories = [self revalidateAllDirectories];
+			
+			for (NSString *filename in missingFilenames)
+			{
+				NSString *foundPath = [self validatedPathForFileNamed:filename inDirectories:changedDirectories];
+				
+				if (foundPath != nil)
+				{
+					[foundPaths setObject:foundPath forKey:filename];
+				}
+			}
+		}
+	});
+	
+	
+	[self scheduleSave];
+	
+	return foundPaths;
+}
+
+
+
+
+- (void)noteChangeAtPath:(NSString *)path
+{
+	NSString *standardizedPath = [path stringByStandardizingPath];
+	
+	
+	dispatch_async(queue, ^{
+		// Whatever used to live at the path is gone, or has been replaced, so drop it and rediscover it from the parent
+		if ([self->directories objectForKey:standardizedPath] != nil)
+		{
+			[self removeDirectoryAtPath:standardizedPath];
+		}
+		
+		
+		NSString *parentPath = [standardizedPath stringByDeletingLastPathComponent];
+		
+		while ([self->directories objectForKey:parentPath] == nil)
+		{
+			if (![self isPathWithinRoots:parentPath])
+			{
+				return;
+			}
+			
+			parentPath = [parentPath stringByDeletingLastPathComponent];
+		}
+		
+		[self scanDirectoryAtPath:parentPath];
+		self->dirty = YES;
+	});
+	
+	
+	[self scheduleSave];
+}
+
+
+
+
+/*
+ * Called when entries were added to, removed from or renamed in `directoryPath`, by anyone. Unlike noteChangeAtPath:, only
+ * the directory itself is read again, and only if its modification time says it changed.
+ */
+- (void)noteChangeInDirectoryAtPath:(NSString *)directoryPath
+{
+	NSString *standardizedPath = [directoryPath stringByStandardizingPath];
+	
+	
+	dispatch_async(queue, ^{
+		[self revalidateDirectoryAtPath:standardizedPath];
+	});
+	
+	
+	[self scheduleSave];
+}
+
+
+
+
+/*
+ * Everything below must only be called on `queue`.
+ *
+ * Names are compared in their precomposed form, so a query finds a file whichever form either of them was written in. The
+ * returned path uses the name as it is on disk. If `directoryPaths` isn't nil, only those directories are looked in.
+ */
+- (NSString *)validatedPathForFileNamed:(NSString *)filename inDirectories:(NSSet *)directoryPaths
+{
+	NSString *canonicalFilename = [filename precomposedStringWithCanonicalMapping];
+	NSString *name = [canonicalFilename lastPathComponent];
+	NSString *requiredSuffix = nil;
+	
+	
+	if ([canonicalFilename rangeOfString:@"/"].location != NSNotFound)
+	{
+		requiredSuffix = [canonicalFilename hasPrefix:@"/"] ? canonicalFilename : [@"/" stringByAppendingString:canonicalFilename];
+	}
+	
+	
+	for (NSString *directoryPath in [self sortedDirectoriesContainingName:name])
+	{
+		if (directoryPaths != nil && ![directoryPaths containsObject:directoryPath])
+		{
+			continue;
+		}
+		
+		// A rescan may have dropped the name, or changed which form it's in
+		[self revalidateDirectoryAtPath:directoryPath];
+		
+		NSString *diskName = [self nameMatchingName:name inDirectoryAtPath:directoryPath];
+		
+		if (diskName == nil)
+		{
+			continue;
+		}
+		
+		NSString *filePath = [directoryPath stringByAppendingPathComponent:diskName];
+		
+		if (requiredSuffix == nil || [[filePath precomposedStringWithCanonicalMapping] hasSuffix:requiredSuffix])
+		{
+			return filePath;
+		}
+	}
+	
+	
+	return nil;
+}
+
+
+
+
+/*
+ * The file in the indexed `directoryPath` whose precomposed name is `name`, as it is spelled on disk.
+ */
+- (NSString *)nameMatchingName:(NSString *)name inDirectoryAtPath:(NSString *)directoryPath
+{
+	NSArray *files = [[directories objectForKey:directoryPath] objectForKey:TOMFilenameIndexFilesKey];
+	
+	
+	// Most names are stored precomposed already, so only normalize the listing when that misses
+	if ([files containsObject:name])
+	{
+		return name;
+	}
+	
+	for (NSString *filename in files)
+	{
+		if ([[filename precomposedStringWithCanonicalMapping] isEqualToString:name])
+		{
+			return filename;
+		}
+	}
+	
+	
+	return nil;
+}
+
+
+
+
+/*
+ * Revalidates every indexed directory, and returns the ones that were rescanned or newly found - the only places a name
+ * that missed before can have turned up.
+ */
+- (NSSet *)revalidateAllDirectories
+{
+	NSArray *knownDirectories = [directories allKeys];
+	NSMutableSet *changedDirectories = [[NSMutableSet alloc] init];
+	
+	
+	for (NSString *directoryPath in knownDirectories)
+	{
+		if (![self revalidateDirectoryAtPath:directoryPath])
+		{
+			[changedDirectories addObject:directoryPath];
+		}
+	}
+	
+	
+	// Directories only turn up when their parent is rescanned
+	if ([changedDirectories count] > 0)
+	{
+		NSSet *knownDirectorySet = [NSSet setWithArray:knownDirectories];
+		
+		for (NSString *directoryPath in directories)
+		{
+			if (![knownDirectorySet containsObject:directoryPath])
+			{
+				[changedDirectories addObject:directoryPath];
+			}
+		}
+	}
+	
+	
+	return changedDirectories;
+}
+
+
+
+
+- (NSArray *)sortedDirectoriesContainingName:(NSString *)name
+{
+	NSArray *directoryPaths = [[names objectForKey:[name precomposedStringWithCanonicalMapping]] copy];
+	
+	
+	if ([directoryPaths count] < 2)
+	{
+		return directoryPaths;
+	}
+	
+	
+	// Keep the same root priority that the full sandbox walk has
+	return [directoryPaths sortedArrayUsingComparator:^NSComparisonResult(NSString *first, NSString *second) {
+		NSUInteger firstRoot = [self indexOfRootContainingPath:first];
+		NSUInteger secondRoot = [self indexOfRootContainingPath:second];
+		
+		if (firstRoot != secondRoot)
+		{
+			return (firstRoot < secondRoot) ? NSOrderedAscending : NSOrderedDescending;
+		}
+		
+		return [first compare:second];
+	}];
+}
+
+
+
+
+- (NSUInteger)indexOfRootContainingPath:(NSString *)path
+{
+	NSUInteger rootIndex = 0;
+	
+	
+	for (NSString *rootPath in roots)
+	{
+		if ([path isEqualToString:rootPath] || [path hasPrefix:[rootPath stringByAppendingString:@"/"]])
+		{
+			return rootIndex;
+		}
+		
+		rootIndex++;
+	}
+	
+	
+	return NSNotFound;
+}
+
+
+
+
+- (BOOL)isPathWithinRoots:(NSString *)path
+{
+	return [self indexOfRootContainingPath:path] != NSNotFound;
+}
+
+
+
+
+/*
+ * Returns YES if the directory is unchanged since it was indexed. Otherwise it is rescanned (or dropped) and NO is returned.
+ */
+- (BOOL)revalidateDirectoryAtPath:(NSString *)directoryPath
+{
+	NSDictionary *record = [directories objectForKey:directoryPath];
+	struct stat directoryStat;
+	
+	
+	if (record == nil)
+	{
+		return NO;
+	}
+	
+	
+	TOMMetricsCount(TOMMetricsCounterStatCalls, 1);
+	if (lstat([directoryPath fileSystemRepresentation], &directoryStat) != 0 || !S_ISDIR(directoryStat.st_mode))
+	{
+		[self removeDirectoryAtPath:directoryPath];
+		dirty = YES;
+		
+		return NO;
+	}
+	
+	
+	if ([[record objectForKey:TOMFilenameIndexModificationTimeKey] longLongValue] == TOMModificationTimeOfStat(&directoryStat))
+	{
+		return YES;
+	}
+	
+	
+	[self scanDirectoryAtPath:directoryPath];
+	dirty = YES;
+	
+	return NO;
+}
+
+
+
+
+/*
+ * Indexes the immediate contents of `directoryPath`. Subdirectories that weren't indexed before are scanned recursively,
+ * and subdirectories that disappeared are dropped along with everything under them.
+ */
+- (void)scanDirectoryAtPath:(NSString *)directoryPath
+{
+	NSMutableDictionary *oldRecord = [directories objectForKey:directoryPath];
+	NSMutableArray *files = [[NSMutableArray alloc] init];
+	NSMutableArray *subdirectories = [[NSMutableArray alloc] init];
+	struct stat directoryStat;
+	
+	
+	// Read the mtime before listing, so a change racing with the listing is caught by the next revalidation
+	TOMMetricsCount(TOMMetricsCounterStatCalls, 1);
+	if (lstat([directoryPath fileSystemRepresentation], &directoryStat) != 0 || !S_ISDIR(directoryStat.st_mode))
+	{
+		if (oldRecord != nil)
+		{
+			[self removeDirectoryAtPath:directoryPath];
+		}
+		
+		return;
+	}
+	
+	
+	TOMWalkDirectory([directoryPath fileSystemRepresentation], NO, ^TOMWalkAction(const TOMWalkEntry *entry) {
+		NSString *entryName = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:entry->name length:entry->nameLength];
+		
+		if (entryName == nil || TOMWalkEntryIsPurgeDirectory(entry))
+		{
+			return TOMWalkActionContinue;
+		}
+		
+		if (entry->type == DT_DIR)
+		{
+			[subdirectories addObject:entryName];
+		}
+		else
+		{
+			[files addObject:entryName];
+		}
+		
+		return TOMWalkActionContinue;
+	});
+	
+	
+	if (oldRecord != nil)
+	{
+		for (NSString *filename in [oldRecord objectForKey:TOMFilenameIndexFilesKey])
+		{
+			[self removeName:filename inDirectory:directoryPath];
+		}
+		
+		for (NSString *subdirectoryName in [oldRecord objectForKey:TOMFilenameIndexSubdirectoriesKey])
+		{
+			if (![subdirectories containsObject:subdirectoryName])
+			{
+				[self removeDirectoryAtPath:[directoryPath stringByAppendingPathComponent:subdirectoryName]];
+			}
+		}
+	}
+	
+	
+	NSMutableDictionary *record = [NSMutableDictionary dictionaryWithCapacity:3];
+	[record setObject:@(TOMModificationTimeOfStat(&directoryStat)) forKey:TOMFilenameIndexModificationTimeKey];
+	[record setObject:files forKey:TOMFilenameIndexFilesKey];
+	[record setObject:subdirectories forKey:TOMFilenameIndexSubdirectoriesKey];
+	[directories setObject:record forKey:directoryPath];
+	
+	for (NSString *filename in files)
+	{
+		[self addName:filename inDirectory:directoryPath];
+	}
+	
+	
+	for (NSString *subdirectoryName in subdirectories)
+	{
+		NSString *subdirectoryPath = [directoryPath stringByAppendingPathComponent:subdirectoryName];
+		
+		if ([directories objectForKey:subdirectoryPath] == nil)
+		{
+			[self scanDirectoryAtPath:subdirectoryPath];
+		}
+	}
+}
+
+
+
+
+- (void)removeDirectoryAtPath:(NSString *)directoryPath
+{
+	NSDictionary *record = [directories objectForKey:directoryPath];
+	
+	
+	for (NSString *filename in [record objectForKey:TOMFilenameIndexFilesKey])
+	{
+		[self removeName:filename inDirectory:directoryPath];
+	}
+	
+	for (NSString *subdirectoryName in [record objectForKey:TOMFilenameIndexSubdirectoriesKey])
+	{
+		[self removeDirectoryAtPath:[directoryPath stringByAppendingPathComponent:subdirectoryName]];
+	}
+	
+	
+	[directories removeObjectForKey:directoryPath];
+}
+
+
+
+
+- (void)addName:(NSString *)filename inDirectory:(NSString *)directoryPath
+{
+	NSString *key = [filename precomposedStringWithCanonicalMapping];
+	NSMutableArray *directoryPaths = [names objectForKey:key];
+	
+	
+	if (directoryPaths == nil)
+	{
+		directoryPaths = [[NSMutableArray alloc] initWithCapacity:1];
+		[names setObject:directoryPaths forKey:key];
+	}
+	
+	[directoryPaths addObject:directoryPath];
+}
+
+
+
+
+- (void)removeName:(NSString *)filename inDirectory:(NSString *)directoryPath
+{
+	NSString *key = [filename precomposedStringWithCanonicalMapping];
+	NSMutableArray *directoryPaths = [names objectForKey:key];
+	
+	
+	// Only the first matching entry, in case two files in the directory differ only by normalization
+	NSUInteger directoryIndex = [directoryPaths indexOfObject:directoryPath];
+	
+	if (directoryIndex != NSNotFound)
+	{
+		[directoryPaths removeObjectAtIndex:directoryIndex];
+	}
+	
+	if ([directoryPaths count] == 0)
+	{
+		[names removeObjectForKey:key];
+	}
+}
+
+
+
+
+- (void)scheduleSave
+{
+	dispatch_async(queue, ^{
+		if (!self->dirty || self->saveScheduled)
+		{
+			return;
+		}
+		
+		// Coalesce bursts of changes into a single write
+		self->saveScheduled = YES;
+		
+		dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(2 * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0), ^{
+			dispatch_sync(self->queue, ^{
+				self->saveScheduled = NO;
+			});
+			
+			[self save];
+		});
+	});
+}
+
+
+@end
+
+
+
+
+
+/*
+ * TOMFileMetadata
+ *    Everything the manager's methods need to know about a path before acting on it, gathered with one stat(2) and one
+ *    access(2). Symbolic links are followed, the same as NSFileManager's fileExistsAtPath:isDirectory:.
+ */
+typedef struct TOMFileMetadata
+{
+	BOOL exists;
+	BOOL isDirectory;
+	BOOL isReadable;
+	unsigned long long size;
+	int64_t modificationTime;
+} TOMFileMetadata;
+
+
+
+
+static TOMFileMetadata TOMFileMetadataAtPath(const char *path)
+{
+	TOMFileMetadata metadata = {0};
+	struct stat fileStat;
+	
+	
+	TOMMetricsCount(TOMMetricsCounterStatCalls, 1);
+	
+	if (stat(path, &fileStat) == 0)
+	{
+		metadata.exists = YES;
+		metadata.isDirectory = S_ISDIR(fileStat.st_mode);
+		TOMMetricsCount(TOMMetricsCounterAccessCalls, 1);
+		metadata.isReadable = (access(path, R_OK) == 0);
+		metadata.size = (unsigned long long)fileStat.st_size;
+		metadata.modificationTime = TOMModificationTimeOfStat(&fileStat);
+	}
+	
+	
+	return metadata;
+}
+
+
+
+
+
+/*
+ * TOMMetadataCache
+ *    Remembers the TOMFileMetadata of recently checked paths for a fixed time to live, so repeated existence and type
+ *    checks don't go to the kernel. The manager forgets a path (along with its parent and anything inside it) whenever it
+ *    changes the path itself, and changes made by anything else are picked up once the entry expires.
+ */
+typedef struct TOMMetadataCacheEntry
+{
+	TOMFileMetadata metadata;
+	CFAbsoluteTime expirationTime;
+} TOMMetadataCacheEntry;
+
+
+
+
+@interface TOMMetadataCache : NSObject
+
+@property (readonly, nonatomic) NSTimeInterval timeToLive;
+@property (readonly, nonatomic) NSUInteger numberOfHits;
+@property (readonly, nonatomic) NSUInteger numberOfMisses;
+
+- (id)initWithTimeToLive:(NSTimeInterval)timeToLive;
+- (BOOL)getMetadata:(TOMFileMetadata *)metadata forPath:(NSString *)path;
+- (void)setMetadata:(TOMFileMetadata)metadata forPath:(NSString *)path;
+- (void)removeMetadataForPath:(NSString *)path;
+- (void)noteChangeAtPath:(NSString *)path;
+
+@end
+
+
+
+
+@implementation TOMMetadataCache
+{
+	// Path -> TOMMetadataCacheEntry
+	NSMutableDictionary *entries;
+	
+	os_unfair_lock lock;
+	atomic_ulong hits;
+	atomic_ulong misses;
+}
+
+
+
+
+- (id)initWithTimeToLive:(NSTimeInterval)timeToLive
+{
+	self = [super init];
+	
+	if (self)
+	{
+		_timeToLive = timeToLive;
+		entries = [[NSMutableDictionary alloc] init];
+		lock = OS_UNFAIR_LOCK_INIT;
+		atomic_init(&hits, 0);
+		atomic_init(&misses, 0);
+	}
+	
+	return self;
+}
+
+
+
+
+- (NSUInteger)numberOfHits
+{
+	return (NSUInteger)atomic_load_explicit(&hits, memory_order_relaxed);
+}
+
+
+
+
+- (NSUInteger)numberOfMisses
+{
+	return (NSUInteger)atomic_load_explicit(&misses, memory_order_relaxed);
+}
+
+
+
+
+- (BOOL)getMetadata:(TOMFileMetadata *)metadata forPath:(NSString *)path
+{
+	TOMMetadataCacheEntry entry;
+	BOOL found = NO;
+	
+	
+	os_unfair_lock_lock(&lock);
+	
+	NSValue *value = [entries objectForKey:path];
+	
+	if (value != nil)
+	{
+		[value getValue:&entry];
+		
+		if (entry.expirationTime > CFAbsoluteTimeGetCurrent())
+		{
+			*metadata = entry.metadata;
+			found = YES;
+		}
+		else
+		{
+			[entries removeObjectForKey:path];
+		}
+	}
+	
+	os_unfair_lock_unlock(&lock);
+	
+	
+	atomic_fetch_add_explicit(found ? &hits : &misses, 1, memory_order_relaxed);
+	
+	return found;
+}
+
+
+
+
+- (void)setMetadata:(TOMFileMetadata)metadata forPath:(NSString *)path
+{
+	CFAbsoluteTime now = CFAbsoluteTimeGetCurrent();
+	TOMMetadataCacheEntry entry = { metadata, now + _timeToLive };
+	NSValue *value = [NSValue valueWithBytes:&entry objCType:@encode(TOMMetadataCacheEntry)];
+	
+	
+	os_unfair_lock_lock(&lock);
+	
+	if ([entries count] >= TOMMetadataCacheCapacity)
+	{
+		[self removeEntriesExpiredBefore:now];
+		
+		// Everything is still live, so there's no way to tell which entries are worth keeping
+		if ([entries count] >= TOMMetadataCacheCapacity)
+		{
+			[entries removeAllObjects];
+		}
+	}
+	
+	[entries setObject:value forKey:path];
+	
+	os_unfair_lock_unlock(&lock);
+}
+
+
+
+
+- (void)removeMetadataForPath:(NSString *)path
+{
+	NSString *standardizedPath = [path stringByStandardizingPath];
+	
+	
+	os_unfair_lock_lock(&lock);
+	
+	[entries removeObjectForKey:standardizedPath];
+	
+	os_unfair_lock_unlock(&lock);
+}
+
+
+
+
+- (void)noteChangeAtPath:(NSString *)path
+{
+	NSString *standardizedPath = [path stringByStandardizingPath];
+	NSString *parentPath = [standardizedPath stringByDeletingLastPathComponent];
+	NSString *descendantPrefix = [standardizedPath hasSuffix:@"/"] ? standardizedPath : [standardizedPath stringByAppendingString:@"/"];
+	
+	
+	os_unfair_lock_lock(&lock);
+	
+	[entries removeObjectForKey:standardizedPath];
+	[entries removeObjectForKey:parentPath];
+	
+	// A moved or deleted directory takes everything inside it along
+	NSArray *descendantPaths = [[entries allKeys] filteredArrayUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(NSString *entryPath, NSDictionary *bindings) {
+		return [entryPath hasPrefix:descendantPrefix];
+	}]];
+	
+	[entries removeObjectsForKeys:descendantPaths];
+	
+	os_unfair_lock_unlock(&lock);
+}
+
+
+
+
+/*
+ * Must only be called while holding `lock`.
+ */
+- (void)removeEntriesExpiredBefore:(CFAbsoluteTime)time
+{
+	NSMutableArray *expiredPaths = [[NSMutableArray alloc] init];
+	
+	
+	[entries enumerateKeysAndObjectsUsingBlock:^(NSString *entryPath, NSValue *value, BOOL *stop) {
+		TOMMetadataCacheEntry entry;
+		[value getValue:&entry];
+		
+		if (entry.expirationTime <= time)
+		{
+			[expiredPaths addObject:entryPath];
+		}
+	}];
+	
+	[entries removeObjectsForKeys:expiredPaths];
+}
+
+
+@end
+
+
+
+
+
+/*
+ * TOMDirectorySizeCache
+ *    Remembers, for each directory a size query has read, the totals of the entries directly inside it and the names of
+ *    its subdirectories, along with the directory's modification time when it was read. Adding, removing or renaming an
+ *    entry changes that time, so a later query only has to re-read (and stat everything in) the directories whose time no
+ *    longer matches. A file that changes size in place doesn't touch its directory's time - the manager forgets the
+ *    directory whenever it changes a file itself, and passing NO for `useCache` re-reads everything.
+ */
+typedef struct TOMDirectorySizeTotals
+{
+	unsigned long long logicalSize;
+	unsigned long long allocatedSize;
+	unsigned long long numberOfFiles;
+	unsigned long long numberOfDirectories;
+} TOMDirectorySizeTotals;
+
+
+
+
+static void TOMDirectorySizeTotalsAdd(TOMDirectorySizeTotals *totals, const TOMDirectorySizeTotals *otherTotals)
+{
+	totals->logicalSize += otherTotals->logicalSize;
+	totals->allocatedSize += otherTotals->allocatedSize;
+	totals->numberOfFiles += otherTotals->numberOfFiles;
+	totals->numberOfDirectories += otherTotals->numberOfDirectories;
+}
+
+
+
+
+@interface TOMDirectorySizeCacheEntry : NSObject
+
+@property (nonatomic) int64_t modificationTime;
+@property (nonatomic) TOMDirectorySizeTotals totals;
+@property (nonatomic) NSArray *subdirectoryNames;
+
+@end
+
+
+
+
+@implementation TOMDirectorySizeCacheEntry
+@end
+
+
+
+
+@interface TOMDirectorySizeCache : NSObject
+
+- (TOMDirectorySizeCacheEntry *)entryForPath:(NSString *)path modificationTime:(int64_t)modificationTime;
+- (void)setEntry:(TOMDirectorySizeCacheEntry *)entry forPath:(NSString *)path;
+- (void)noteChangeAtPath:(NSString *)path;
+- (void)removeEntryForPath:(NSString *)path;
+- (void)removeAllEntries;
+
+@end
+
+
+
+
+@implementation TOMDirectorySizeCache
+{
+	// Directory path -> TOMDirectorySizeCacheEntry
+	NSMutableDictionary *entries;
+	
+	os_unfair_lock lock;
+}
+
+
+
+
+- (id)init
+{
+	self = [super init];
+	
+	if (self)
+	{
+		entries = [[NSMutableDictionary alloc] init];
+		lock = OS_UNFAIR_LOCK_INIT;
+	}
+	
+	return self;
+}
+
+
+
+
+/*
+ * Returns nil if the directory hasn't been read, or has changed since.
+ */
+- (TOMDirectorySizeCacheEntry *)entryForPath:(NSString *)path modificationTime:(int64_t)modificationTime
+{
+	os_unfair_lock_lock(&lock);
+	
+	TOMDirectorySizeCacheEntry *entry = [entries objectForKey:path];
+	
+	os_unfair_lock_unlock(&lock);
+	
+	
+	return (entry != nil && entry.modificationTime == modificationTime) ? entry : nil;
+}
+
+
+
+
+- (void)setEntry:(TOMDirectorySizeCacheEntry *)entry forPath:(NSString *)path
+{
+	os_unfair_lock_lock(&lock);
+	
+	if ([entries count] >= TOMDirectorySizeCacheCapacity && [entries objectForKey:path] == nil)
+	{
+		[entries removeAllObjects];
+	}
+	
+	[entries setObject:entry forKey:path];
+	
+	os_unfair_lock_unlock(&lock);
+}
+
+
+
+
+- (void)noteChangeAtPath:(NSString *)path
+{
+	NSString *parentPath = [path stringByDeletingLastPathComponent];
+	NSString *descendantPrefix = [path hasSuffix:@"/"] ? path : [path stringByAppendingString:@"/"];
+	
+	
+	os_unfair_lock_lock(&lock);
+	
+	[entries removeObjectForKey:path];
+	[entries removeObjectForKey:parentPath];
+	
+	NSArray *descendantPaths = [[entries allKeys] filteredArrayUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(NSString *entryPath, NSDictionary *bindings) {
+		return [entryPath hasPrefix:descendantPrefix];
+	}]];
+	
+	[entries removeObjectsForKeys:descendantPaths];
+	
+	os_unfair_lock_unlock(&lock);
+}
+
+
+
+
+- (void)removeEntryForPath:(NSString *)path
+{
+	os_unfair_lock_lock(&lock);
+	
+	[entries removeObjectForKey:path];
+	
+	os_unfair_lock_unlock(&lock);
+}
+
+
+
+
+- (void)removeAllEntries
+{
+	os_unfair_lock_lock(&lock);
+	
+	[entries removeAllObjects];
+	
+	os_unfair_lock_unlock(&lock);
+}
+
+
+@end
+
+
+
+
+/*
+ * TOMDirectorySizeOfDirectory
+ *    Adds the size of the directory at `directoryPath` itself, and of the entries directly inside it, to `totals`, and
+ *    returns the names of its subdirectories - or nil if it isn't a directory. The entries are taken from `cache` when the
+ *    directory hasn't changed since it was last read, and otherwise stat'd and stored there. Symbolic links are sized as
+ *    links, never followed.
+ */
+static NSArray *TOMDirectorySizeOfDirectory(NSString *directoryPath, TOMDirectorySizeCache *cache, BOOL useCache, TOMDirectorySizeTotals *totals)
+{
+	struct stat directoryStat;
+	
+	
+	TOMMetricsCount(TOMMetricsCounterStatCalls, 1);
+	
+	if (lstat([directoryPath fileSystemRepresentation], &directoryStat) != 0 || !S_ISDIR(directoryStat.st_mode))
+	{
+		return nil;
+	}
+	
+	// The directory's own blocks aren't cached, since they can grow without its modification time changing
+	totals->allocatedSize += (unsigned long long)directoryStat.st_blocks * 512;
+	
+	
+	int64_t modificationTime = TOMModificationTimeOfStat(&directoryStat);
+	TOMDirectorySizeCacheEntry *entry = useCache ? [cache entryForPath:directoryPath modificationTime:modificationTime] : nil;
+	
+	if (entry == nil)
+	{
+		__block TOMDirectorySizeTotals directoryTotals = {0};
+		NSMutableArray *subdirectoryNames = [[NSMutableArray alloc] init];
+		
+		TOMWalkDirectory([directoryPath fileSystemRepresentation], NO, ^TOMWalkAction(const TOMWalkEntry *walkEntry) {
+			if (walkEntry->type == DT_DIR)
+			{
+				NSString *subdirectoryName = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:walkEntry->name length:walkEntry->nameLength];
+				
+				if (subdirectoryName != nil)
+				{
+					[subdirectoryNames addObject:subdirectoryName];
+					directoryTotals.numberOfDirectories++;
+				}
+				
+				return TOMWalkActionContinue;
+			}
+			
+			
+			struct stat entryStat;
+			
+			TOMMetricsCount(TOMMetricsCounterStatCalls, 1);
+			
+			if (lstat(walkEntry->path, &entryStat) == 0)
+			{
+				directoryTotals.allocatedSize += (unsigned long long)entryStat.st_blocks * 512;
+				
+				if (S_ISREG(entryStat.st_mode))
+				{
+					directoryTotals.logicalSize += (unsigned long long)entryStat.st_size;
+					directoryTotals.numberOfFiles++;
+				}
+			}
+			
+			return TOMWalkActionContinue;
+		});
+		
+		
+		entry = [[TOMDirectorySizeCacheEntry alloc] init];
+		entry.modificationTime = modificationTime;
+		entry.totals = directoryTotals;
+		entry.subdirectoryNames = subdirectoryNames;
+		
+		[cache setEntry:entry forPath:directoryPath];
+	}
+	
+	
+	TOMDirectorySizeTotals entryTotals = entry.totals;
+	TOMDirectorySizeTotalsAdd(totals, &entryTotals);
+	
+	return entry.subdirectoryNames;
+}
+
+
+
+
+/*
+ * TOMDirectorySizeOfTree
+ *    Adds the size of the directory at `directoryPath` and everything below it to `totals`.
+ */
+static void TOMDirectorySizeOfTree(NSString *directoryPath, TOMDirectorySizeCache *cache, BOOL useCache, TOMDirectorySizeTotals *totals)
+{
+	@autoreleasepool
+	{
+		NSArray *subdirectoryNames = TOMDirectorySizeOfDirectory(directoryPath, cache, useCache, totals);
+		
+		for (NSString *subdirectoryName in subdirectoryNames)
+		{
+			TOMDirectorySizeOfTree([directoryPath stringByAppendingPathComponent:subdirectoryName], cache, useCache, totals);
+		}
+	}
+}
+
+
+
+
+
+/*
+ * TOMDirectoryWatch
+ *    Watches every directory in a tree with a vnode dispatch source, which fires when an entry in the directory is added,
+ *    removed or renamed, and when the directory itself is deleted or moved. Subdirectories are watched as soon as their
+ *    parent reports them. Changes are gathered for TOMWatchCoalescingInterval after the first one, and then handed to the
+ *    handler together, as one set of directory paths.
+ *
+ *    Each watched directory holds one descriptor, opened with O_EVTONLY so it never keeps a volume from being unmounted.
+ *    Writing to an existing file doesn't change its directory, so that isn't seen.
+ */
+@interface TOMDirectoryWatch : NSObject
+
+@property (readonly, nonatomic) NSString *rootPath;
+
+// The manager whose log level this logs at
+@property (weak, nonatomic) TOMFileManager *manager;
+
+- (id)initWithRootPath:(NSString *)rootPath handler:(void (^)(NSSet *changedDirectoryPaths))changeHandler;
+- (NSUInteger)start;
+- (void)cancel;
+
+@end
+
+
+
+
+@implementation TOMDirectoryWatch
+{
+	// Directory path -> dispatch_source_t. Everything here is only touched on `queue`.
+	NSMutableDictionary *sources;
+	NSMutableSet *pendingPaths;
+	BOOL deliveryScheduled;
+	BOOL reportedLimit;
+	
+	dispatch_queue_t queue;
+	void (^handler)(NSSet *changedDirectoryPaths);
+}
+
+
+
+
+- (id)initWithRootPath:(NSString *)rootPath handler:(void (^)(NSSet *changedDirectoryPaths))changeHandler
+{
+	self = [super init];
+	
+	if (self)
+	{
+		_rootPath = rootPath;
+		sources = [[NSMutableDictionary alloc] init];
+		pendingPaths = [[NSMutableSet alloc] init];
+		queue = dispatch_queue_create("TOMFileManager.watch", DISPATCH_QUEUE_SERIAL);
+		handler = changeHandler;
+	}
+	
+	return self;
+}
+
+
+
+
+- (void)dealloc
+{
+	for (dispatch_source_t source in [sources allValues])
+	{
+		dispatch_source_cancel(source);
+	}
+}
+
+
+
+
+/*
+ * Starts watching the whole tree, and returns how many directories are being watched.
+ */
+- (NSUInteger)start
+{
+	__block NSUInteger directoryCount = 0;
+	
+	
+	dispatch_sync(queue, ^{
+		[self watchTreeAtPath:self->_rootPath];
+		directoryCount = [self->sources count];
+	});
+	
+	return directoryCount;
+}
+
+
+
+
+- (void)cancel
+{
+	dispatch_sync(queue, ^{
+		for (dispatch_source_t source in [self->sources allValues])
+		{
+			dispatch_source_cancel(source);
+		}
+		
+		[self->sources removeAllObjects];
+		[self->pendingPaths removeAllObjects];
+	});
+}
+
+
+
+
+/*
+ * Must only be called on `queue`.
+ */
+- (void)watchTreeAtPath:(NSString *)directoryPath
+{
+	NSMutableArray *directoryPaths = [NSMutableArray arrayWithObject:directoryPath];
+	
+	
+	TOMWalkDirectory([directoryPath fileSystemRepresentation], YES, ^TOMWalkAction(const TOMWalkEntry *entry) {
+		if (TOMWalkEntryIsPurgeDirectory(entry))
+		{
+			return TOMWalkActionSkipDescendants;
+		}
+		
+		if (entry->type == DT_DIR)
+		{
+			NSString *subdirectoryPath = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:entry->path length:entry->pathLength];
+			
+			if (subdirectoryPath != nil)
+			{
+				[directoryPaths addObject:subdirectoryPath];
+			}
+		}
+		
+		return TOMWalkActionContinue;
+	});
+	
+	
+	for (NSString *path in directoryPaths)
+	{
+		[self watchDirectoryAtPath:path];
+	}
+}
+
+
+
+
+/*
+ * Must only be called on `queue`.
+ */
+- (void)watchDirectoryAtPath:(NSString *)directoryPath
+{
+	if ([sources objectForKey:directoryPath] != nil)
+	{
+		return;
+	}
+	
+	// Once per watch, since everything past the limit would otherwise log the same thing
+	if ([sources count] >= TOMWatchMaximumDirectoryCount)
+	{
+		if (!reportedLimit)
+		{
+			reportedLimit = YES;
+			TOMLogForManager(_manager, TOMLogLevelError, @"[TOMFileManager] ERROR: Could not watch directory: '%@'.\n   RESULTING ERROR: The watch of '%@' already holds %lu directories, so neither this directory nor any further one will be watched.", directoryPath, _rootPath, (unsigned long)TOMWatchMaximumDirectoryCount);
+		}
+		
+		return;
+	}
+	
+	
+	TOMMetricsCount(TOMMetricsCounterOpenCalls, 1);
+	int descriptor = open([directoryPath fileSystemRepresentation], O_EVTONLY | O_DIRECTORY | O_CLOEXEC);
+	
+	if (descriptor < 0)
+	{
+		TOMLogForManager(_manager, TOMLogLevelError, @"[TOMFileManager] ERROR: Could not watch directory: '%@'.\n   RESULTING ERROR: %s", directoryPath, strerror(errno));
+		return;
+	}
+	
+	
+	dispatch_source_t source = dispatch_source_create(DISPATCH_SOURCE_TYPE_VNODE, (uintptr_t)descriptor, DISPATCH_VNODE_WRITE | DISPATCH_VNODE_DELETE | DISPATCH_VNODE_RENAME | DISPATCH_VNODE_REVOKE, queue);
+	__weak TOMDirectoryWatch *weakSelf = self;
+	
+	if (source == NULL)
+	{
+		close(descriptor);
+		return;
+	}
+	
+	dispatch_source_set_event_handler(source, ^{
+		[weakSelf directoryAtPath:directoryPath changedWithFlags:dispatch_source_get_data(source)];
+	});
+	
+	dispatch_source_set_cancel_handler(source, ^{
+		close(descriptor);
+	});
+	
+	[sources setObject:source forKey:directoryPath];
+	dispatch_resume(source);
+}
+
+
+
+
+/*
+ * Must only be called on `queue`.
+ */
+- (void)stopWatchingTreeAtPath:(NSString *)directoryPath
+{
+	NSString *descendantPrefix = [directoryPath stringByAppendingString:@"/"];
+	
+	
+	for (NSString *path in [sources allKeys])
+	{
+		if ([path isEqualToString:directoryPath] || [path hasPrefix:descendantPrefix])
+		{
+			dispatch_source_cancel([sources objectForKey:path]);
+			[sources removeObjectForKey:path];
+		}
+	}
+}
+
+
+
+
+- (void)directoryAtPath:(NSString *)directoryPath changedWithFlags:(unsigned long)flags
+{
+	[pendingPaths addObject:directoryPath];
+	
+	
+	if (flags & (DISPATCH_VNODE_DELETE | DISPATCH_VNODE_RENAME | DISPATCH_VNODE_REVOKE))
+	{
+		// The directory is no longer where it was watched, and neither is anything inside it
+		[self stopWatchingTreeAtPath:directoryPath];
+		[pendingPaths addObject:[directoryPath stringByDeletingLastPathComponent]];
+	}
+	else
+	{
+		NSMutableArray *newDirectoryPaths = [[NSMutableArray alloc] init];
+		
+		TOMWalkDirectory([directoryPath fileSystemRepresentation], NO, ^TOMWalkAction(const TOMWalkEntry *entry) {
+			if (entry->type == DT_DIR && !TOMWalkEntryIsPurgeDirectory(entry))
+			{
+				NSString *subdirectoryPath = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:entry->path length:entry->pathLength];
+				
+				if (subdirectoryPath != nil && [self->sources objectForKey:subdirectoryPath] == nil)
+				{
+					[newDirectoryPaths addObject:subdirectoryPath];
+				}
+			}
+			
+			return TOMWalkActionContinue;
+		});
+		
+		// A directory that was just created or moved in may already have contents of its own
+		for (NSString *newDirectoryPath in newDirectoryPaths)
+		{
+			[pendingPaths addObject:newDirectoryPath];
+			[self watchTreeAtPath:newDirectoryPath];
+		}
+	}
+	
+	
+	if (!deliveryScheduled)
+	{
+		__weak TOMDirectoryWatch *weakSelf = self;
+		deliveryScheduled = YES;
+		
+		dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(TOMWatchCoalescingInterval * NSEC_PER_SEC)), queue, ^{
+			[weakSelf deliverChanges];
+		});
+	}
+}
+
+
+
+
+- (void)deliverChanges
+{
+	NSSet *changedPaths = [pendingPaths copy];
+	
+	
+	[pendingPaths removeAllObjects];
+	deliveryScheduled = NO;
+	
+	if ([changedPaths count] > 0)
+	{
+		handler(changedPaths);
+	}
+}
+
+
+@end
+
+
+
+
+
+/*
+ * TOMCopyFileContents
+ *    Copies one file to a path that must not exist yet, using the cheapest strategy the volume allows. It tries a clone
+ *    first (copy-on-write, so no data moves at all). When the volume can't clone, a regular file's data is read and
+ *    written in large chunks that bypass the buffer cache, since the data won't be read again, and fcopyfile(3) only
+ *    carries over the metadata. copyfile's own data copy is a plain read/write loop through the cache, so it would only
+ *    be slower. Symbolic links and special files are recreated by copyfile(3).
+ *    Returns 0 on success, or the errno of the failure.
+ */
+static int TOMCopyFileContents(const char *sourcePath, const char *destinationPath, TOMCopyStrategy *strategy, unsigned long long *bytesCopied)
+{
+	struct stat sourceStat;
+	
+	
+	TOMMetricsCount(TOMMetricsCounterStatCalls, 1);
+	
+	if (lstat(sourcePath, &sourceStat) != 0)
+	{
+		return errno;
+	}
+	
+	*bytesCopied = S_ISREG(sourceStat.st_mode) ? (unsigned long long)sourceStat.st_size : 0;
+	
+	
+	TOMMetricsCount(TOMMetricsCounterCloneCalls, 1);
+	
+	if (clonefile(sourcePath, destinationPath, CLONE_NOFOLLOW) == 0)
+	{
+		*strategy = TOMCopyStrategyClone;
+		return 0;
+	}
+	
+	// Anything but "this volume can't clone that" is a real failure, which the other strategies would only repeat
+	if (errno != ENOTSUP && errno != EXDEV && errno != EPERM)
+	{
+		return errno;
+	}
+	
+	
+	// Symbolic links and special files are left to copyfile, which recreates them instead of copying their data
+	if (!S_ISREG(sourceStat.st_mode))
+	{
+		TOMMetricsCount(TOMMetricsCounterCopyfileCalls, 1);
+		
+		if (copyfile(sourcePath, destinationPath, NULL, COPYFILE_ALL | COPYFILE_NOFOLLOW_SRC | COPYFILE_EXCL) != 0)
+		{
+			return errno;
+		}
+		
+		*strategy = TOMCopyStrategyCopyfile;
+		return 0;
+	}
+	
+	
+	TOMMetricsCount(TOMMetricsCounterOpenCalls, 1);
+	
+	int sourceDescriptor = open(sourcePath, O_RDONLY | O_CLOEXEC);
+	
+	if (sourceDescriptor < 0)
+	{
+		return errno;
+	}
+	
+	TOMMetricsCount(TOMMetricsCounterOpenCalls, 1);
+	int destinationDescriptor = open(destinationPath, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, sourceStat.st_mode & ALLPERMS);
+	
+	if (destinationDescriptor < 0)
+	{
+		int openError = errno;
+		close(sourceDescriptor);
+		
+		return openError;
+	}
+	
+	
+	int copyError = 0;
+	char *buffer = malloc(TOMDefaultChunkSize);
+	
+	if (buffer == NULL)
+	{
+		copyError = ENOMEM;
+	}
+	else
+	{
+		fcntl(sourceDescriptor, F_NOCACHE, 1);
+		fcntl(destinationDescriptor, F_NOCACHE, 1);
+		fcntl(sourceDescriptor, F_RDAHEAD, 1);
+	}
+	
+	
+	while (copyError == 0)
+	{
+		TOMMetricsCount(TOMMetricsCounterReadCalls, 1);
+		ssize_t bytesRead = read(sourceDescriptor, buffer, TOMDefaultChunkSize);
+		
+		if (bytesRead == 0)
+		{
+			break;
+		}
+		
+		if (bytesRead < 0)
+		{
+			copyError = (errno == EINTR) ? 0 : errno;
+			continue;
+		}
+		
+		TOMMetricsCount(TOMMetricsCounterBytesRead, (uint64_t)bytesRead);
+		
+		
+		ssize_t bytesWritten = 0;
+		
+		while (bytesWritten < bytesRead)
+		{
+			TOMMetricsCount(TOMMetricsCounterWriteCalls, 1);
+			ssize_t result = write(destinationDescriptor, buffer + bytesWritten, (size_t)(bytesRead - bytesWritten));
+			
+			if (result < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+				
+				copyError = errno;
+				break;
+			}
+			
+			bytesWritten += result;
+			TOMMetricsCount(TOMMetricsCounterBytesWritten, (uint64_t)result);
+		}
+	}
+	
+	
+	free(buffer);
+	
+	if (copyError == 0)
+	{
+		// Carry over the permissions, times and extended attributes, without touching the data just written
+		TOMMetricsCount(TOMMetricsCounterCopyfileCalls, 1);
+		fcopyfile(sourceDescriptor, destinationDescriptor, NULL, COPYFILE_METADATA);
+		
+		*strategy = TOMCopyStrategyReadWrite;
+	}
+	
+	
+	close(sourceDescriptor);
+	
+	if (close(destinationDescriptor) != 0 && copyError == 0)
+	{
+		copyError = errno;
+	}
+	
+	if (copyError != 0)
+	{
+		TOMMetricsCount(TOMMetricsCounterUnlinkCalls, 1);
+		unlink(destinationPath);
+	}
+	
+	
+	return copyError;
+}
+
+
+
+
+
+/*
+ * TOMRemoveDirectoryContents
+ *    Unlinks everything inside an open directory, depth first, without following symbolic links. Entries are unlinked
+ *    while the directory is being read, which some file systems answer by skipping entries, so the directory is read again
+ *    until a pass finds nothing left to remove. Takes ownership of `directoryDescriptor`, and returns 0 once the directory
+ *    is empty, or the errno of the first failure. Something else removing the same entries at the same time is fine.
+ */
+static int TOMRemoveDirectoryContents(int directoryDescriptor);
+
+
+static int TOMRemoveEntry(int parentDescriptor, const char *name, unsigned char type)
+{
+	struct stat entryStat;
+	
+	
+	TOMMetricsCount(TOMMetricsCounterEntriesVisited, 1);
+	
+	if (type == DT_UNKNOWN)
+	{
+		TOMMetricsCount(TOMMetricsCounterStatCalls, 1);
+		
+		if (fstatat(parentDescriptor, name, &entryStat, AT_SYMLINK_NOFOLLOW) != 0)
+		{
+			return errno;
+		}
+		
+		type = IFTODT(entryStat.st_mode);
+	}
+	
+	
+	if (type == DT_DIR)
+	{
+		TOMMetricsCount(TOMMetricsCounterOpenCalls, 1);
+		int directoryDescriptor = openat(parentDescriptor, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+		
+		if (directoryDescriptor < 0)
+		{
+			return errno;
+		}
+		
+		int removeError = TOMRemoveDirectoryContents(directoryDescriptor);
+		
+		if (removeError != 0)
+		{
+			return removeError;
+		}
+		
+		TOMMetricsCount(TOMMetricsCounterUnlinkCalls, 1);
+		
+		return (unlinkat(parentDescriptor, name, AT_REMOVEDIR) == 0) ? 0 : errno;
+	}
+	
+	
+	TOMMetricsCount(TOMMetricsCounterUnlinkCalls, 1);
+	
+	return (unlinkat(parentDescriptor, name, 0) == 0) ? 0 : errno;
+}
+
+
+static int TOMRemoveDirectoryContents(int directoryDescriptor)
+{
+	DIR *directory = fdopendir(directoryDescriptor);
+	struct dirent *directoryEntry;
+	BOOL removedAny = YES;
+	int removeError = 0;
+	
+	
+	if (directory == NULL)
+	{
+		removeError = errno;
+		close(directoryDescriptor);
+		
+		return removeError;
+	}
+	
+	
+	while (removedAny && removeError == 0)
+	{
+		removedAny = NO;
+		rewinddir(directory);
+		
+		while ((directoryEntry = readdir(directory)) != NULL)
+		{
+			const char *name = directoryEntry->d_name;
+			
+			if (name[0] == '.' && (directoryEntry->d_namlen == 1 || (directoryEntry->d_namlen == 2 && name[1] == '.')))
+			{
+				continue;
+			}
+			
+			
+			int entryError = TOMRemoveEntry(dirfd(directory), name, directoryEntry->d_type);
+			
+			if (entryError != 0 && entryError != ENOENT)
+			{
+				removeError = entryError;
+				break;
+			}
+			
+			removedAny = YES;
+		}
+	}
+	
+	
+	closedir(directory);
+	
+	return removeError;
+}
+
+
+
+
+
+/*
+ * TOMReadFully
+ *    Reads until `buffer` is full or the file ends, retrying reads that are interrupted or come back short. Returns the
+ *    number of bytes read, or -1 on error.
+ */
+static ssize_t TOMReadFully(int descriptor, char *buffer, size_t length)
+{
+	size_t totalRead = 0;
+	
+	
+	while (totalRead < length)
+	{
+		TOMMetricsCount(TOMMetricsCounterReadCalls, 1);
+		ssize_t bytesRead = read(descriptor, buffer + totalRead, length - totalRead);
+		
+		if (bytesRead == 0)
+		{
+			break;
+		}
+		
+		if (bytesRead < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			
+			return -1;
+		}
+		
+		totalRead += (size_t)bytesRead;
+	}
+	
+	
+	TOMMetricsCount(TOMMetricsCounterBytesRead, totalRead);
+	
+	return (ssize_t)totalRead;
+}
+
+
+
+
+/*
+ * TOMFileContentsAreEqual
+ *    Whether two files hold the same bytes. They are read side by side a chunk at a time, so a difference near the start
+ *    is found without reading the rest. Files that can't be read are never equal.
+ */
+static BOOL TOMFileContentsAreEqual(const char *path, const char *otherPath)
+{
+	BOOL equal = NO;
+	char *buffer = malloc(TOMDefaultChunkSize);
+	char *otherBuffer = malloc(TOMDefaultChunkSize);
+	
+	
+	TOMMetricsCount(TOMMetricsCounterOpenCalls, 1);
+	int descriptor = open(path, O_RDONLY | O_CLOEXEC);
+	TOMMetricsCount(TOMMetricsCounterOpenCalls, 1);
+	int otherDescriptor = open(otherPath, O_RDONLY | O_CLOEXEC);
+	
+	if (buffer != NULL && otherBuffer != NULL && descriptor >= 0 && otherDescriptor >= 0)
+	{
+		// Each byte is looked at exactly once, so there's no point keeping any of it in the buffer cache
+		fcntl(descriptor, F_NOCACHE, 1);
+		fcntl(otherDescriptor, F_NOCACHE, 1);
+		
+		while (YES)
+		{
+			ssize_t bytesRead = TOMReadFully(descriptor, buffer, TOMDefaultChunkSize);
+			ssize_t otherBytesRead = TOMReadFully(otherDescriptor, otherBuffer, TOMDefaultChunkSize);
+			
+			if (bytesRead < 0 || bytesRead != otherBytesRead || memcmp(buffer, otherBuffer, (size_t)bytesRead) != 0)
+			{
+				break;
+			}
+			
+			if (bytesRead == 0)
+			{
+				equal = YES;
+				break;
+			}
+		}
+	}
+	
+	
+	if (descriptor >= 0)
+	{
+		close(descriptor);
+	}
+	
+	if (otherDescriptor >= 0)
+	{
+		close(otherDescriptor);
+	}
+	
+	free(buffer);
+	free(otherBuffer);
+	
+	return equal;
+}
+
+
+
+
+
+/*
+ * TOMXXH64
+ *    A streaming XXH64, with a seed of 0. Every 32 byte stripe feeds four independent accumulators, so a stripe's four
+ *    multiplies run side by side in the pipeline - the same parallelism a vectorized kernel would get, without depending on
+ *    the vector width of the device.
+ */
+static const uint64_t TOMXXH64Prime1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t TOMXXH64Prime2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t TOMXXH64Prime3 = 0x165667B19E3779F9ULL;
+static const uint64_t TOMXXH64Prime4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t TOMXXH64Prime5 = 0x27D4EB2F165667C5ULL;
+
+
+typedef struct TOMXXH64State
+{
+	uint64_t totalLength;
+	uint64_t accumulators[4];
+	uint8_t buffer[32];
+	size_t bufferLength;
+} TOMXXH64State;
+
+
+
+
+static inline uint64_t TOMRotateLeft64(uint64_t value, int bits)
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+
+
+
+static inline uint64_t TOMReadLittleEndian64(const uint8_t *bytes)
+{
+	uint64_t value;
+	memcpy(&value, bytes, sizeof(value));
+	
+	return CFSwapInt64LittleToHost(value);
+}
+
+
+
+
+static inline uint64_t TOMXXH64Round(uint64_t accumulator, uint64_t input)
+{
+	accumulator += input * TOMXXH64Prime2;
+	accumulator = TOMRotateLeft64(accumulator, 31);
+	
+	return accumulator * TOMXXH64Prime1;
+}
+
+
+
+
+static inline uint64_t TOMXXH64MergeRound(uint64_t hash, uint64_t accumulator)
+{
+	hash ^= TOMXXH64Round(0, accumulator);
+	
+	return hash * TOMXXH64Prime1 + TOMXXH64Prime4;
+}
+
+
+
+
+static void TOMXXH64Init(TOMXXH64State *state)
+{
+	memset(state, 0, sizeof(*state));
+	
+	state->accumulators[0] = TOMXXH64Prime1 + TOMXXH64Prime2;
+	state->accumulators[1] = TOMXXH64Prime2;
+	state->accumulators[2] = 0;
+	state->accumulators[3] = 0 - TOMXXH64Prime1;
+}
+
+
+
+
+static inline void TOMXXH64Stripe(TOMXXH64State *state, const uint8_t *stripe)
+{
+	state->accumulators[0] = TOMXXH64Round(state->accumulators[0], TOMReadLittleEndian64(stripe));
+	state->accumulators[1] = TOMXXH64Round(state->accumulators[1], TOMReadLittleEndian64(stripe + 8));
+	state->accumulators[2] = TOMXXH64Round(state->accumulators[2], TOMReadLittleEndian64(stripe + 16));
+	state->accumulators[3] = TOMXXH64Round(state->accumulators[3], TOMReadLittleEndian64(stripe + 24));
+}
+
+
+
+
+static void TOMXXH64Update(TOMXXH64State *state, const uint8_t *bytes, size_t length)
+{
+	state->totalLength += length;
+	
+	
+	if (state->bufferLength + length < sizeof(state->buffer))
+	{
+		memcpy(state->buffer + state->bufferLength, bytes, length);
+		state->bufferLength += length;
+		
+		return;
+	}
+	
+	if (state->bufferLength > 0)
+	{
+		size_t fillLength = sizeof(state->buffer) - state->bufferLength;
+		
+		memcpy(state->buffer + state->bufferLength, bytes, fillLength);
+		TOMXXH64Stripe(state, state->buffer);
+		
+		bytes += fillLength;
+		length -= fillLength;
+		state->bufferLength = 0;
+	}
+	
+	
+	while (length >= sizeof(state->buffer))
+	{
+		TOMXXH64Stripe(state, bytes);
+		
+		bytes += sizeof(state->buffer);
+		length -= sizeof(state->buffer);
+	}
+	
+	memcpy(state->buffer, bytes, length);
+	state->bufferLength = length;
+}
+
+
+
+
+static uint64_t TOMXXH64Final(const TOMXXH64State *state)
+{
+	const uint64_t *accumulators = state->accumulators;
+	const uint8_t *bytes = state->buffer;
+	size_t length = state->bufferLength;
+	uint64_t hash;
+	
+	
+	if (state->totalLength >= sizeof(state->buffer))
+	{
+		hash = TOMRotateLeft64(accumulators[0], 1) + TOMRotateLeft64(accumulators[1], 7) + TOMRotateLeft64(accumulators[2], 12) + TOMRotateLeft64(accumulators[3], 18);
+		hash = TOMXXH64MergeRound(hash, accumulators[0]);
+		hash = TOMXXH64MergeRound(hash, accumulators[1]);
+		hash = TOMXXH64MergeRound(hash, accumulators[2]);
+		hash = TOMXXH64MergeRound(hash, accumulators[3]);
+	}
+	else
+	{
+		hash = TOMXXH64Prime5;
+	}
+	
+	hash += state->totalLength;
+	
+	
+	while (length >= 8)
+	{
+		hash ^= TOMXXH64Round(0, TOMReadLittleEndian64(bytes));
+		hash = TOMRotateLeft64(hash, 27) * TOMXXH64Prime1 + TOMXXH64Prime4;
+		
+		bytes += 8;
+		length -= 8;
+	}
+	
+	if (length >= 4)
+	{
+		uint32_t word;
+		memcpy(&word, bytes, sizeof(word));
+		
+		hash ^= (uint64_t)CFSwapInt32LittleToHost(word) * TOMXXH64Prime1;
+		hash = TOMRotateLeft64(hash, 23) * TOMXXH64Prime2 + TOMXXH64Prime3;
+		
+		bytes += 4;
+		length -= 4;
+	}
+	
+	while (length > 0)
+	{
+		hash ^= (uint64_t)(*bytes) * TOMXXH64Prime5;
+		hash = TOMRotateLeft64(hash, 11) * TOMXXH64Prime1;
+		
+		bytes++;
+		length--;
+	}
+	
+	
+	hash ^= hash >> 33;
+	hash *= TOMXXH64Prime2;
+	hash ^= hash >> 29;
+	hash *= TOMXXH64Prime3;
+	hash ^= hash >> 32;
+	
+	return hash;
+}
+
+
+
+
+
+/*
+ * TOMCRC32C
+ *    CRC-32C (Castagnoli). Uses the CPU's CRC instructions when the target has them (ARMv8 with the CRC extension, or
+ *    x86 with SSE 4.2), eight bytes per instruction. Otherwise it falls back to slicing-by-8, which looks up eight table
+ *    entries per eight bytes instead of one per byte.
+ */
+#if !defined(__ARM_FEATURE_CRC32) && !defined(__SSE4_2__)
+static uint32_t TOMCRC32CTable[8][256];
+static dispatch_once_t TOMCRC32CTableOnce;
+
+
+static void TOMCRC32CMakeTable(void *context)
+{
+	for (uint32_t index = 0; index < 256; index++)
+	{
+		uint32_t crc = index;
+		
+		for (int bit = 0; bit < 8; bit++)
+		{
+			crc = (crc & 1) ? (crc >> 1) ^ 0x82F63B78 : (crc >> 1);
+		}
+		
+		TOMCRC32CTable[0][index] = crc;
+	}
+	
+	for (uint32_t index = 0; index < 256; index++)
+	{
+		for (int slice = 1; slice < 8; slice++)
+		{
+			uint32_t previous = TOMCRC32CTable[slice - 1][index];
+			TOMCRC32CTable[slice][index] = (previous >> 8) ^ TOMCRC32CTable[0][previous & 0xFF];
+		}
+	}
+}
+#endif
+
+
+
+
+/*
+ * Continues `crc`, which starts out as 0xFFFFFFFF and is inverted once everything has been added.
+ */
+static uint32_t TOMCRC32CUpdate(uint32_t crc, const uint8_t *bytes, size_t length)
+{
+#if defined(__ARM_FEATURE_CRC32)
+	while (length >= 8)
+	{
+		uint64_t value;
+		memcpy(&value, bytes, sizeof(value));
+		crc = __crc32cd(crc, value);
+		
+		bytes += 8;
+		length -= 8;
+	}
+	
+	while (length > 0)
+	{
+		crc = __crc32cb(crc, *bytes);
+		
+		bytes++;
+		length--;
+	}
+#elif defined(__SSE4_2__)
+	while (length >= 8)
+	{
+		uint64_t value;
+		memcpy(&value, bytes, sizeof(value));
+		crc = (uint32_t)_mm_crc32_u64(crc, value);
+		
+		bytes += 8;
+		length -= 8;
+	}
+	
+	while (length > 0)
+	{
+		crc = _mm_crc32_u8(crc, *bytes);
+		
+		bytes++;
+		length--;
+	}
+#else
+	dispatch_once_f(&TOMCRC32CTableOnce, NULL, TOMCRC32CMakeTable);
+	
+	while (length >= 8)
+	{
+		uint64_t value = TOMReadLittleEndian64(bytes) ^ crc;
+		
+		crc = TOMCRC32CTable[7][value & 0xFF] ^ TOMCRC32CTable[6][(value >> 8) & 0xFF] ^ TOMCRC32CTable[5][(value >> 16) & 0xFF] ^ TOMCRC32CTable[4][(value >> 24) & 0xFF] ^ TOMCRC32CTable[3][(value >> 32) & 0xFF] ^ TOMCRC32CTable[2][(value >> 40) & 0xFF] ^ TOMCRC32CTable[1][(value >> 48) & 0xFF] ^ TOMCRC32CTable[0][value >> 56];
+		
+		bytes += 8;
+		length -= 8;
+	}
+	
+	while (length > 0)
+	{
+		crc = (crc >> 8) ^ TOMCRC32CTable[0][(crc ^ *bytes) & 0xFF];
+		
+		bytes++;
+		length--;
+	}
+#endif
+	
+	return crc;
+}
+
+
+
+
+
+/*
+ * TOMHasher
+ *    One running hash of whichever algorithm, so files can be streamed through any of them the same way.
+ */
+typedef struct TOMHasher
+{
+	TOMHashAlgorithm algorithm;
+	
+	union
+	{
+		TOMXXH64State xxh64;
+		uint32_t crc32c;
+		CC_SHA256_CTX sha256;
+	} state;
+} TOMHasher;
+
+
+
+
+static void TOMHasherInit(TOMHasher *hasher, TOMHashAlgorithm algorithm)
+{
+	hasher->algorithm = algorithm;
+	
+	
+	switch (algorithm)
+	{
+		case TOMHashAlgorithmXXH64:
+			TOMXXH64Init(&hasher->state.xxh64);
+			break;
+		
+		case TOMHashAlgorithmCRC32C:
+			hasher->state.crc32c = 0xFFFFFFFF;
+			break;
+		
+		case TOMHashAlgorithmSHA256:
+			CC_SHA256_Init(&hasher->state.sha256);
+			break;
+	}
+}
+
+
+
+
+static void TOMHasherUpdate(TOMHasher *hasher, const uint8_t *bytes, size_t length)
+{
+	switch (hasher->algorithm)
+	{
+		case TOMHashAlgorithmXXH64:
+			TOMXXH64Update(&hasher->state.xxh64, bytes, length);
+			break;
+		
+		case TOMHashAlgorithmCRC32C:
+			hasher->state.crc32c = TOMCRC32CUpdate(hasher->state.crc32c, bytes, length);
+			break;
+		
+		case TOMHashAlgorithmSHA256:
+			CC_SHA256_Update(&hasher->state.sha256, bytes, (CC_LONG)length);
+			break;
+	}
+}
+
+
+
+
+/*
+ * The digest, with the integer hashes in big endian order - the way they are usually written out.
+ */
+static NSData *TOMHasherFinish(TOMHasher *hasher)
+{
+	switch (hasher->algorithm)
+	{
+		case TOMHashAlgorithmXXH64:
+		{
+			uint64_t digest = CFSwapInt64HostToBig(TOMXXH64Final(&hasher->state.xxh64));
+			return [NSData dataWithBytes:&digest length:sizeof(digest)];
+		}
+		
+		case TOMHashAlgorithmCRC32C:
+		{
+			uint32_t digest = CFSwapInt32HostToBig(hasher->state.crc32c ^ 0xFFFFFFFF);
+			return [NSData dataWithBytes:&digest length:sizeof(digest)];
+		}
+		
+		case TOMHashAlgorithmSHA256:
+		{
+			uint8_t digest[CC_SHA256_DIGEST_LENGTH];
+			CC_SHA256_Final(digest, &hasher->state.sha256);
+			
+			return [NSData dataWithBytes:digest length:sizeof(digest)];
+		}
+	}
+	
+	
+	return nil;
+}
+
+
+
+
+/*
+ * TOMHashFile
+ *    Streams the file at `path` through `algorithm` a chunk at a time, so only one chunk is ever in memory. Returns 0 on
+ *    success, or the errno of the failure.
+ */
+static int TOMHashFile(const char *path, TOMHashAlgorithm algorithm, NSData **digest, unsigned long long *bytesHashed)
+{
+	struct stat fileStat;
+	TOMHasher hasher;
+	int hashError = 0;
+	
+	
+	if (algorithm != TOMHashAlgorithmXXH64 && algorithm != TOMHashAlgorithmCRC32C && algorithm != TOMHashAlgorithmSHA256)
+	{
+		return EINVAL;
+	}
+	
+	
+	TOMMetricsCount(TOMMetricsCounterOpenCalls, 1);
+	int descriptor = open(path, O_RDONLY | O_CLOEXEC);
+	
+	if (descriptor < 0)
+	{
+		return errno;
+	}
+	
+	TOMMetricsCount(TOMMetricsCounterStatCalls, 1);
+	
+	if (fstat(descriptor, &fileStat) != 0)
+	{
+		hashError = errno;
+	}
+	else if (S_ISDIR(fileStat.st_mode))
+	{
+		hashError = EISDIR;
+	}
+	
+	if (hashError != 0)
+	{
+		close(descriptor);
+		
+		return hashError;
+	}
+	
+	
+	uint8_t *buffer = malloc(TOMDefaultChunkSize);
+	
+	if (buffer == NULL)
+	{
+		close(descriptor);
+		
+		return ENOMEM;
+	}
+	
+	fcntl(descriptor, F_RDAHEAD, 1);
+	TOMHasherInit(&hasher, algorithm);
+	*bytesHashed = 0;
+	
+	
+	while (YES)
+	{
+		ssize_t bytesRead = TOMReadFully(descriptor, (char *)buffer, TOMDefaultChunkSize);
+		
+		if (bytesRead < 0)
+		{
+			hashError = errno;
+			break;
+		}
+		
+		if (bytesRead == 0)
+		{
+			break;
+		}
+		
+		TOMHasherUpdate(&hasher, buffer, (size_t)bytesRead);
+		*bytesHashed += (unsigned long long)bytesRead;
+	}
+	
+	
+	free(buffer);
+	close(descriptor);
+	
+	if (hashError == 0)
+	{
+		*digest = TOMHasherFinish(&hasher);
+	}
+	
+	
+	return hashError;
+}
+
+
+
+
+
+/*
+ * TOMDuplicateCandidate
+ *    A regular file the duplicate finder has yet to rule out. Candidates are narrowed down in rounds that each cost more
+ *    than the last - size, then a hash of the file's start and end, then a hash of the whole file - and after each round
+ *    they are sorted so that the files that still match sit next to each other.
+ */
+typedef struct TOMDuplicateCandidate
+{
+	char *path;
+	unsigned long long size;
+	dev_t device;
+	ino_t inode;
+	uint64_t partialHash;
+	uint64_t fullHash;
+} TOMDuplicateCandidate;
+
+
+
+
+/*
+ * Largest files first, since they waste the most space. Hard links to the same file end up next to each other.
+ */
+static int TOMDuplicateCandidateCompare(const void *first, const void *second)
+{
+	const TOMDuplicateCandidate *candidate = first;
+	const TOMDuplicateCandidate *otherCandidate = second;
+	
+	
+	if (candidate->size != otherCandidate->size)
+	{
+		return (candidate->size > otherCandidate->size) ? -1 : 1;
+	}
+	
+	if (candidate->partialHash != otherCandidate->partialHash)
+	{
+		return (candidate->partialHash < otherCandidate->partialHash) ? -1 : 1;
+	}
+	
+	if (candidate->fullHash != otherCandidate->fullHash)
+	{
+		return (candidate->fullHash < otherCandidate->fullHash) ? -1 : 1;
+	}
+	
+	if (candidate->device != otherCandidate->device)
+	{
+		return (candidate->device < otherCandidate->device) ? -1 : 1;
+	}
+	
+	if (candidate->inode != otherCandidate->inode)
+	{
+		return (candidate->inode < otherCandidate->inode) ? -1 : 1;
+	}
+	
+	
+	return strcmp(candidate->path, otherCandidate->path);
+}
+
+
+
+
+/*
+ * Whether two sorted neighbours are still alike as far as the rounds so far can tell.
+ */
+static BOOL TOMDuplicateCandidatesMatch(const TOMDuplicateCandidate *candidate, const TOMDuplicateCandidate *otherCandidate)
+{
+	return candidate->size == otherCandidate->size && candidate->partialHash == otherCandidate->partialHash && candidate->fullHash == otherCandidate->fullHash;
+}
+
+
+
+
+/*
+ * XXH64 of the first and last TOMDuplicatePartialLength bytes of a file `size` bytes long - or of all of it, if it's no
+ * longer than that twice. Returns 0 on success, or the errno of the failure.
+ */
+static int TOMPartialHashFile(const char *path, unsigned long long size, uint64_t *hash)
+{
+	uint8_t buffer[TOMDuplicatePartialLength * 2];
+	size_t length = (size_t)MIN(size, (unsigned long long)sizeof(buffer));
+	TOMXXH64State state;
+	int hashError = 0;
+	
+	
+	TOMMetricsCount(TOMMetricsCounterOpenCalls, 1);
+	int descriptor = open(path, O_RDONLY | O_CLOEXEC);
+	
+	if (descriptor < 0)
+	{
+		return errno;
+	}
+	
+	
+	// A short read doesn't set errno, so a leftover value mustn't be mistaken for its cause
+	errno = 0;
+	
+	if (length < size)
+	{
+		TOMMetricsCount(TOMMetricsCounterReadCalls, 1);
+		
+		if (pread(descriptor, buffer, TOMDuplicatePartialLength, 0) != (ssize_t)TOMDuplicatePartialLength)
+		{
+			hashError = (errno != 0) ? errno : EIO;
+		}
+		else
+		{
+			TOMMetricsCount(TOMMetricsCounterReadCalls, 1);
+			
+			if (pread(descriptor, buffer + TOMDuplicatePartialLength, TOMDuplicatePartialLength, (off_t)(size - TOMDuplicatePartialLength)) != (ssize_t)TOMDuplicatePartialLength)
+			{
+				hashError = (errno != 0) ? errno : EIO;
+			}
+		}
+	}
+	else
+	{
+		TOMMetricsCount(TOMMetricsCounterReadCalls, 1);
+		
+		if (pread(descriptor, buffer, length, 0) != (ssize_t)length)
+		{
+			hashError = (errno != 0) ? errno : EIO;
+		}
+	}
+	
+	close(descriptor);
+	
+	
+	if (hashError == 0)
+	{
+		TOMMetricsCount(TOMMetricsCounterBytesRead, length);
+		
+		TOMXXH64Init(&state);
+		TOMXXH64Update(&state, buffer, length);
+		*hash = TOMXXH64Final(&state);
+	}
+	
+	return hashError;
+}
+
+
+
+
+/*
+ * TOMReplaceWithLink
+ *    Replaces the file at `duplicatePath` with a hard link to, or a clone of, the file at `originalPath`. The link is made
+ *    under a temporary name next to the duplicate and renamed over it, so the duplicate's path never stops existing. The
+ *    temporary name is unique, so one left behind by a crash can't get in the way.
+ *    Returns 0 on success, or the errno of the failure.
+ */
+static int TOMReplaceWithLink(const char *originalPath, const char *duplicatePath, TOMLinkType linkType)
+{
+	char temporaryPath[PATH_MAX];
+	const char *lastSlash = strrchr(duplicatePath, '/');
+	int directoryLength = (lastSlash == NULL) ? 0 : (int)(lastSlash - duplicatePath + 1);
+	int linkError = 0;
+	
+	
+	// A short name of its own, since the duplicate's name plus a suffix could pass NAME_MAX
+	if (snprintf(temporaryPath, sizeof(temporaryPath), "%.*s.TOMLink.XXXXXX", directoryLength, duplicatePath) >= (int)sizeof(temporaryPath))
+	{
+		return ENAMETOOLONG;
+	}
+	
+	TOMMetricsCount(TOMMetricsCounterOpenCalls, 1);
+	int temporaryDescriptor = mkstemp(temporaryPath);
+	
+	if (temporaryDescriptor < 0)
+	{
+		return errno;
+	}
+	
+	// Only the name is wanted - clonefile(2) and link(2) both need it to be free
+	close(temporaryDescriptor);
+	TOMMetricsCount(TOMMetricsCounterUnlinkCalls, 1);
+	unlink(temporaryPath);
+	
+	
+	if (linkType == TOMLinkTypeClone)
+	{
+		TOMMetricsCount(TOMMetricsCounterCloneCalls, 1);
+		
+		if (clonefile(originalPath, temporaryPath, CLONE_NOFOLLOW) != 0)
+		{
+			return errno;
+		}
+		
+		// A clone is a file of its own, so it can keep the duplicate's permissions, times and extended attributes
+		TOMMetricsCount(TOMMetricsCounterCopyfileCalls, 1);
+		copyfile(duplicatePath, temporaryPath, NULL, COPYFILE_METADATA);
+	}
+	else if (link(originalPath, temporaryPath) != 0)
+	{
+		return errno;
+	}
+	
+	
+	TOMMetricsCount(TOMMetricsCounterRenameCalls, 1);
+	
+	if (rename(temporaryPath, duplicatePath) != 0)
+	{
+		linkError = errno;
+		TOMMetricsCount(TOMMetricsCounterUnlinkCalls, 1);
+		unlink(temporaryPath);
+	}
+	
+	
+	return linkError;
+}
+
+
+
+
+
+/*
+ * TOMSyncDescriptor
+ *    Makes what was written through `descriptor` durable. On Darwin a plain fsync(2) only hands the data to the drive,
+ *    which may still hold it in its own cache when the power goes, so this asks for F_FULLFSYNC, which empties that cache
+ *    too. With `barrierOnly` it asks for F_BARRIERFSYNC instead, which only keeps the drive from writing anything issued
+ *    later ahead of it - enough when a full flush is coming anyway. File systems that support neither get an fsync.
+ *    Returns 0 on success, or the errno of the failure.
+ */
+static int TOMSyncDescriptor(int descriptor, BOOL barrierOnly)
+{
+#if defined(F_BARRIERFSYNC)
+	int command = barrierOnly ? F_BARRIERFSYNC : F_FULLFSYNC;
+#else
+	int command = F_FULLFSYNC;
+#endif
+	
+	
+	TOMMetricsCount(TOMMetricsCounterSyncCalls, 1);
+	
+	if (fcntl(descriptor, command) == 0)
+	{
+		return 0;
+	}
+	
+	if (errno != ENOTSUP && errno != ENOTTY && errno != EINVAL)
+	{
+		return errno;
+	}
+	
+	
+	TOMMetricsCount(TOMMetricsCounterSyncCalls, 1);
+	
+	return (fsync(descriptor) == 0) ? 0 : errno;
+}
+
+
+
+
+/*
+ * TOMSyncDirectory
+ *    Makes the entries of the directory at `directoryPath` durable, so a file renamed into it stays renamed after a crash.
+ *    Returns 0 on success, or the errno of the failure.
+ */
+static int TOMSyncDirectory(const char *directoryPath, BOOL barrierOnly)
+{
+	TOMMetricsCount(TOMMetricsCounterOpenCalls, 1);
+	int directoryDescriptor = open(directoryPath, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	
+	if (directoryDescriptor < 0)
+	{
+		return errno;
+	}
+	
+	
+	int syncError = TOMSyncDescriptor(directoryDescriptor, barrierOnly);
+	close(directoryDescriptor);
+	
+	return syncError;
+}
+
+
+
+
+/*
+ * TOMWriteFully
+ *    Writes all of `buffer`, retrying writes that are interrupted or only take part of it. Returns 0 on success, or the
+ *    errno of the failure.
+ */
+static int TOMWriteFully(int descriptor, const char *buffer, size_t length)
+{
+	size_t totalWritten = 0;
+	
+	
+	while (totalWritten < length)
+	{
+		TOMMetricsCount(TOMMetricsCounterWriteCalls, 1);
+		ssize_t bytesWritten = write(descriptor, buffer + totalWritten, length - totalWritten);
+		
+		if (bytesWritten < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			
+			TOMMetricsCount(TOMMetricsCounterBytesWritten, totalWritten);
+			
+			return errno;
+		}
+		
+		totalWritten += (size_t)bytesWritten;
+	}
+	
+	
+	TOMMetricsCount(TOMMetricsCounterBytesWritten, totalWritten);
+	
+	return 0;
+}
+
+
+
+
+/*
+ * TOMWriteFile
+ *    Writes `data` to the file at `path`, replacing whatever is there.
+ *
+ *    Without TOMWriteOptionsAtomic the file is truncated and written in place, and nothing is synced. With it, the data
+ *    goes to a temporary file next to `path`, which is synced, given the permissions of the file it replaces, and renamed
+ *    over it, so `path` holds either all of the old data or all of the new, even across a crash. The directory is then
+ *    synced to make the rename durable - except with TOMWriteOptionsGroupCommit, where the temporary file only gets a
+ *    barrier, and the caller is left to share the directory sync and the flush with other writes.
+ *    Returns 0 on success, or the errno of the failure.
+ */
+static int TOMWriteFile(const char *path, const char *directoryPath, NSData *data, TOMWriteOptions options)
+{
+	BOOL groupCommit = (options & TOMWriteOptionsGroupCommit) != 0;
+	char temporaryPath[PATH_MAX];
+	struct stat existingStat;
+	int writeError = 0;
+	
+	
+	if (!(options & (TOMWriteOptionsAtomic | TOMWriteOptionsGroupCommit)))
+	{
+		TOMMetricsCount(TOMMetricsCounterOpenCalls, 1);
+		int fileDescriptor = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, DEFFILEMODE);
+		
+		if (fileDescriptor < 0)
+		{
+			return errno;
+		}
+		
+		writeError = TOMWriteFully(fileDescriptor, [data bytes], [data length]);
+		
+		if (close(fileDescriptor) != 0 && writeError == 0)
+		{
+			writeError = errno;
+		}
+		
+		return writeError;
+	}
+	
+	
+	// A short name of its own in the same directory, since `path`'s name plus a suffix could pass NAME_MAX
+	if (snprintf(temporaryPath, sizeof(temporaryPath), "%s/.TOMWrite.XXXXXX", directoryPath) >= (int)sizeof(temporaryPath))
+	{
+		return ENAMETOOLONG;
+	}
+	
+	TOMMetricsCount(TOMMetricsCounterOpenCalls, 1);
+	int temporaryDescriptor = mkostemp(temporaryPath, O_CLOEXEC);
+	
+	if (temporaryDescriptor < 0)
+	{
+		return errno;
+	}
+	
+	
+	// mkostemp only lets the owner read its files, so take on the replaced file's permissions, or the usual ones for a new file
+	TOMMetricsCount(TOMMetricsCounterStatCalls, 1);
+	
+	if (stat(path, &existingStat) == 0)
+	{
+		fchmod(temporaryDescriptor, existingStat.st_mode & ALLPERMS);
+	}
+	else
+	{
+		fchmod(temporaryDescriptor, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+	}
+	
+	
+	writeError = TOMWriteFully(temporaryDescriptor, [data bytes], [data length]);
+	
+	if (writeError == 0)
+	{
+		writeError = TOMSyncDescriptor(temporaryDescriptor, groupCommit);
+	}
+	
+	if (close(temporaryDescriptor) != 0 && writeError == 0)
+	{
+		writeError = errno;
+	}
+	
+	
+	if (writeError == 0)
+	{
+		TOMMetricsCount(TOMMetricsCounterRenameCalls, 1);
+		
+		if (rename(temporaryPath, path) != 0)
+		{
+			writeError = errno;
+		}
+	}
+	
+	if (writeError != 0)
+	{
+		TOMMetricsCount(TOMMetricsCounterUnlinkCalls, 1);
+		unlink(temporaryPath);
+		
+		return writeError;
+	}
+	
+	
+	return groupCommit ? 0 : TOMSyncDirectory(directoryPath, NO);
+}
+
+
+
+
+
+/*
+ * TOMGroupCommit
+ *    Lets atomic writes that finish close together share the work of making them durable. A write syncs its own data with
+ *    a barrier, renames it into place, and then joins the open group with its directory and waits. The first write to join
+ *    a group schedules its flush on a serial queue, and the group closes once the flush starts. Writes that finish while an
+ *    earlier flush is running pile up in the next group, so the busier it gets, the more writes each flush covers.
+ *
+ *    A flush syncs each directory in its group once, then asks the drive to empty its cache once for all of them. If any
+ *    of that fails, every write in the group is told so, since none of them can be sure they are durable.
+ */
+@interface TOMCommitGroup : NSObject
+
+@property (nonatomic) NSMutableSet *directoryPaths;
+@property (nonatomic) dispatch_group_t flushed;
+@property (nonatomic) int error;
+
+@end
+
+
+
+
+@implementation TOMCommitGroup
+@end
+
+
+
+
+@interface TOMGroupCommit : NSObject
+
+- (int)commitDirectoryAtPath:(NSString *)directoryPath;
+
+@end
+
+
+
+
+@implementation TOMGroupCommit
+{
+	// The group new writes join, or nil if there is none. Only touched under `lock`.
+	TOMCommitGroup *openGroup;
+	
+	os_unfair_lock lock;
+	dispatch_queue_t queue;
+}
+
+
+
+
+- (id)init
+{
+	self = [super init];
+	
+	if (self)
+	{
+		lock = OS_UNFAIR_LOCK_INIT;
+		queue = dispatch_queue_create("TOMFileManager.commit", DISPATCH_QUEUE_SERIAL);
+	}
+	
+	return self;
+}
+
+
+
+
+- (int)commitDirectoryAtPath:(NSString *)directoryPath
+{
+	TOMCommitGroup *group = nil;
+	BOOL opened = NO;
+	
+	
+	os_unfair_lock_lock(&lock);
+	
+	if (openGroup == nil)
+	{
+		openGroup = [[TOMCommitGroup alloc] init];
+		openGroup.directoryPaths = [[NSMutableSet alloc] init];
+		openGroup.flushed = dispatch_group_create();
+		dispatch_group_enter(openGroup.flushed);
+		
+		opened = YES;
+	}
+	
+	group = openGroup;
+	[group.directoryPaths addObject:directoryPath];
+	
+	os_unfair_lock_unlock(&lock);
+	
+	
+	if (opened)
+	{
+		dispatch_async(queue, ^{
+			[self flushGroup:group];
+		});
+	}
+	
+	dispatch_group_wait(group.flushed, DISPATCH_TIME_FOREVER);
+	
+	return group.error;
+}
+
+
+
+
+- (void)flushGroup:(TOMCommitGroup *)group
+{
+	int flushError = 0;
+	int lastDescriptor = -1;
+	
+	
+	// Close the group before flushing it, so writes that finish from here on wait for the next flush
+	os_unfair_lock_lock(&lock);
+	
+	if (openGroup == group)
+	{
+		openGroup = nil;
+	}
+	
+	NSArray *directoryPaths = [group.directoryPaths allObjects];
+	
+	os_unfair_lock_unlock(&lock);
+	
+	
+	for (NSString *directoryPath in directoryPaths)
+	{
+		TOMMetricsCount(TOMMetricsCounterOpenCalls, 1);
+		int directoryDescriptor = open([directoryPath fileSystemRepresentation], O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		
+		if (directoryDescriptor < 0)
+		{
+			flushError = errno;
+			continue;
+		}
+		
+		int syncError = TOMSyncDescriptor(directoryDescriptor, YES);
+		
+		if (syncError != 0)
+		{
+			flushError = syncError;
+		}
+		
+		if (lastDescriptor >= 0)
+		{
+			close(lastDescriptor);
+		}
+		
+		lastDescriptor = directoryDescriptor;
+	}
+	
+	
+	// A full flush empties the drive's whole cache, so one covers every write in the group, in every directory
+	if (lastDescriptor >= 0)
+	{
+		int syncError = TOMSyncDescriptor(lastDescriptor, NO);
+		
+		if (syncError != 0 && flushError == 0)
+		{
+			flushError = syncError;
+		}
+		
+		close(lastDescriptor);
+	}
+	
+	
+	group.error = flushError;
+	dispatch_group_leave(group.flushed);
+}
+
+
+@end
+
+
+
+
+
+@interface TOMTransferReport ()
+
+@property (readwrite, nonatomic) NSUInteger numberOfFiles;
+@property (readwrite, nonatomic) unsigned long long numberOfBytes;
+@property (readwrite, nonatomic) NSTimeInterval duration;
+@property (readwrite, nonatomic) TOMCopyStrategy strategy;
+
+@end
+
+
+
+
+
+@implementation TOMTransferReport
+
+
+- (double)filesPerSecond
+{
+	return (_duration > 0) ? (double)_numberOfFiles / _duration : 0;
+}
+
+
+
+
+- (double)bytesPerSecond
+{
+	return (_duration > 0) ? (double)_numberOfBytes / _duration : 0;
+}
+
+
+
+
+- (NSString *)description
+{
+	NSString *description = [NSString stringWithFormat:@"%lu files, %llu bytes in %.3fs (%.0f files/s, %.0f bytes/s)", (unsigned long)_numberOfFiles, _numberOfBytes, _duration, [self filesPerSecond], [self bytesPerSecond]];
+	
+	
+	switch (_strategy)
+	{
+		case TOMCopyStrategyClone:
+			return [description stringByAppendingString:@", cloned"];
+		
+		case TOMCopyStrategyCopyfile:
+			return [description stringByAppendingString:@", recreated by copyfile"];
+		
+		case TOMCopyStrategyReadWrite:
+			return [description stringByAppendingString:@", copied by read/write"];
+		
+		default:
+			return description;
+	}
+}
+
+
+@end
+
+
+
+
+
+@interface TOMFileOperation ()
+
+@property (readwrite, nonatomic) TOMFileOperationType type;
+@property (readwrite, nonatomic) NSString *sourcePath;
+@property (readwrite, nonatomic, nullable) NSString *destinationDirectoryPath;
+
+@end
+
+
+
+
+
+@implementation TOMFileOperation
+
+
++ (instancetype)copyOperationFromPath:(NSString *)sourcePath to:(NSString *)destinationDirectoryPath
+{
+	TOMFileOperation *operation = [[TOMFileOperation alloc] init];
+	
+	operation.type = TOMFileOperationTypeCopy;
+	operation.sourcePath = [sourcePath stringByStandardizingPath];
+	operation.destinationDirectoryPath = [destinationDirectoryPath stringByStandardizingPath];
+	
+	return operation;
+}
+
+
+
+
++ (instancetype)moveOperationFromPath:(NSString *)sourcePath to:(NSString *)destinationDirectoryPath
+{
+	TOMFileOperation *operation = [[TOMFileOperation alloc] init];
+	
+	operation.type = TOMFileOperationTypeMove;
+	operation.sourcePath = [sourcePath stringByStandardizingPath];
+	operation.destinationDirectoryPath = [destinationDirectoryPath stringByStandardizingPath];
+	
+	return operation;
+}
+
+
+
+
++ (instancetype)deleteOperationAtPath:(NSString *)path
+{
+	TOMFileOperation *operation = [[TOMFileOperation alloc] init];
+	
+	operation.type = TOMFileOperationTypeDelete;
+	operation.sourcePath = [path stringByStandardizingPath];
+	
+	return operation;
+}
+
+
+@end
+
+
+
+
+
+@interface TOMBatchReport ()
+
+@property (readwrite, nonatomic) NSArray<NSNumber *> *results;
+@property (readwrite, nonatomic) NSUInteger numberOfSucceededOperations;
+@property (readwrite, nonatomic) NSUInteger numberOfFailedOperations;
+@property (readwrite, nonatomic) NSUInteger numberOfStages;
+@property (readwrite, nonatomic) NSTimeInterval duration;
+
+@end
+
+
+
+
+
+@implementation TOMBatchReport
+
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"%lu succeeded, %lu failed, in %lu stages and %.3fs", (unsigned long)_numberOfSucceededOperations, (unsigned long)_numberOfFailedOperations, (unsigned long)_numberOfStages, _duration];
+}
+
+
+@end
+
+
+
+
+
+@interface TOMDirectorySize ()
+
+@property (readwrite, nonatomic) unsigned long long logicalSize;
+@property (readwrite, nonatomic) unsigned long long allocatedSize;
+@property (readwrite, nonatomic) NSUInteger numberOfFiles;
+@property (readwrite, nonatomic) NSUInteger numberOfDirectories;
+
+@end
+
+
+
+
+
+@interface TOMSyncReport ()
+
+@property (readwrite, nonatomic) NSUInteger numberOfFilesCopied;
+@property (readwrite, nonatomic) unsigned long long numberOfBytesCopied;
+@property (readwrite, nonatomic) NSUInteger numberOfFilesSkipped;
+@property (readwrite, nonatomic) unsigned long long numberOfBytesSkipped;
+@property (readwrite, nonatomic) NSUInteger numberOfItemsDeleted;
+@property (readwrite, nonatomic) NSTimeInterval duration;
+
+@end
+
+
+
+
+
+@implementation TOMSyncReport
+
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"%lu files (%llu bytes) copied, %lu files (%llu bytes) already up to date, %lu items deleted, in %.3fs", (unsigned long)_numberOfFilesCopied, _numberOfBytesCopied, (unsigned long)_numberOfFilesSkipped, _numberOfBytesSkipped, (unsigned long)_numberOfItemsDeleted, _duration];
+}
+
+
+@end
+
+
+
+
+
+@implementation TOMDirectorySize
+
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"%llu bytes (%llu allocated) in %lu files and %lu directories", _logicalSize, _allocatedSize, (unsigned long)_numberOfFiles, (unsigned long)_numberOfDirectories];
+}
+
+
+@end
+
+
+
+
+
+@interface TOMBufferedFileWriter ()
+
+// The manager whose log level this logs at
+@property (weak, nonatomic) TOMFileManager *manager;
+
+- (id)initWithFileDescriptor:(int)descriptor filePath:(NSString *)filePath bufferSize:(NSUInteger)bufferSize flushInterval:(NSTimeInterval)flushInterval changeHandler:(void (^)(void))handler;
+
+@end
+
+
+
+
+
+@implementation TOMBufferedFileWriter
+{
+	// Only touched under `lock`, which is also held across the write of a flush, so records reach the file in the order
+	// they were appended and are never split between two writes
+	char *buffer;
+	size_t bufferedLength;
+	int fileDescriptor;
+	BOOL flushScheduled;
+	
+	os_unfair_lock lock;
+	void (^changeHandler)(void);
+}
+
+
+
+
+- (id)initWithFileDescriptor:(int)descriptor filePath:(NSString *)filePath bufferSize:(NSUInteger)bufferSize flushInterval:(NSTimeInterval)flushInterval changeHandler:(void (^)(void))handler
+{
+	self = [super init];
+	
+	if (self)
+	{
+		buffer = malloc(bufferSize);
+		
+		if (buffer == NULL)
+		{
+			close(descriptor);
+			return nil;
+		}
+		
+		_filePath = filePath;
+		_bufferSize = bufferSize;
+		_flushInterval = flushInterval;
+		fileDescriptor = descriptor;
+		lock = OS_UNFAIR_LOCK_INIT;
+		changeHandler = handler;
+	}
+	
+	return self;
+}
+
+
+
+
+- (void)dealloc
+{
+	[self close];
+}
+
+
+
+
+- (BOOL)appendData:(NSData *)data
+{
+	return [self appendBytes:[data bytes] length:[data length]];
+}
+
+
+
+
+- (BOOL)appendString:(NSString *)string
+{
+	if (string == nil)
+	{
+		return NO;
+	}
+	
+	
+	// The length comes from the string, since UTF-8 can hold a NUL that strlen would stop at
+	return [self appendBytes:[string UTF8String] length:[string lengthOfBytesUsingEncoding:NSUTF8StringEncoding]];
+}
+
+
+
+
+- (BOOL)flush
+{
+	int flushError = 0;
+	BOOL wrote = NO;
+	
+	
+	os_unfair_lock_lock(&lock);
+	
+	if (fileDescriptor >= 0 && bufferedLength > 0)
+	{
+		flushError = [self writeBufferedData];
+		wrote = YES;
+	}
+	
+	os_unfair_lock_unlock(&lock);
+	
+	
+	return [self finishWriting:wrote error:flushError];
+}
+
+
+
+
+- (BOOL)synchronize
+{
+	int syncError = 0;
+	BOOL wrote = NO;
+	
+	
+	os_unfair_lock_lock(&lock);
+	
+	if (fileDescriptor < 0)
+	{
+		syncError = EBADF;
+	}
+	else
+	{
+		if (bufferedLength > 0)
+		{
+			syncError = [self writeBufferedData];
+			wrote = YES;
+		}
+		
+		if (syncError == 0)
+		{
+			syncError = TOMSyncDescriptor(fileDescriptor, NO);
+		}
+	}
+	
+	os_unfair_lock_unlock(&lock);
+	
+	
+	return [self finishWriting:wrote error:syncError];
+}
+
+
+
+
+- (BOOL)close
+{
+	int closeError = 0;
+	BOOL wrote = NO;
+	
+	
+	os_unfair_lock_lock(&lock);
+	
+	if (fileDescriptor >= 0)
+	{
+		if (bufferedLength > 0)
+		{
+			closeError = [self writeBufferedData];
+			wrote = YES;
+		}
+		
+		if (close(fileDescriptor) != 0 && closeError == 0)
+		{
+			closeError = errno;
+		}
+		
+		fileDescriptor = -1;
+		
+		free(buffer);
+		buffer = NULL;
+	}
+	
+	os_unfair_lock_unlock(&lock);
+	
+	
+	return [self finishWriting:wrote error:closeError];
+}
+
+
+
+
+- (BOOL)appendBytes:(const char *)bytes length:(size_t)length
+{
+	int appendError = 0;
+	BOOL wrote = NO;
+	BOOL scheduleFlush = NO;
+	
+	
+	os_unfair_lock_lock(&lock);
+	
+	if (fileDescriptor < 0)
+	{
+		appendError = EBADF;
+	}
+	else
+	{
+		// Make room first, so the record goes out whole in the next write rather than split across two
+		if (bufferedLength + length > _bufferSize)
+		{
+			appendError = [self writeBufferedData];
+			wrote = YES;
+		}
+		
+		
+		if (appendError == 0 && length >= _bufferSize)
+		{
+			// Buffering a record this big would only copy it, so it is written straight through
+			appendError = TOMWriteFully(fileDescriptor, bytes, length);
+			wrote = YES;
+		}
+		else if (appendError == 0)
+		{
+			memcpy(buffer + bufferedLength, bytes, length);
+			bufferedLength += length;
+			
+			if (bufferedLength == _bufferSize)
+			{
+				appendError = [self writeBufferedData];
+				wrote = YES;
+			}
+			else if (!flushScheduled && bufferedLength > 0 && _flushInterval > 0)
+			{
+				flushScheduled = YES;
+				scheduleFlush = YES;
+			}
+		}
+	}
+	
+	os_unfair_lock_unlock(&lock);
+	
+	
+	if (scheduleFlush)
+	{
+		__weak TOMBufferedFileWriter *weakSelf = self;
+		
+		dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(_flushInterval * NSEC_PER_SEC)), dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+			[weakSelf flush];
+		});
+	}
+	
+	return [self finishWriting:wrote error:appendError];
+}
+
+
+
+
+/*
+ * Writes out and empties the buffer. Must be called under `lock`. Whatever was buffered is dropped even if the write
+ * fails, so a file that can't be written to doesn't keep the writer's memory growing. Returns 0 on success, or the errno
+ * of the failure.
+ */
+- (int)writeBufferedData
+{
+	size_t length = bufferedLength;
+	
+	bufferedLength = 0;
+	flushScheduled = NO;
+	
+	
+	return TOMWriteFully(fileDescriptor, buffer, length);
+}
+
+
+
+
+/*
+ * Reports what a call did once `lock` is released: the file changed if anything was written, and a failure is logged.
+ */
+- (BOOL)finishWriting:(BOOL)wrote error:(int)writeError
+{
+	if (wrote && changeHandler != nil)
+	{
+		changeHandler();
+	}
+	
+	if (writeError != 0)
+	{
+		TOMLogForManager(_manager, TOMLogLevelError, @"[TOMFileManager] ERROR: Could not write to file: '%@'.\n   RESULTING ERROR: %s", _filePath, strerror(writeError));
+		
+		return NO;
+	}
+	
+	return YES;
+}
+
+
+@end
+
+
+
+
+
+/*
+ * TOMPathListsOverlap
+ *    Whether any path in `paths` is the same as, inside of, or contains any path in `otherPaths`. Two batch operations that
+ *    overlap this way can't run at the same time. Paths must already be standardized.
+ */
+static BOOL TOMPathListsOverlap(NSArray *paths, NSArray *otherPaths)
+{
+	for (NSString *path in paths)
+	{
+		for (NSString *otherPath in otherPaths)
+		{
+			NSString *shorterPath = ([path length] <= [otherPath length]) ? path : otherPath;
+			NSString *longerPath = (shorterPath == path) ? otherPath : path;
+			
+			if ([longerPath hasPrefix:shorterPath] && ([longerPath length] == [shorterPath length] || [longerPath characterAtIndex:[shorterPath length]] == '/' || [shorterPath isEqualToString:@"/"]))
+			{
+				return YES;
+			}
+		}
+	}
+	
+	
+	return NO;
+}
+
+
+typedef struct TOMResolvedPath
+{
+	BOOL exists;
+	BOOL isDirectory;
+	BOOL isReadable;
+} TOMResolvedPath;
+
+
+
+
+
+@implementation TOMFileManager
+{
+	TOMFilenameIndex *filenameIndex;
+	
+	TOMMetadataCache *metadataCache;
+	
+	TOMDirectorySizeCache *directorySizeCache;
+	
+	NSMutableArray *directoryWatches;
+	
+	TOMGroupCommit *groupCommit;
+	
+	NSOperationQueue *operationQueue;
+}
+
+
+
+
+- (id)init
+{
+	_logLevel = TOMLogLevelError;
+	
+	
+	NSArray *paths = NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES);
+	_documentsDirectory = [paths objectAtIndex:0];
+	
+	
+	_resourcesDirectory = [[NSBundle mainBundle]resourcePath];
+	
+	
+	paths = NSSearchPathForDirectoriesInDomains(NSLibraryDirectory, NSUserDomainMask, YES);
+	_libraryDirectory = [paths objectAtIndex:0];
+	
+	
+	_tempDirectory = [[[NSFileManager defaultManager] temporaryDirectory] path];
+	
+	
+	directorySizeCache = [[TOMDirectorySizeCache alloc] init];
+	directoryWatches = [[NSMutableArray alloc] init];
+	groupCommit = [[TOMGroupCommit alloc] init];
+	
+	
+	operationQueue = [[NSOperationQueue alloc] init];
+	operationQueue.name = @"TOMFileManager.operations";
+	operationQueue.qualityOfService = NSQualityOfServiceUtility;
+	operationQueue.maxConcurrentOperationCount = TOMDefaultMaximumConcurrentOperations;
+	
+	
+	// Finish purging whatever an earlier run deferred but didn't get to
+	[self schedulePurge];
+	
+	
+	return self;
+}
+
+
+
+
+- (BOOL)createDirectoryAtPath:(nonnull NSString *)newDirectoryPath
+{
+	TOMMetricsMeasure(TOMMetricsMethodCreateDirectory);
+	
+	NSError *error;
+	
+	
+	if (![self metadataForPath:newDirectoryPath].exists)
+	{
+		TOMLogInfo(@"[TOMFileManager] INFO: Creating directory: '%@'.", newDirectoryPath);
+		
+		[[NSFileManager defaultManager] createDirectoryAtPath:newDirectoryPath withIntermediateDirectories:NO attributes:nil error:&error];
+		
+		if (error)
+		{
+			TOMLogError(@"[TOMFileManager] ERROR: Could not create directory: '%@'.", newDirectoryPath);
+			TOMLogError(@"   RESULTING ERROR: %@", error);
+			
+			return NO;
+		}
+		
+		[self noteChangeAtPath:newDirectoryPath];
+		
+		return YES;
+	}
+	else
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not create directory: '%@'.", newDirectoryPath);
+		
+		TOMLogDebug(@"   MOST LIKELY REASON: Directory already exists.");
+		
+		return NO;
+	}
+	
+	
+	return NO;
+}
+
+
+
+
+- (BOOL)createSubdirectoryNamed:(nonnull NSString *)subdirectoryName in:(nonnull NSString *)existingDirectoryPath
+{
+	NSString *correctedSubdirectoryName;
+	
+	
+	correctedSubdirectoryName = subdirectoryName;
+	if ([correctedSubdirectoryName hasPrefix:@"/"])
+	{
+		correctedSubdirectoryName = [correctedSubdirectoryName substringFromIndex:1];
+	}
+	
+	
+	NSString *newDirectoryPath = [existingDirectoryPath stringByAppendingPathComponent:correctedSubdirectoryName];
+	
+	
+	return [self createDirectoryAtPath:newDirectoryPath];
+}
+
+
+
+
+- (BOOL)copyDirectoryFrom:(nonnull NSString *)sourceDirectoryPath to:(nonnull NSString *)destinationDirectoryPath
+{
+	return [self copyDirectoryFrom:sourceDirectoryPath to:destinationDirectoryPath regardlessOfType:NO];
+}
+
+
+
+
+- (BOOL)copyDirectoryFrom:(NSString *)sourceDirectoryPath to:(NSString *)destinationDirectoryPath report:(TOMTransferReport **)report
+{
+	return [self copyDirectoryFrom:sourceDirectoryPath to:destinationDirectoryPath regardlessOfType:NO report:report];
+}
+
+
+
+
+- (BOOL)copyDirectoryFrom:(nonnull NSString *)sourceDirectoryPath to:(nonnull NSString *)destinationDirectoryPath regardlessOfType:(BOOL)ignoreType
+{
+	return [self copyDirectoryFrom:sourceDirectoryPath to:destinationDirectoryPath regardlessOfType:ignoreType report:NULL];
+}
+
+
+
+
+- (BOOL)copyDirectoryFrom:(NSString *)sourceDirectoryPath to:(NSString *)destinationDirectoryPath regardlessOfType:(BOOL)ignoreType report:(TOMTransferReport **)report
+{
+	TOMMetricsMeasure(TOMMetricsMethodCopyDirectory);
+	
+	NSError *error;
+	BOOL sourceIsDirectory = false;
+	
+	
+	if ([[NSFileManager defaultManager] fileExistsAtPath:sourceDirectoryPath isDirectory:&sourceIsDirectory])
+	{
+		if (sourceIsDirectory)
+		{
+			if (TOMPathListsOverlap(@[[sourceDirectoryPath stringByStandardizingPath]], @[[destinationDirectoryPath stringByStandardizingPath]]))
+			{
+				TOMLogError(@"[TOMFileManager] ERROR: Could not copy directory: '%@'.", sourceDirectoryPath);
+				
+				TOMLogDebug(@"   MOST LIKELY REASON: One directory is inside the other.");
+				
+				return NO;
+			}
+			
+			TOMLogInfo(@"[TOMFileManager] INFO: Copying contents of directory: '%@'.\nTo directory: '%@'.", sourceDirectoryPath, destinationDirectoryPath);
+			
+			if (![self performTransferOfDirectoryAtPath:sourceDirectoryPath toPath:destinationDirectoryPath removingSource:NO resuming:NO report:report])
+			{
+				return NO;
+			}
+			
+			[self noteChangeAtPath:destinationDirectoryPath];
+			
+			return YES;
+		}
+		else
+		{
+			if (ignoreType)
+			{
+				TOMLogInfo(@"[TOMFileManager] INFO: Copying contents of directory: '%@'.\nTo directory: '%@'.", sourceDirectoryPath, destinationDirectoryPath);
+				
+				[[NSFileManager defaultManager] copyItemAtPath:sourceDirectoryPath toPath:destinationDirectoryPath error:&error];
+				
+				if (error)
+				{
+					TOMLogError(@"[TOMFileManager] ERROR: Could not copy directory: '%@'.", sourceDirectoryPath);
+					TOMLogError(@"   RESULTING ERROR: %@", error);
+					
+					return NO;
+				}
+				
+				[self noteChangeAtPath:destinationDirectoryPath];
+				
+				return YES;
+			}
+			else
+			{
+				TOMLogError(@"[TOMFileManager] ERROR: Could not copy directory: '%@'.", sourceDirectoryPath);
+				
+				TOMLogDebug(@"   MOST LIKELY REASON: Source is not a directory.");
+				
+				return NO;
+			}
+		}
+	}
+	else
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not copy directory: '%@'.", sourceDirectoryPath);
+		
+		TOMLogDebug(@"   MOST LIKELY REASON: Directory does not exist.");
+		
+		return NO;
+	}
+}
+
+
+
+
+- (BOOL)syncDirectoryFrom:(NSString *)sourceDirectoryPath to:(NSString *)destinationDirectoryPath options:(TOMSyncOptions)options report:(TOMSyncReport **)report
+{
+	TOMMetricsMeasure(TOMMetricsMethodSyncDirectory);
+	
+	TOMFileMetadata sourceMetadata = [self metadataForPath:sourceDirectoryPath];
+	TOMFileMetadata destinationMetadata = [self metadataForPath:destinationDirectoryPath];
+	
+	
+	if (!sourceMetadata.isDirectory)
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not sync directory: '%@'.", sourceDirectoryPath);
+		
+		TOMLogDebug(sourceMetadata.exists ? @"   MOST LIKELY REASON: Source is not a directory." : @"   MOST LIKELY REASON: Directory does not exist.");
+		
+		return NO;
+	}
+	
+	if (destinationMetadata.exists && !destinationMetadata.isDirectory)
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not sync directory: '%@'.", sourceDirectoryPath);
+		
+		TOMLogDebug(@"   MOST LIKELY REASON: Destination is not a directory.");
+		
+		return NO;
+	}
+	
+	if (TOMPathListsOverlap(@[[sourceDirectoryPath stringByStandardizingPath]], @[[destinationDirectoryPath stringByStandardizingPath]]))
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not sync directory: '%@'.", sourceDirectoryPath);
+		
+		TOMLogDebug(@"   MOST LIKELY REASON: One directory is inside the other.");
+		
+		return NO;
+	}
+	
+	
+	TOMLogInfo(@"[TOMFileManager] INFO: Syncing contents of directory: '%@'.\nTo directory: '%@'.", sourceDirectoryPath, destinationDirectoryPath);
+	
+	BOOL synced = [self performSyncOfDirectoryAtPath:sourceDirectoryPath toPath:destinationDirectoryPath options:options report:report];
+	
+	// Even a failed sync may have changed part of the destination
+	[self noteChangeAtPath:destinationDirectoryPath];
+	
+	return synced;
+}
+
+
+
+
+- (BOOL)moveDirectoryFrom:(nonnull NSString *)sourceDirectoryPath to:(nonnull NSString *)destinationDirectoryPath
+{
+	return [self moveDirectoryFrom:sourceDirectoryPath to:destinationDirectoryPath regardlessOfType:NO];
+}
+
+
+
+
+- (BOOL)moveDirectoryFrom:(NSString *)sourceDirectoryPath to:(NSString *)destinationDirectoryPath report:(TOMTransferReport **)report
+{
+	return [self moveDirectoryFrom:sourceDirectoryPath to:destinationDirectoryPath regardlessOfType:NO report:report];
+}
+
+
+
+
+- (BOOL)moveDirectoryFrom:(nonnull NSString *)sourceDirectoryPath to:(nonnull NSString *)destinationDirectoryPath regardlessOfType:(BOOL)ignoreType
+{
+	return [self moveDirectoryFrom:sourceDirectoryPath to:destinationDirectoryPath regardlessOfType:ignoreType report:NULL];
+}
+
+
+
+
+- (BOOL)moveDirectoryFrom:(NSString *)sourceDirectoryPath to:(NSString *)destinationDirectoryPath regardlessOfType:(BOOL)ignoreType report:(TOMTransferReport **)report
+{
+	TOMMetricsMeasure(TOMMetricsMethodMoveDirectory);
+	
+	BOOL sourceIsDirectory = false;
+	
+	
+	if ([[NSFileManager defaultManager] fileExistsAtPath:sourceDirectoryPath isDirectory:&sourceIsDirectory])
+	{
+		if (sourceIsDirectory)
+		{
+			TOMLogInfo(@"[TOMFileManager] INFO: Moving contents of directory: '%@'.\nTo directory: '%@'.", sourceDirectoryPath, destinationDirectoryPath);
+			
+			if (![self performMoveOfItemAtPath:sourceDirectoryPath toPath:destinationDirectoryPath report:report])
+			{
+				return NO;
+			}
+			
+			[self noteChangeAtPath:sourceDirectoryPath];
+			[self noteChangeAtPath:destinationDirectoryPath];
+			
+			return YES;
+		}
+		else
+		{
+			if (ignoreType)
+			{
+				TOMLogInfo(@"[TOMFileManager] INFO: Moving contents of directory: '%@'.\nTo directory: '%@'.", sourceDirectoryPath, destinationDirectoryPath);
+				
+				if (![self performMoveOfItemAtPath:sourceDirectoryPath toPath:destinationDirectoryPath report:report])
+				{
+					return NO;
+				}
+				
+				[self noteChangeAtPath:sourceDirectoryPath];
+				[self noteChangeAtPath:destinationDirectoryPath];
+				
+				return YES;
+			}
+			else
+			{
+				TOMLogError(@"[TOMFileManager] ERROR: Could not move directory: '%@'.", sourceDirectoryPath);
+				
+				TOMLogDebug(@"   MOST LIKELY REASON: Source is not a directory.");
+				
+				return NO;
+			}
+		}
+	}
+	else
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not move directory: '%@'.", sourceDirectoryPath);
+		
+		TOMLogDebug(@"   MOST LIKELY REASON: Directory does not exist.");
+		
+		return NO;
+	}
+}
+
+
+
+
+- (BOOL)resumeInterruptedMoves
+{
+	NSString *journalDirectory = [self moveJournalDirectory];
+	NSArray *journalNames = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:journalDirectory error:nil];
+	BOOL succeeded = YES;
+	
+	
+	for (NSString *journalName in journalNames)
+	{
+		NSString *journalPath = [journalDirectory stringByAppendingPathComponent:journalName];
+		NSDictionary *journal = [NSDictionary dictionaryWithContentsOfFile:journalPath];
+		NSString *sourcePath = [journal objectForKey:@"Source"];
+		NSString *destinationPath = [journal objectForKey:@"Destination"];
+		struct stat sourceStat;
+		
+		
+		// Either not a journal, or the move finished everything but removing its journal
+		if (sourcePath == nil || destinationPath == nil || lstat([sourcePath fileSystemRepresentation], &sourceStat) != 0)
+		{
+			[[NSFileManager defaultManager] removeItemAtPath:journalPath error:nil];
+			continue;
+		}
+		
+		
+		TOMLogInfo(@"[TOMFileManager] INFO: Resuming move of: '%@'.\nTo: '%@'.", sourcePath, destinationPath);
+		
+		if ([self performMoveOfItemAtPath:sourcePath toPath:destinationPath report:NULL])
+		{
+			[self noteChangeAtPath:sourcePath];
+			[self noteChangeAtPath:destinationPath];
+		}
+		else
+		{
+			TOMLogError(@"[TOMFileManager] ERROR: Could not resume move of: '%@'.", sourcePath);
+			succeeded = NO;
+		}
+	}
+	
+	
+	return succeeded;
+}
+
+
+
+
+- (BOOL)renameDirectoryAtPath:(nonnull NSString *)directoryPath to:(nonnull NSString *)newName
+{
+	return [self renameDirectoryAtPath:directoryPath to:newName regardlessOfType:NO];
+}
+
+
+
+
+- (BOOL)renameDirectoryAtPath:(nonnull NSString *)directoryPath to:(nonnull NSString *)newName regardlessOfType:(BOOL)ignoreType
+{
+	return [self renameDirectoryAtPath:directoryPath to:newName regardlessOfType:ignoreType options:TOMRenameOptionsNoReplace];
+}
+
+
+
+
+- (BOOL)renameDirectoryAtPath:(NSString *)directoryPath to:(NSString *)newName options:(TOMRenameOptions)options
+{
+	return [self renameDirectoryAtPath:directoryPath to:newName regardlessOfType:NO options:options];
+}
+
+
+
+
+- (BOOL)renameDirectoryAtPath:(NSString *)directoryPath to:(NSString *)newName regardlessOfType:(BOOL)ignoreType options:(TOMRenameOptions)options
+{
+	TOMMetricsMeasure(TOMMetricsMethodRenameDirectory);
+	
+	BOOL sourceIsDirectory = false;
+	unsigned int renameFlags = 0;
+	
+	NSString *pathOfNewName;
+	
+	
+	
+	if (![newName hasPrefix:@"/"])
+	{
+		pathOfNewName = [[directoryPath stringByDeletingLastPathComponent] stringByAppendingPathComponent:newName];
+	}
+	else
+	{
+		pathOfNewName = [[directoryPath stringByDeletingLastPathComponent] stringByAppendingString:newName];
+	}
+	
+	
+	if (options & TOMRenameOptionsNoReplace)
+	{
+		renameFlags |= RENAME_EXCL;
+	}
+	
+	if (options & TOMRenameOptionsExchange)
+	{
+		renameFlags |= RENAME_SWAP;
+	}
+	
+	
+	if ([[NSFileManager defaultManager] fileExistsAtPath:directoryPath isDirectory:&sourceIsDirectory])
+	{
+		if (sourceIsDirectory || ignoreType)
+		{
+			TOMLogInfo(@"[TOMFileManager] INFO: Renaming directory: '%@'.\nTo: '%@'.", directoryPath, pathOfNewName);
+			
+			// One system call, so the directory is never half renamed and nothing is ever copied
+			TOMMetricsCount(TOMMetricsCounterRenameCalls, 1);
+			if (renamex_np([directoryPath fileSystemRepresentation], [pathOfNewName fileSystemRepresentation], renameFlags) != 0)
+			{
+				int renameError = errno;
+				
+				TOMLogError(@"[TOMFileManager] ERROR: Could not rename directory: '%@'.", directoryPath);
+				TOMLogError(@"   RESULTING ERROR: %s", strerror(renameError));
+				
+				if (renameError == EEXIST)
+				{
+					TOMLogDebug(@"   MOST LIKELY REASON: Something named '%@' already exists.", newName);
+				}
+				else if (renameError == ENOENT && (options & TOMRenameOptionsExchange))
+				{
+					TOMLogDebug(@"   MOST LIKELY REASON: There is nothing named '%@' to exchange with.", newName);
+				}
+				
+				return NO;
+			}
+			
+			[self noteChangeAtPath:directoryPath];
+			[self noteChangeAtPath:pathOfNewName];
+			
+			return YES;
+		}
+		else
+		{
+			TOMLogError(@"[TOMFileManager] ERROR: Could not rename directory: '%@'.", directoryPath);
+			
+			TOMLogDebug(@"   MOST LIKELY REASON: Source is not a directory.");
+			
+			return NO;
+		}
+	}
+	else
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not rename directory: '%@'.", directoryPath);
+		
+		TOMLogDebug(@"   MOST LIKELY REASON: Directory does not exist.");
+		
+		return NO;
+	}
+}
+
+
+
+
+- (BOOL)deleteDirectory:(nonnull NSString *)directoryPath
+{
+	return [self deleteDirectory:directoryPath regardlessOfType:NO];
+}
+
+
+
+
+- (BOOL)deleteDirectory:(NSString *)directoryPath mode:(TOMDeleteMode)mode
+{
+	BOOL sourceIsDirectory = false;
+	
+	
+	if (mode == TOMDeleteModeStandard)
+	{
+		return [self deleteDirectory:directoryPath regardlessOfType:NO];
+	}
+	
+	TOMMetricsMeasure(TOMMetricsMethodDeleteDirectory);
+	
+	
+	if ([[NSFileManager defaultManager] fileExistsAtPath:directoryPath isDirectory:&sourceIsDirectory] && sourceIsDirectory)
+	{
+		TOMLogInfo(@"[TOMFileManager] INFO: Deleting directory (%@): '%@'.\n", (mode == TOMDeleteModeDeferred) ? @"deferred" : @"parallel", directoryPath);
+		
+		if (mode == TOMDeleteModeDeferred)
+		{
+			if (![self performDeferredRemovalOfDirectoryAtPath:directoryPath])
+			{
+				return NO;
+			}
+		}
+		else
+		{
+			if (![self performParallelRemovalOfDirectoryAtPath:directoryPath])
+			{
+				return NO;
+			}
+		}
+		
+		[self noteChangeAtPath:directoryPath];
+		
+		return YES;
+	}
+	else
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not delete directory: '%@'.", directoryPath);
+		
+		TOMLogDebug(@"   MOST LIKELY REASON: Directory does not exist, or it is not a directory.");
+		
+		return NO;
+	}
+}
+
+
+
+
+- (BOOL)deleteDirectory:(nonnull NSString *)directoryPath regardlessOfType:(BOOL)ignoreType
+{
+	TOMMetricsMeasure(TOMMetricsMethodDeleteDirectory);
+	
+	NSError *error;
+	BOOL sourceIsDirectory = false;
+	
+	
+	if ([[NSFileManager defaultManager] fileExistsAtPath:directoryPath isDirectory:&sourceIsDirectory])
+	{
+		if (sourceIsDirectory)
+		{
+			TOMLogInfo(@"[TOMFileManager] INFO: Deleting directory: '%@'.\n", directoryPath);
+			
+			[[NSFileManager defaultManager] removeItemAtPath:directoryPath error:&error];
+			
+			if (error)
+			{
+				TOMLogError(@"[TOMFileManager] ERROR: Could not delete directory: '%@'.", directoryPath);
+				TOMLogError(@"   RESULTING ERROR: %@", error);
+				
+				return NO;
+			}
+			
+			[self noteChangeAtPath:directoryPath];
+			
+			return YES;
+		}
+		else
+		{
+			if (ignoreType)
+			{
+				TOMLogInfo(@"[TOMFileManager] INFO: Deleting directory: '%@'.\n", directoryPath);
+				
+				[[NSFileManager defaultManager] removeItemAtPath:directoryPath error:&error];
+				
+				if (error)
+				{
+					TOMLogError(@"[TOMFileManager] ERROR: Could not delete directory: '%@'.", directoryPath);
+					TOMLogError(@"   RESULTING ERROR: %@", error);
+					
+					return NO;
+				}
+				
+				[self noteChangeAtPath:directoryPath];
+				
+				return YES;
+			}
+			else
+			{
+				TOMLogError(@"[TOMFileManager] ERROR: Could not delete directory: '%@'.", directoryPath);
+				
+				TOMLogDebug(@"   MOST LIKELY REASON: It is not a directory.");
+				
+				return NO;
+			}
+		}
+	}
+	else
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not delete directory: '%@'.", directoryPath);
+		
+		TOMLogDebug(@"   MOST LIKELY REASON: Directory does not exist.");
+		
+		return NO;
+	}
+}
+
+
+
+
+- (NSString *)getPathForFileNamed:(NSString *)filename inDirectory:(NSString *)directoryPath
+{
+	TOMMetricsMeasure(TOMMetricsMethodGetPathForFile);
+	
+	BOOL isDirectory = false;
+	if ([[NSFileManager defaultManager] fileExistsAtPath:directoryPath isDirectory:&isDirectory])
+	{
+		if (!isDirectory)
+		{
+			TOMLogError(@"[TOMFileManager] ERROR: Search Location is not a directory.");
+			return nil;
+		}
+	}
+	else
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Search Location does not exist.");
+		return nil;
+	}
+	
+	
+	TOMLogInfo(@"[TOMFileManager] INFO: Retrieving file: '%@'.\nFrom directory: '%@'.", filename, directoryPath);
+	
+	
+	NSString *foundPath = [self searchDirectories:@[directoryPath] forFileNamed:filename];
+	
+	if (foundPath == nil)
+	{
+		TOMLogError(@"ERROR: File Not Found In Directory");
+	}
+	
+	return foundPath;
+}
+
+
+
+
+- (NSString *)findAndGetPathForFileNamed:(NSString *)filename
+{
+	TOMMetricsMeasure(TOMMetricsMethodFindAndGetPathForFile);
+	
+	if (filenameIndex != nil)
+	{
+		TOMLogInfo(@"[TOMFileManager] INFO: Looking up file in filename index: '%@'.", filename);
+		
+		NSString *indexedPath = [filenameIndex pathForFileNamed:filename];
+		
+		if (indexedPath == nil)
+		{
+			TOMLogError(@"ERROR: File Not Found In Directory");
+		}
+		
+		return indexedPath;
+	}
+	
+	
+	TOMLogInfo(@"[TOMFileManager] INFO: Searching Documents, Resources, Library, and Temp Directories for file: '%@'.", filename);
+	
+	
+	// The order of the roots is the order of precedence when the file exists in more than one of them
+	NSArray *rootPaths = @[[self documentsDirectory], [self resourcesDirectory], [self libraryDirectory], [self tempDirectory]];
+	NSString *foundPath = [self searchDirectories:rootPaths forFileNamed:filename];
+	
+	if (foundPath == nil)
+	{
+		TOMLogError(@"ERROR: File Not Found In Directory");
+	}
+	else
+	{
+		TOMLogInfo(@"[TOMFileManager] INFO: File found at path: '%@'.", foundPath);
+	}
+	
+	return foundPath;
+}
+
+
+
+
+- (NSDictionary<NSString *, NSString *> *)findAndGetPathsForFileNames:(NSSet<NSString *> *)filenames
+{
+	TOMMetricsMeasure(TOMMetricsMethodFindAndGetPathsForFiles);
+	
+	NSArray *filenameList = [filenames allObjects];
+	NSDictionary *foundPaths;
+	
+	
+	if ([filenameList count] == 0)
+	{
+		return @{};
+	}
+	
+	
+	if (filenameIndex != nil)
+	{
+		TOMLogInfo(@"[TOMFileManager] INFO: Looking up %lu files in filename index.", (unsigned long)[filenameList count]);
+		
+		foundPaths = [filenameIndex pathsForFileNames:filenameList];
+	}
+	else
+	{
+		TOMLogInfo(@"[TOMFileManager] INFO: Searching Documents, Resources, Library, and Temp Directories for %lu files.", (unsigned long)[filenameList count]);
+		
+		NSArray *rootPaths = @[[self documentsDirectory], [self resourcesDirectory], [self libraryDirectory], [self tempDirectory]];
+		foundPaths = [self searchDirectories:rootPaths forFilesNamed:filenameList];
+	}
+	
+	
+	if ([foundPaths count] < [filenameList count])
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not find %lu of %lu files.", (unsigned long)([filenameList count] - [foundPaths count]), (unsigned long)[filenameList count]);
+		
+		if (TOMLogEnabled(TOMLogLevelInfo))
+		{
+			for (NSString *filename in filenameList)
+			{
+				if ([foundPaths objectForKey:filename] == nil)
+				{
+					TOMLogInfo(@"   FILE NOT FOUND: '%@'.", filename);
+				}
+			}
+		}
+	}
+	
+	return foundPaths;
+}
+
+
+
+
+- (BOOL)enumerateFilesMatchingPattern:(NSString *)pattern inDirectory:(NSString *)directoryPath options:(TOMFileSearchOptions)options usingBlock:(void (^)(NSString *filePath, BOOL *stop))block
+{
+	return [self enumerateFilesMatchingPattern:pattern inDirectory:directoryPath options:options maximumDepth:NSUIntegerMax maximumResults:NSUIntegerMax usingBlock:block];
+}
+
+
+
+
+- (BOOL)enumerateFilesMatchingPattern:(NSString *)pattern inDirectory:(NSString *)directoryPath options:(TOMFileSearchOptions)options maximumDepth:(NSUInteger)maximumDepth maximumResults:(NSUInteger)maximumResults usingBlock:(void (^)(NSString *filePath, BOOL *stop))block
+{
+	TOMMetricsMeasure(TOMMetricsMethodEnumerateFiles);
+	
+	BOOL isDirectory = false;
+	BOOL useRegularExpression = (options & TOMFileSearchOptionsRegularExpression) != 0;
+	BOOL caseInsensitive = (options & TOMFileSearchOptionsCaseInsensitive) != 0;
+	BOOL skipHidden = (options & TOMFileSearchOptionsSkipHiddenFiles) != 0;
+	BOOL skipPackageContents = (options & TOMFileSearchOptionsSkipPackageContents) != 0;
+	TOMPatternMatcher matcher;
+	char errorDescription[256];
+	
+	
+	if ([[NSFileManager defaultManager] fileExistsAtPath:directoryPath isDirectory:&isDirectory])
+	{
+		if (!isDirectory)
+		{
+			TOMLogError(@"[TOMFileManager] ERROR: Search Location is not a directory.");
+			return NO;
+		}
+	}
+	else
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Search Location does not exist.");
+		return NO;
+	}
+	
+	
+	if (TOMPatternMatcherMake(&matcher, pattern, useRegularExpression, caseInsensitive, errorDescription, sizeof(errorDescription)) != 0)
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not search for pattern: '%@'.", pattern);
+		TOMLogError(@"   RESULTING ERROR: %s", errorDescription);
+		
+		return NO;
+	}
+	
+	
+	TOMLogInfo(@"[TOMFileManager] INFO: Searching for files matching: '%@'.\nIn directory: '%@'.", pattern, directoryPath);
+	
+	
+	if (maximumDepth == 0 || maximumResults == 0)
+	{
+		TOMPatternMatcherFree(&matcher);
+		
+		return YES;
+	}
+	
+	
+	TOMPatternMatcher *matcherPointer = &matcher;
+	__block NSUInteger resultCount = 0;
+	
+	TOMWalkDirectory([directoryPath fileSystemRepresentation], YES, ^TOMWalkAction(const TOMWalkEntry *entry) {
+		if ((skipHidden && entry->name[0] == '.') || TOMWalkEntryIsPurgeDirectory(entry))
+		{
+			return TOMWalkActionSkipDescendants;
+		}
+		
+		
+		BOOL descend = (entry->type == DT_DIR) && (entry->depth + 1 < maximumDepth);
+		BOOL candidate = (entry->type != DT_DIR);
+		
+		// Packages look like files to the user, so they're matched as a whole instead of being searched
+		if (skipPackageContents && entry->type == DT_DIR)
+		{
+			NSNumber *isPackage = nil;
+			NSURL *url = [NSURL fileURLWithFileSystemRepresentation:entry->path isDirectory:YES relativeToURL:nil];
+			
+			if ([url getResourceValue:&isPackage forKey:NSURLIsPackageKey error:nil] && [isPackage boolValue])
+			{
+				descend = NO;
+				candidate = YES;
+			}
+		}
+		
+		
+		if (candidate && TOMPatternMatcherMatches(matcherPointer, entry))
+		{
+			NSString *filePath = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:entry->path length:entry->pathLength];
+			BOOL stop = NO;
+			
+			block(filePath, &stop);
+			resultCount++;
+			
+			if (stop || resultCount >= maximumResults)
+			{
+				return TOMWalkActionStop;
+			}
+		}
+		
+		
+		return descend ? TOMWalkActionContinue : TOMWalkActionSkipDescendants;
+	});
+	
+	
+	TOMPatternMatcherFree(&matcher);
+	
+	return YES;
+}
+
+
+
+
+- (BOOL)isFilenameIndexEnabled
+{
+	return filenameIndex != nil;
+}
+
+
+
+
+- (BOOL)enableFilenameIndex
+{
+	if (filenameIndex != nil)
+	{
+		return YES;
+	}
+	
+	
+	NSArray *rootPaths = @[[self documentsDirectory], [self resourcesDirectory], [self libraryDirectory], [self tempDirectory]];
+	NSString *storePath = [[[self libraryDirectory] stringByAppendingPathComponent:@"Caches/TOMFileManager"] stringByAppendingPathComponent:@"FilenameIndex.plist"];
+	TOMFilenameIndex *index = [[TOMFilenameIndex alloc] initWithRootPaths:rootPaths storePath:storePath];
+	index.manager = self;
+	
+	
+	if (![index load])
+	{
+		TOMLogInfo(@"[TOMFileManager] INFO: Building filename index: '%@'.", storePath);
+		
+		[index rebuild];
+	}
+	else
+	{
+		TOMLogInfo(@"[TOMFileManager] INFO: Loaded filename index: '%@'.", storePath);
+	}
+	
+	
+	filenameIndex = index;
+	
+	return YES;
+}
+
+
+
+
+- (void)disableFilenameIndex
+{
+	[filenameIndex save];
+	
+	filenameIndex = nil;
+}
+
+
+
+
+- (BOOL)rebuildFilenameIndex
+{
+	if (filenameIndex == nil)
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not rebuild filename index.");
+		
+		TOMLogDebug(@"   MOST LIKELY REASON: The filename index is not enabled.");
+		
+		return NO;
+	}
+	
+	
+	[filenameIndex rebuild];
+	
+	return YES;
+}
+
+
+
+
+- (BOOL)isMetadataCacheEnabled
+{
+	return metadataCache != nil;
+}
+
+
+
+
+- (NSUInteger)metadataCacheHits
+{
+	return [metadataCache numberOfHits];
+}
+
+
+
+
+- (NSUInteger)metadataCacheMisses
+{
+	return [metadataCache numberOfMisses];
+}
+
+
+
+
+- (void)enableMetadataCacheWithTimeToLive:(NSTimeInterval)timeToLive
+{
+	TOMLogInfo(@"[TOMFileManager] INFO: Caching metadata for %.3fs.", timeToLive);
+	
+	metadataCache = [[TOMMetadataCache alloc] initWithTimeToLive:MAX(timeToLive, 0)];
+}
+
+
+
+
+- (void)disableMetadataCache
+{
+	metadataCache = nil;
+}
+
+
+
+
+- (BOOL)copyFileAtPath:(NSString *)filePath to:(NSString *)destinationDirectoryPath
+{
+	return [self copyFileAtPath:filePath to:destinationDirectoryPath regardlessOfType:NO];
+}
+
+
+
+- (BOOL)copyFileAtPath:(NSString *)filePath to:(NSString *)destinationDirectoryPath report:(TOMTransferReport **)report
+{
+	return [self copyFileAtPath:filePath to:destinationDirectoryPath regardlessOfType:NO report:report];
+}
+
+
+
+
+- (BOOL)copyFileAtPath:(NSString *)filePath to:(NSString *)destinationDirectoryPath regardlessOfType:(BOOL)ignoreType
+{
+	return [self copyFileAtPath:filePath to:destinationDirectoryPath regardlessOfType:ignoreType report:NULL];
+}
+
+
+
+
+- (BOOL)copyFileAtPath:(NSString *)filePath to:(NSString *)destinationDirectoryPath regardlessOfType:(BOOL)ignoreType report:(TOMTransferReport **)report
+{
+	TOMMetricsMeasure(TOMMetricsMethodCopyFile);
+	
+	NSError *error;
+	TOMFileMetadata source = [self metadataForPath:filePath];
+	TOMFileMetadata destination = [self metadataForPath:destinationDirectoryPath];
+	NSString *correctedDestinationDirectoryPath;
+	
+	
+	if (!destination.exists)
+	{
+		[self createDirectoryAtPath:destinationDirectoryPath];
+		correctedDestinationDirectoryPath = [destinationDirectoryPath stringByAppendingPathComponent:[filePath lastPathComponent]];
+	}
+	else
+	{
+		if (destination.isDirectory)
+		{
+			correctedDestinationDirectoryPath = [destinationDirectoryPath stringByAppendingPathComponent:[filePath lastPathComponent]];
+		}
+		else
+		{
+			correctedDestinationDirectoryPath = destinationDirectoryPath;
+		}
+	}
+	
+	
+	TOMLogInfo(@"[TOMFileManager] INFO: Full path of file copy: '%@'.", correctedDestinationDirectoryPath);
+	
+	
+	if (source.exists)
+	{
+		if (source.isReadable)
+		{
+			if (!source.isDirectory)
+			{
+				TOMLogInfo(@"[TOMFileManager] INFO: Copying file: '%@'.\nTo: '%@'.", filePath, correctedDestinationDirectoryPath);
+				
+				TOMCopyStrategy strategy = TOMCopyStrategyNone;
+				unsigned long long bytesCopied = 0;
+				CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+				int copyError = TOMCopyFileContents([filePath fileSystemRepresentation], [correctedDestinationDirectoryPath fileSystemRepresentation], &strategy, &bytesCopied);
+				
+				if (copyError != 0)
+				{
+					TOMLogError(@"[TOMFileManager] ERROR: Could not copy file: '%@'.", filePath);
+					TOMLogError(@"   RESULTING ERROR: %s", strerror(copyError));
+					
+					return NO;
+				}
+				
+				
+				TOMTransferReport *transferReport = [[TOMTransferReport alloc] init];
+				transferReport.numberOfFiles = 1;
+				transferReport.numberOfBytes = bytesCopied;
+				transferReport.duration = CFAbsoluteTimeGetCurrent() - startTime;
+				transferReport.strategy = strategy;
+				
+				TOMLogInfo(@"[TOMFileManager] INFO: Copied file: '%@' (%@).", filePath, transferReport);
+				
+				if (report != NULL)
+				{
+					*report = transferReport;
+				}
+				
+				[self noteChangeAtPath:correctedDestinationDirectoryPath];
+				
+				return YES;
+			}
+			else
+			{
+				if (ignoreType)
+				{
+					TOMLogInfo(@"[TOMFileManager] INFO: Copying file: '%@'.\nTo directory: '%@'.", filePath, destinationDirectoryPath);
+					
+					[[NSFileManager defaultManager] copyItemAtPath:filePath toPath:correctedDestinationDirectoryPath error:&error];
+					
+					if (error)
+					{
+						TOMLogError(@"[TOMFileManager] ERROR: Could not copy file: '%@'.", filePath);
+						TOMLogError(@"   RESULTING ERROR: %@", error);
+						
+						return NO;
+					}
+					
+					[self noteChangeAtPath:correctedDestinationDirectoryPath];
+					
+					return YES;
+				}
+				else
+				{
+					TOMLogError(@"[TOMFileManager] ERROR: Could not copy file: '%@'.", filePath);
+					
+					TOMLogDebug(@"   MOST LIKELY REASON: Source is not a file.");
+					
+					return NO;
+				}
+			}
+		}
+		else
+		{
+			TOMLogError(@"[TOMFileManager] ERROR: Could not copy file: '%@'.\nTo: '%@'.", filePath, correctedDestinationDirectoryPath);
+			
+			TOMLogDebug(@"   MOST LIKELY REASON: Permissions Error.");
+			
+			return NO;
+		}
+	}
+	else
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not copy file: '%@'.", filePath);
+		
+		TOMLogDebug(@"   MOST LIKELY REASON: File does not exist.");
+		
+		return NO;
+	}
+}
+
+
+
+
+- (BOOL)findAndCopyFileNamed:(NSString *)filename to:(NSString *)destinationDirectoryPath
+{
+	NSString *pathOfFile = [self findAndGetPathForFileNamed:filename];
+	
+	if (pathOfFile != nil)
+	{
+		return [self copyFileAtPath:pathOfFile to:destinationDirectoryPath];
+	}
+	else
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not find and copy file: '%@'.\nTo: '%@'.", filename, destinationDirectoryPath);
+		
+		TOMLogDebug(@"   MOST LIKELY REASON: File was not found.");
+		
+		return NO;
+	}
+}
+
+
+
+
+- (BOOL)moveFileAtPath:(NSString *)filePath to:(NSString *)destinationDirectoryPath
+{
+	return [self moveFileAtPath:filePath to:destinationDirectoryPath regardlessOfType:NO];
+}
+
+
+
+- (BOOL)moveFileAtPath:(NSString *)filePath to:(NSString *)destinationDirectoryPath regardlessOfType:(BOOL)ignoreType
+{
+	TOMMetricsMeasure(TOMMetricsMethodMoveFile);
+	
+	NSError *error;
+	TOMFileMetadata source = [self metadataForPath:filePath];
+	TOMFileMetadata destination = [self metadataForPath:destinationDirectoryPath];
+	NSString *correctedDestinationDirectoryPath;
+	
+	
+	if (!destination.exists)
+	{
+		[self createDirectoryAtPath:destinationDirectoryPath];
+		correctedDestinationDirectoryPath = [destinationDirectoryPath stringByAppendingPathComponent:[filePath lastPathComponent]];
+	}
+	else
+	{
+		if (destination.isDirectory)
+		{
+			correctedDestinationDirectoryPath = [destinationDirectoryPath stringByAppendingPathComponent:[filePath lastPathComponent]];
+		}
+		else
+		{
+			correctedDestinationDirectoryPath = destinationDirectoryPath;
+		}
+	}
+	
+	
+	TOMLogInfo(@"[TOMFileManager] INFO: Full path of file move: '%@'.", correctedDestinationDirectoryPath);
+	
+	
+	if (source.exists)
+	{
+		if (source.isReadable)
+		{
+			if (!source.isDirectory)
+			{
+				TOMLogInfo(@"[TOMFileManager] INFO: Moving file: '%@'.\nTo: '%@'.", filePath, correctedDestinationDirectoryPath);
+				
+				[[NSFileManager defaultManager] moveItemAtPath:filePath toPath:correctedDestinationDirectoryPath error:&error];
+				
+				if (error)
+				{
+					TOMLogError(@"[TOMFileManager] ERROR: Could not move file: '%@'.", filePath);
+					TOMLogError(@"   RESULTING ERROR: %@", error);
+					
+					return NO;
+				}
+				
+				[self noteChangeAtPath:filePath];
+				[self noteChangeAtPath:correctedDestinationDirectoryPath];
+				
+				return YES;
+			}
+			else
+			{
+				if (ignoreType)
+				{
+					TOMLogInfo(@"[TOMFileManager] INFO: Moving file: '%@'.\nTo directory: '%@'.", filePath, destinationDirectoryPath);
+					
+					[[NSFileManager defaultManager] moveItemAtPath:filePath toPath:correctedDestinationDirectoryPath error:&error];
+					
+					if (error)
+					{
+						TOMLogError(@"[TOMFileManager] ERROR: Could not move file: '%@'.", filePath);
+						TOMLogError(@"   RESULTING ERROR: %@", error);
+						
+						return NO;
+					}
+					
+					[self noteChangeAtPath:filePath];
+					[self noteChangeAtPath:correctedDestinationDirectoryPath];
+					
+					return YES;
+				}
+				else
+				{
+					TOMLogError(@"[TOMFileManager] ERROR: Could not move file: '%@'.", filePath);
+					
+					TOMLogDebug(@"   MOST LIKELY REASON: Source is not a file.");
+					
+					return NO;
+				}
+			}
+		}
+		else
+		{
+			TOMLogError(@"[TOMFileManager] ERROR: Could not move file: '%@'.\nTo: '%@'.", filePath, correctedDestinationDirectoryPath);
+			
+			TOMLogDebug(@"   MOST LIKELY REASON: Permissions Error.");
+			
+			return NO;
+		}
+	}
+	else
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not move file: '%@'.", filePath);
+		
+		TOMLogDebug(@"   MOST LIKELY REASON: File does not exist.");
+		
+		return NO;
+	}
+}
+
+
+
+
+- (BOOL)findAndMoveFileNamed:(NSString *)filename to:(NSString *)destinationDirectoryPath
+{
+	NSString *pathOfFile = [self findAndGetPathForFileNamed:filename];
+	
+	if (pathOfFile != nil)
+	{
+		return [self moveFileAtPath:pathOfFile to:destinationDirectoryPath];
+	}
+	else
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not find and move file: '%@'.\nTo: '%@'.", filename, destinationDirectoryPath);
+		
+		TOMLogDebug(@"   MOST LIKELY REASON: File was not found.");
+		
+		return NO;
+	}
+}
+
+
+
+
+- (BOOL)deleteFileAtPath:(NSString *)filePath
+{
+	return [self deleteFileAtPath:filePath regardlessOfType:NO];
+}
+
+
+
+
+- (BOOL)deleteFileAtPath:(NSString *)filePath regardlessOfType:(BOOL)ignoreType
+{
+	TOMMetricsMeasure(TOMMetricsMethodDeleteFile);
+	
+	NSError *error;
+	TOMFileMetadata source = [self metadataForPath:filePath];
+	
+	
+	if (source.exists)
+	{
+		if (!source.isDirectory)
+		{
+			TOMLogInfo(@"[TOMFileManager] INFO: Deleting file: '%@'.\n", filePath);
+			
+			[[NSFileManager defaultManager] removeItemAtPath:filePath error:&error];
+			
+			if (error)
+			{
+				TOMLogError(@"[TOMFileManager] ERROR: Could not delete directory: '%@'.", filePath);
+				TOMLogError(@"   RESULTING ERROR: %@", error);
+				
+				return NO;
+			}
+			
+			[self noteChangeAtPath:filePath];
+			
+			return YES;
+		}
+		else
+		{
+			if (ignoreType)
+			{
+				TOMLogInfo(@"[TOMFileManager] INFO: Deleting file: '%@'.\n", filePath);
+				
+				[[NSFileManager defaultManager] removeItemAtPath:filePath error:&error];
+				
+				if (error)
+				{
+					TOMLogError(@"[TOMFileManager] ERROR: Could not delete file: '%@'.", filePath);
+					TOMLogError(@"   RESULTING ERROR: %@", error);
+					
+					return NO;
+				}
+				
+				[self noteChangeAtPath:filePath];
+				
+				return YES;
+			}
+			else
+			{
+				TOMLogError(@"[TOMFileManager] ERROR: Could not delete directory: '%@'.", filePath);
+				
+				TOMLogDebug(@"   MOST LIKELY REASON: It is not a directory.");
+				
+				return NO;
+			}
+		}
+	}
+	else
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not delete file: '%@'.", filePath);
+		
+		TOMLogDebug(@"   MOST LIKELY REASON: File does not exist.");
+		
+		return NO;
+	}
+}
+
+
+
+
+- (BOOL)findAndDeleteFileNamed:(NSString *)filename
+{
+	NSString *pathOfFile = [self findAndGetPathForFileNamed:filename];
+	
+	
+	if (pathOfFile != nil)
+	{
+		return [self deleteFileAtPath:pathOfFile];
+	}
+	else
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not find and delte file: '%@'.", filename);
+		
+		TOMLogDebug(@"   MOST LIKELY REASON: File was not found.");
+		
+		return NO;
+	}
+}
+
+
+
+
+- (TOMBatchReport *)performOperations:(NSArray<TOMFileOperation *> *)operations
+{
+	TOMMetricsMeasure(TOMMetricsMethodPerformOperations);
+	
+	NSUInteger operationCount = [operations count];
+	NSMutableOrderedSet *uniquePaths = [[NSMutableOrderedSet alloc] init];
+	CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+	
+	
+	// Every source and destination is looked up once, however many operations share it. Symbolic links aren't followed, so
+	// a link to a directory is copied, moved or deleted as the link itself rather than as the directory it points to
+	for (TOMFileOperation *operation in operations)
+	{
+		[uniquePaths addObject:operation.sourcePath];
+		
+		if (operation.destinationDirectoryPath != nil)
+		{
+			[uniquePaths addObject:operation.destinationDirectoryPath];
+		}
+	}
+	
+	NSArray *pathList = [uniquePaths array];
+	TOMResolvedPath *resolvedPaths = calloc(MAX([pathList count], 1), sizeof(TOMResolvedPath));
+	
+	dispatch_apply([pathList count], dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t pathIndex) {
+		const char *path = [[pathList objectAtIndex:pathIndex] fileSystemRepresentation];
+		struct stat pathStat;
+		
+		TOMMetricsCount(TOMMetricsCounterStatCalls, 1);
+		
+		if (lstat(path, &pathStat) == 0)
+		{
+			resolvedPaths[pathIndex].exists = YES;
+			resolvedPaths[pathIndex].isDirectory = S_ISDIR(pathStat.st_mode);
+			TOMMetricsCount(TOMMetricsCounterAccessCalls, 1);
+			resolvedPaths[pathIndex].isReadable = (access(path, R_OK) == 0);
+		}
+	});
+	
+	
+	// An operation runs one stage after the latest earlier operation it overlaps with, so the batch behaves as if it ran in
+	// order, while operations that don't touch each other's paths share a stage and run at the same time
+	NSMutableArray *targetPaths = [[NSMutableArray alloc] initWithCapacity:operationCount];
+	NSMutableArray *readPaths = [[NSMutableArray alloc] initWithCapacity:operationCount];
+	NSMutableArray *writePaths = [[NSMutableArray alloc] initWithCapacity:operationCount];
+	NSUInteger *stages = calloc(MAX(operationCount, 1), sizeof(NSUInteger));
+	NSUInteger stageCount = 0;
+	
+	for (NSUInteger operationIndex = 0; operationIndex < operationCount; operationIndex++)
+	{
+		TOMFileOperation *operation = [operations objectAtIndex:operationIndex];
+		NSString *targetPath = operation.sourcePath;
+		
+		if (operation.type != TOMFileOperationTypeDelete)
+		{
+			TOMResolvedPath destination = resolvedPaths[[uniquePaths indexOfObject:operation.destinationDirectoryPath]];
+			
+			targetPath = (destination.exists && !destination.isDirectory) ? operation.destinationDirectoryPath : [operation.destinationDirectoryPath stringByAppendingPathComponent:[operation.sourcePath lastPathComponent]];
+		}
+		
+		[targetPaths addObject:targetPath];
+		
+		switch (operation.type)
+		{
+			case TOMFileOperationTypeCopy:
+				[readPaths addObject:@[operation.sourcePath]];
+				[writePaths addObject:@[targetPath]];
+				break;
+			
+			case TOMFileOperationTypeMove:
+				[readPaths addObject:@[]];
+				[writePaths addObject:@[operation.sourcePath, targetPath]];
+				break;
+			
+			case TOMFileOperationTypeDelete:
+				[readPaths addObject:@[]];
+				[writePaths addObject:@[operation.sourcePath]];
+				break;
+		}
+		
+		
+		NSArray *touchedPaths = [[readPaths lastObject] arrayByAddingObjectsFromArray:[writePaths lastObject]];
+		NSUInteger stage = 0;
+		
+		for (NSUInteger earlierIndex = 0; earlierIndex < operationIndex; earlierIndex++)
+		{
+			if (stages[earlierIndex] + 1 > stage && (TOMPathListsOverlap([writePaths objectAtIndex:earlierIndex], touchedPaths) || TOMPathListsOverlap([writePaths lastObject], [readPaths objectAtIndex:earlierIndex])))
+			{
+				stage = stages[earlierIndex] + 1;
+			}
+		}
+		
+		stages[operationIndex] = stage;
+		stageCount = MAX(stageCount, stage + 1);
+	}
+	
+	
+	BOOL *results = calloc(MAX(operationCount, 1), sizeof(BOOL));
+	
+	for (NSUInteger stage = 0; stage < stageCount; stage++)
+	{
+		NSMutableArray *stageIndexes = [[NSMutableArray alloc] init];
+		
+		for (NSUInteger operationIndex = 0; operationIndex < operationCount; operationIndex++)
+		{
+			if (stages[operationIndex] == stage)
+			{
+				[stageIndexes addObject:@(operationIndex)];
+			}
+		}
+		
+		
+		dispatch_apply([stageIndexes count], dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t taskIndex) {
+			NSUInteger operationIndex = [[stageIndexes objectAtIndex:taskIndex] unsignedIntegerValue];
+			TOMFileOperation *operation = [operations objectAtIndex:operationIndex];
+			TOMResolvedPath source = resolvedPaths[[uniquePaths indexOfObject:operation.sourcePath]];
+			TOMResolvedPath destination = {NO, NO, NO};
+			
+			if (operation.destinationDirectoryPath != nil)
+			{
+				destination = resolvedPaths[[uniquePaths indexOfObject:operation.destinationDirectoryPath]];
+			}
+			
+			
+			// Anything an earlier stage touched has changed since it was looked up, so look again
+			if (stage > 0)
+			{
+				struct stat pathStat;
+				
+				TOMMetricsCount(TOMMetricsCounterStatCalls, 1);
+				source.exists = (lstat([operation.sourcePath fileSystemRepresentation], &pathStat) == 0);
+				source.isDirectory = source.exists && S_ISDIR(pathStat.st_mode);
+				source.isReadable = NO;
+				
+				if (source.exists)
+				{
+					TOMMetricsCount(TOMMetricsCounterAccessCalls, 1);
+					source.isReadable = (access([operation.sourcePath fileSystemRepresentation], R_OK) == 0);
+				}
+				
+				destination.exists = NO;
+				
+				if (operation.destinationDirectoryPath != nil)
+				{
+					TOMMetricsCount(TOMMetricsCounterStatCalls, 1);
+					destination.exists = (stat([operation.destinationDirectoryPath fileSystemRepresentation], &pathStat) == 0);
+				}
+			}
+			
+			results[operationIndex] = [self executeOperation:operation targetPath:[targetPaths objectAtIndex:operationIndex] source:source destination:destination];
+		});
+	}
+	
+	
+	NSMutableArray *resultList = [[NSMutableArray alloc] initWithCapacity:operationCount];
+	NSUInteger succeededCount = 0;
+	
+	for (NSUInteger operationIndex = 0; operationIndex < operationCount; operationIndex++)
+	{
+		TOMFileOperation *operation = [operations objectAtIndex:operationIndex];
+		
+		[resultList addObject:@(results[operationIndex])];
+		
+		if (!results[operationIndex])
+		{
+			continue;
+		}
+		
+		succeededCount++;
+		
+		if (operation.type != TOMFileOperationTypeCopy)
+		{
+			[self noteChangeAtPath:operation.sourcePath];
+		}
+		
+		if (operation.type != TOMFileOperationTypeDelete)
+		{
+			[self noteChangeAtPath:[targetPaths objectAtIndex:operationIndex]];
+		}
+	}
+	
+	free(results);
+	free(stages);
+	free(resolvedPaths);
+	
+	
+	TOMBatchReport *report = [[TOMBatchReport alloc] init];
+	report.results = resultList;
+	report.numberOfSucceededOperations = succeededCount;
+	report.numberOfFailedOperations = operationCount - succeededCount;
+	report.numberOfStages = stageCount;
+	report.duration = CFAbsoluteTimeGetCurrent() - startTime;
+	
+	TOMLogInfo(@"[TOMFileManager] INFO: Performed %lu operations: %@.", (unsigned long)operationCount, report);
+	
+	
+	return report;
+}
+
+
+
+
+- (BOOL)fileExistsAtPath:(NSString *)filePath
+{
+	TOMMetricsMeasure(TOMMetricsMethodFileExists);
+	
+	return [self metadataForPath:filePath].exists;
+}
+
+
+
+
+- (NSUInteger)numberOfFilesInDirectoryAtPath:(NSString *)directoryPath
+{
+	return [self numberOfItemsInDirectoryAtPath:directoryPath options:TOMCountOptionsNone];
+}
+
+
+
+
+- (NSUInteger)numberOfItemsInDirectoryAtPath:(NSString *)directoryPath options:(TOMCountOptions)options
+{
+	TOMMetricsMeasure(TOMMetricsMethodNumberOfItems);
+	
+	BOOL recursive = (options & TOMCountOptionsRecursive) != 0;
+	BOOL skipHidden = (options & TOMCountOptionsSkipHiddenFiles) != 0;
+	NSMutableArray *subdirectoryPaths = [[NSMutableArray alloc] init];
+	__block unsigned long long count = 0;
+	
+	
+	if (![self metadataForPath:directoryPath].isDirectory)
+	{
+		return 0;
+	}
+	
+	
+	// Only the names of the immediate subdirectories are ever kept - everything below them is counted as it streams past
+	TOMWalkDirectory([directoryPath fileSystemRepresentation], NO, ^TOMWalkAction(const TOMWalkEntry *entry) {
+		// Whatever is waiting to be purged is already deleted as far as anyone else can tell
+		if ((skipHidden && entry->name[0] == '.') || TOMWalkEntryIsPurgeDirectory(entry))
+		{
+			return TOMWalkActionContinue;
+		}
+		
+		if (TOMWalkEntryMatchesCountOptions(entry, options))
+		{
+			count++;
+		}
+		
+		if (recursive && entry->type == DT_DIR)
+		{
+			NSString *subdirectoryPath = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:entry->path length:entry->pathLength];
+			
+			if (subdirectoryPath != nil)
+			{
+				[subdirectoryPaths addObject:subdirectoryPath];
+			}
+		}
+		
+		return TOMWalkActionContinue;
+	});
+	
+	
+	if ([subdirectoryPaths count] > 0)
+	{
+		_Atomic unsigned long long nestedCount = 0;
+		_Atomic unsigned long long *nestedCountPointer = &nestedCount;
+		
+		dispatch_apply([subdirectoryPaths count], dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t subdirectoryIndex) {
+			__block unsigned long long taskCount = 0;
+			
+			TOMWalkDirectory([[subdirectoryPaths objectAtIndex:subdirectoryIndex] fileSystemRepresentation], YES, ^TOMWalkAction(const TOMWalkEntry *entry) {
+				if ((skipHidden && entry->name[0] == '.') || TOMWalkEntryIsPurgeDirectory(entry))
+				{
+					return TOMWalkActionSkipDescendants;
+				}
+				
+				if (TOMWalkEntryMatchesCountOptions(entry, options))
+				{
+					taskCount++;
+				}
+				
+				return TOMWalkActionContinue;
+			});
+			
+			// One shared update per task, rather than one per entry
+			atomic_fetch_add_explicit(nestedCountPointer, taskCount, memory_order_relaxed);
+		});
+		
+		count += atomic_load(&nestedCount);
+	}
+	
+	
+	TOMLogInfo(@"[TOMFileManager] INFO: Counted %llu items in directory: '%@'.", count, directoryPath);
+	
+	return (NSUInteger)count;
+}
+
+
+
+
+- (TOMDirectorySize *)sizeOfDirectoryAtPath:(NSString *)directoryPath
+{
+	return [self sizeOfDirectoryAtPath:directoryPath usingCache:YES];
+}
+
+
+
+
+- (TOMDirectorySize *)sizeOfDirectoryAtPath:(NSString *)directoryPath usingCache:(BOOL)useCache
+{
+	TOMMetricsMeasure(TOMMetricsMethodSizeOfDirectory);
+	
+	NSString *standardizedPath = [directoryPath stringByStandardizingPath];
+	TOMDirectorySizeCache *cache = directorySizeCache;
+	TOMDirectorySizeTotals totals = {0};
+	
+	
+	NSArray *subdirectoryNames = TOMDirectorySizeOfDirectory(standardizedPath, cache, useCache, &totals);
+	
+	if (subdirectoryNames == nil)
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not get size of directory: '%@'.", directoryPath);
+		TOMLogDebug(@"   MOST LIKELY REASON: Directory does not exist.");
+		
+		return nil;
+	}
+	
+	
+	if ([subdirectoryNames count] > 0)
+	{
+		TOMDirectorySizeTotals *subdirectoryTotals = calloc([subdirectoryNames count], sizeof(TOMDirectorySizeTotals));
+		
+		if (subdirectoryTotals == NULL)
+		{
+			TOMLogError(@"[TOMFileManager] ERROR: Could not get size of directory: '%@'.", directoryPath);
+			TOMLogError(@"   RESULTING ERROR: %s", strerror(ENOMEM));
+			
+			return nil;
+		}
+		
+		
+		// Each subdirectory's tree is totalled on its own, with no shared state besides the cache
+		dispatch_apply([subdirectoryNames count], dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t subdirectoryIndex) {
+			NSString *subdirectoryPath = [standardizedPath stringByAppendingPathComponent:[subdirectoryNames objectAtIndex:subdirectoryIndex]];
+			
+			TOMDirectorySizeOfTree(subdirectoryPath, cache, useCache, &subdirectoryTotals[subdirectoryIndex]);
+		});
+		
+		for (NSUInteger subdirectoryIndex = 0; subdirectoryIndex < [subdirectoryNames count]; subdirectoryIndex++)
+		{
+			TOMDirectorySizeTotalsAdd(&totals, &subdirectoryTotals[subdirectoryIndex]);
+		}
+		
+		free(subdirectoryTotals);
+	}
+	
+	
+	TOMDirectorySize *size = [[TOMDirectorySize alloc] init];
+	size.logicalSize = totals.logicalSize;
+	size.allocatedSize = totals.allocatedSize;
+	size.numberOfFiles = (NSUInteger)totals.numberOfFiles;
+	size.numberOfDirectories = (NSUInteger)totals.numberOfDirectories;
+	
+	TOMLogInfo(@"[TOMFileManager] INFO: Size of directory: '%@' is %@.", directoryPath, size);
+	
+	return size;
+}
+
+
+
+
+- (void)clearDirectorySizeCache
+{
+	[directorySizeCache removeAllEntries];
+}
+
+
+
+
+- (id)watchDirectoryAtPath:(NSString *)directoryPath usingBlock:(void (^)(NSSet<NSString *> *changedDirectoryPaths))block
+{
+	NSString *standardizedPath = [directoryPath stringByStandardizingPath];
+	__weak TOMFileManager *weakSelf = self;
+	
+	
+	if (![self metadataForPath:standardizedPath].isDirectory)
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not watch directory: '%@'.", directoryPath);
+		TOMLogDebug(@"   MOST LIKELY REASON: Directory does not exist.");
+		
+		return nil;
+	}
+	
+	
+	TOMDirectoryWatch *watch = [[TOMDirectoryWatch alloc] initWithRootPath:standardizedPath handler:^(NSSet *changedDirectoryPaths) {
+		[weakSelf noteChangesInDirectoriesAtPaths:changedDirectoryPaths];
+		
+		if (block != nil)
+		{
+			dispatch_async(dispatch_get_main_queue(), ^{
+				block(changedDirectoryPaths);
+			});
+		}
+	}];
+	
+	watch.manager = self;
+	
+	NSUInteger directoryCount = [watch start];
+	
+	@synchronized (directoryWatches)
+	{
+		[directoryWatches addObject:watch];
+	}
+	
+	
+	TOMLogInfo(@"[TOMFileManager] INFO: Watching %lu directories in: '%@'.", (unsigned long)directoryCount, directoryPath);
+	
+	return watch;
+}
+
+
+
+
+- (void)stopWatching:(id)watch
+{
+	if (![watch isKindOfClass:[TOMDirectoryWatch class]])
+	{
+		return;
+	}
+	
+	
+	[(TOMDirectoryWatch *)watch cancel];
+	
+	@synchronized (directoryWatches)
+	{
+		[directoryWatches removeObjectIdenticalTo:watch];
+	}
+	
+	
+	TOMLogInfo(@"[TOMFileManager] INFO: Stopped watching: '%@'.", [(TOMDirectoryWatch *)watch rootPath]);
+}
+
+
+
+
+- (NSData*)retrieveDataForFileAtPath:(NSString *)filePath
+{
+	TOMMetricsMeasure(TOMMetricsMethodRetrieveData);
+	
+	
+	if ([self fileExistsAtPath:filePath])
+	{
+		NSData *data = [NSData dataWithContentsOfFile:filePath];
+		TOMMetricsCount(TOMMetricsCounterBytesRead, [data length]);
+		
+		return data;
+	}
+	else
+	{
+		return NULL;
+	}
+}
+
+
+
+
+- (NSData *)retrieveMappedDataForFileAtPath:(NSString *)filePath
+{
+	TOMMetricsMeasure(TOMMetricsMethodRetrieveMappedData);
+	
+	TOMMetricsCount(TOMMetricsCounterOpenCalls, 1);
+	int fileDescriptor = open([filePath fileSystemRepresentation], O_RDONLY | O_CLOEXEC);
+	struct stat fileStat;
+	
+	
+	if (fileDescriptor < 0)
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not map file: '%@'.", filePath);
+		
+		TOMLogDebug(@"   MOST LIKELY REASON: %s.", strerror(errno));
+		
+		return NULL;
+	}
+	
+	TOMMetricsCount(TOMMetricsCounterStatCalls, 1);
+	
+	if (fstat(fileDescriptor, &fileStat) != 0 || !S_ISREG(fileStat.st_mode))
+	{
+		close(fileDescriptor);
+		
+		TOMLogError(@"[TOMFileManager] ERROR: Could not map file: '%@'.", filePath);
+		
+		TOMLogDebug(@"   MOST LIKELY REASON: It is not a file.");
+		
+		return NULL;
+	}
+	
+	
+	// mmap() refuses empty mappings
+	if (fileStat.st_size == 0)
+	{
+		close(fileDescriptor);
+		return [NSData data];
+	}
+	
+	
+	size_t length = (size_t)fileStat.st_size;
+	
+	TOMMetricsCount(TOMMetricsCounterMmapCalls, 1);
+	void *bytes = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+	
+	// The mapping keeps its own reference to the file
+	close(fileDescriptor);
+	
+	if (bytes == MAP_FAILED)
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not map file: '%@'.", filePath);
+		TOMLogError(@"   RESULTING ERROR: %s", strerror(errno));
+		
+		return NULL;
+	}
+	
+	
+	// Most mapped files are read front to back, so ask for aggressive read-ahead and get the first window paged in early
+	madvise(bytes, length, MADV_SEQUENTIAL);
+	madvise(bytes, MIN(length, TOMReadAheadLength), MADV_WILLNEED);
+	
+	
+	TOMLogInfo(@"[TOMFileManager] INFO: Mapped %llu bytes of file: '%@'.", (unsigned long long)length, filePath);
+	
+	return [[NSData alloc] initWithBytesNoCopy:bytes length:length deallocator:^(void *mappedBytes, NSUInteger mappedLength) {
+		munmap(mappedBytes, mappedLength);
+	}];
+}
+
+
+
+
+- (NSData *)retrieveDataForFileAtPath:(NSString *)filePath range:(NSRange)range
+{
+	TOMMetricsMeasure(TOMMetricsMethodRetrieveDataInRange);
+	
+	TOMMetricsCount(TOMMetricsCounterOpenCalls, 1);
+	int fileDescriptor = open([filePath fileSystemRepresentation], O_RDONLY | O_CLOEXEC);
+	struct stat fileStat;
+	
+	
+	if (fileDescriptor < 0)
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not read file: '%@'.", filePath);
+		
+		TOMLogDebug(@"   MOST LIKELY REASON: %s.", strerror(errno));
+		
+		return NULL;
+	}
+	
+	TOMMetricsCount(TOMMetricsCounterStatCalls, 1);
+	
+	if (fstat(fileDescriptor, &fileStat) != 0 || !S_ISREG(fileStat.st_mode))
+	{
+		close(fileDescriptor);
+		
+		TOMLogError(@"[TOMFileManager] ERROR: Could not read file: '%@'.", filePath);
+		
+		TOMLogDebug(@"   MOST LIKELY REASON: It is not a file.");
+		
+		return NULL;
+	}
+	
+	
+	// Only the part of the range that lies inside the file can be read
+	uint64_t fileSize = (uint64_t)fileStat.st_size;
+	uint64_t start = MIN((uint64_t)range.location, fileSize);
+	size_t length = (size_t)MIN((uint64_t)range.length, fileSize - start);
+	
+	if (length == 0)
+	{
+		close(fileDescriptor);
+		return [NSData data];
+	}
+	
+	
+	struct radvisory readAdvisory;
+	readAdvisory.ra_offset = (off_t)start;
+	readAdvisory.ra_count = (int)MIN(length, (size_t)INT_MAX);
+	fcntl(fileDescriptor, F_RDADVISE, &readAdvisory);
+	
+	
+	uint8_t *bytes = malloc(length);
+	size_t bytesRead = 0;
+	int readError = 0;
+	
+	if (bytes == NULL)
+	{
+		close(fileDescriptor);
+		
+		TOMLogError(@"[TOMFileManager] ERROR: Could not read file: '%@'.", filePath);
+		TOMLogError(@"   RESULTING ERROR: Could not allocate %llu bytes.", (unsigned long long)length);
+		
+		return NULL;
+	}
+	
+	while (bytesRead < length)
+	{
+		TOMMetricsCount(TOMMetricsCounterReadCalls, 1);
+		ssize_t result = pread(fileDescriptor, bytes + bytesRead, length - bytesRead, (off_t)(start + bytesRead));
+		
+		if (result < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		
+		// The file shrank since it was looked at, and a short read leaves errno alone
+		if (result <= 0)
+		{
+			readError = (result == 0) ? EIO : errno;
+			break;
+		}
+		
+		bytesRead += (size_t)result;
+		TOMMetricsCount(TOMMetricsCounterBytesRead, (uint64_t)result);
+	}
+	
+	close(fileDescriptor);
+	
+	
+	if (bytesRead < length)
+	{
+		free(bytes);
+		
+		TOMLogError(@"[TOMFileManager] ERROR: Could not read file: '%@'.", filePath);
+		TOMLogError(@"   RESULTING ERROR: %s", strerror(readError));
+		
+		return NULL;
+	}
+	
+	
+	TOMLogInfo(@"[TOMFileManager] INFO: Read %llu bytes at offset %llu of file: '%@'.", (unsigned long long)length, start, filePath);
+	
+	return [NSData dataWithBytesNoCopy:bytes length:length freeWhenDone:YES];
+}
+
+
+
+
+- (BOOL)readFileAtPath:(NSString *)filePath chunkSize:(NSUInteger)chunkSize usingBlock:(void (^)(NSData *chunk, BOOL *stop))block
+{
+	TOMMetricsMeasure(TOMMetricsMethodReadFile);
+	TOMMetricsCount(TOMMetricsCounterOpenCalls, 1);
+	
+	int fileDescriptor = open([filePath fileSystemRepresentation], O_RDONLY | O_CLOEXEC);
+	size_t bufferSize = (chunkSize > 0) ? chunkSize : TOMDefaultChunkSize;
+	BOOL stop = NO;
+	
+	
+	if (fileDescriptor < 0)
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not read file: '%@'.", filePath);
+		
+		TOMLogDebug(@"   MOST LIKELY REASON: %s.", strerror(errno));
+		
+		return NO;
+	}
+	
+	
+	// One buffer serves every chunk - the data handed to the block is only a view of it
+	uint8_t *buffer = malloc(bufferSize);
+	
+	if (buffer == NULL)
+	{
+		close(fileDescriptor);
+		
+		TOMLogError(@"[TOMFileManager] ERROR: Could not read file: '%@'.", filePath);
+		TOMLogError(@"   RESULTING ERROR: Could not allocate %llu bytes.", (unsigned long long)bufferSize);
+		
+		return NO;
+	}
+	
+	
+	TOMLogInfo(@"[TOMFileManager] INFO: Reading file in %llu byte chunks: '%@'.", (unsigned long long)bufferSize, filePath);
+	
+	fcntl(fileDescriptor, F_RDAHEAD, 1);
+	
+	
+	BOOL succeeded = YES;
+	
+	while (!stop)
+	{
+		size_t bytesRead = 0;
+		
+		// Fill the whole chunk, so that every chunk but the last is exactly chunkSize long
+		while (bytesRead < bufferSize)
+		{
+			TOMMetricsCount(TOMMetricsCounterReadCalls, 1);
+			ssize_t result = read(fileDescriptor, buffer + bytesRead, bufferSize - bytesRead);
+			
+			if (result < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			
+			if (result < 0)
+			{
+				int readError = errno;
+				
+				TOMLogError(@"[TOMFileManager] ERROR: Could not read file: '%@'.", filePath);
+				TOMLogError(@"   RESULTING ERROR: %s", strerror(readError));
+				
+				succeeded = NO;
+				stop = YES;
+				break;
+			}
+			
+			if (result == 0)
+			{
+				stop = YES;
+				break;
+			}
+			
+			bytesRead += (size_t)result;
+			TOMMetricsCount(TOMMetricsCounterBytesRead, (uint64_t)result);
+		}
+		
+		
+		if (bytesRead > 0 && succeeded)
+		{
+			@autoreleasepool
+			{
+				BOOL blockStop = NO;
+				
+				block([[NSData alloc] initWithBytesNoCopy:buffer length:bytesRead freeWhenDone:NO], &blockStop);
+				
+				stop = stop || blockStop;
+			}
+		}
+	}
+	
+	
+	free(buffer);
+	close(fileDescriptor);
+	
+	return succeeded;
+}
+
+
+
+
+- (NSData *)hashOfFileAtPath:(NSString *)filePath algorithm:(TOMHashAlgorithm)algorithm
+{
+	TOMMetricsMeasure(TOMMetricsMethodHashFile);
+	
+	NSData *digest = nil;
+	unsigned long long bytesHashed = 0;
+	CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+	
+	
+	int hashError = TOMHashFile([filePath fileSystemRepresentation], algorithm, &digest, &bytesHashed);
+	
+	if (hashError != 0)
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not hash file: '%@'.", filePath);
+		TOMLogError(@"   RESULTING ERROR: %s", strerror(hashError));
+		
+		if (hashError == ENOENT)
+		{
+			TOMLogDebug(@"   MOST LIKELY REASON: File does not exist.");
+		}
+		else if (hashError == EISDIR)
+		{
+			TOMLogDebug(@"   MOST LIKELY REASON: Path is a directory.");
+		}
+		
+		return nil;
+	}
+	
+	
+	if (TOMLogEnabled(TOMLogLevelInfo))
+	{
+		CFAbsoluteTime duration = CFAbsoluteTimeGetCurrent() - startTime;
+		
+		TOMLogInfo(@"[TOMFileManager] INFO: Hashed file: '%@' (%llu bytes in %.3fs, %.0f bytes/s).", filePath, bytesHashed, duration, (duration > 0) ? (double)bytesHashed / duration : 0);
+	}
+	
+	return digest;
+}
+
+
+
+
+- (NSDictionary<NSString *, NSData *> *)hashesOfFilesAtPaths:(NSArray<NSString *> *)filePaths algorithm:(TOMHashAlgorithm)algorithm
+{
+	TOMMetricsMeasure(TOMMetricsMethodHashFiles);
+	
+	NSMutableDictionary *digests = [[NSMutableDictionary alloc] initWithCapacity:[filePaths count]];
+	_Atomic unsigned long long totalBytesHashed = 0;
+	_Atomic unsigned long long *totalBytesHashedPointer = &totalBytesHashed;
+	CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+	
+	
+	// Each file is streamed on its own, with its own buffer, so the files are hashed as far apart as the cores allow
+	dispatch_apply([filePaths count], dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^(size_t fileIndex) {
+		@autoreleasepool
+		{
+			NSString *filePath = [filePaths objectAtIndex:fileIndex];
+			NSData *digest = nil;
+			unsigned long long bytesHashed = 0;
+			
+			int hashError = TOMHashFile([filePath fileSystemRepresentation], algorithm, &digest, &bytesHashed);
+			
+			if (hashError != 0)
+			{
+				TOMLogError(@"[TOMFileManager] ERROR: Could not hash file: '%@'.", filePath);
+				TOMLogError(@"   RESULTING ERROR: %s", strerror(hashError));
+				
+				return;
+			}
+			
+			atomic_fetch_add_explicit(totalBytesHashedPointer, bytesHashed, memory_order_relaxed);
+			
+			@synchronized (digests)
+			{
+				[digests setObject:digest forKey:filePath];
+			}
+		}
+	});
+	
+	
+	if (TOMLogEnabled(TOMLogLevelInfo))
+	{
+		CFAbsoluteTime duration = CFAbsoluteTimeGetCurrent() - startTime;
+		unsigned long long bytesHashed = atomic_load(&totalBytesHashed);
+		
+		TOMLogInfo(@"[TOMFileManager] INFO: Hashed %lu of %lu files (%llu bytes in %.3fs, %.0f bytes/s).", (unsigned long)[digests count], (unsigned long)[filePaths count], bytesHashed, duration, (duration > 0) ? (double)bytesHashed / duration : 0);
+	}
+	
+	return digests;
+}
+
+
+
+
+- (NSArray<NSArray<NSString *> *> *)findDuplicateFiles
+{
+	return [self findDuplicateFilesInDirectories:@[_documentsDirectory, _libraryDirectory, _tempDirectory]];
+}
+
+
+
+
+- (NSArray<NSArray<NSString *> *> *)findDuplicateFilesInDirectories:(NSArray<NSString *> *)directoryPaths
+{
+	TOMMetricsMeasure(TOMMetricsMethodFindDuplicates);
+	
+	NSMutableArray *rootPaths = [[NSMutableArray alloc] init];
+	NSMutableArray *duplicateGroups = [[NSMutableArray alloc] init];
+	CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+	
+	
+	// Sorted, a directory comes before anything inside it, which is then dropped instead of being walked twice
+	for (NSString *directoryPath in [directoryPaths sortedArrayUsingSelector:@selector(compare:)])
+	{
+		NSString *standardizedPath = [directoryPath stringByStandardizingPath];
+		
+		if ([self metadataForPath:standardizedPath].isDirectory && !TOMPathListsOverlap(rootPaths, @[standardizedPath]))
+		{
+			[rootPaths addObject:standardizedPath];
+		}
+	}
+	
+	
+	__block TOMDuplicateCandidate *candidates = NULL;
+	__block size_t candidateCount = 0;
+	__block size_t candidateCapacity = 0;
+	__block os_unfair_lock candidatesLock = OS_UNFAIR_LOCK_INIT;
+	
+	[self performSearchOfDirectories:rootPaths usingVisitor:^TOMWalkAction(long taskIndex, const TOMWalkEntry *entry) {
+		struct stat fileStat;
+		
+		
+		if (entry->type != DT_REG)
+		{
+			return TOMWalkActionContinue;
+		}
+		
+		TOMMetricsCount(TOMMetricsCounterStatCalls, 1);
+		
+		// Empty files are all alike, and there's nothing to gain by linking them
+		if (lstat(entry->path, &fileStat) != 0 || fileStat.st_size == 0)
+		{
+			return TOMWalkActionContinue;
+		}
+		
+		
+		TOMDuplicateCandidate candidate = { strdup(entry->path), (unsigned long long)fileStat.st_size, fileStat.st_dev, fileStat.st_ino, 0, 0 };
+		
+		os_unfair_lock_lock(&candidatesLock);
+		
+		if (candidateCount == candidateCapacity)
+		{
+			size_t newCapacity = MAX(candidateCapacity * 2, (size_t)1024);
+			TOMDuplicateCandidate *newCandidates = realloc(candidates, newCapacity * sizeof(TOMDuplicateCandidate));
+			
+			if (newCandidates != NULL)
+			{
+				candidates = newCandidates;
+				candidateCapacity = newCapacity;
+			}
+		}
+		
+		if (candidateCount < candidateCapacity && candidate.path != NULL)
+		{
+			candidates[candidateCount++] = candidate;
+		}
+		else
+		{
+			free(candidate.path);
+		}
+		
+		os_unfair_lock_unlock(&candidatesLock);
+		
+		return TOMWalkActionContinue;
+	}];
+	
+	
+	// Each round hashes only the candidates that still have a match, then sorts them so that matches are neighbours again
+	for (int round = 0; round < 3; round++)
+	{
+		if (round > 0)
+		{
+			size_t *roundIndexes = malloc(MAX(candidateCount, (size_t)1) * sizeof(size_t));
+			size_t roundCount = 0;
+			
+			if (roundIndexes == NULL)
+			{
+				break;
+			}
+			
+			for (size_t candidateIndex = 0; candidateIndex < candidateCount; candidateIndex++)
+			{
+				BOOL matchesPrevious = (candidateIndex > 0 && TOMDuplicateCandidatesMatch(&candidates[candidateIndex], &candidates[candidateIndex - 1]));
+				BOOL matchesNext = (candidateIndex + 1 < candidateCount && TOMDuplicateCandidatesMatch(&candidates[candidateIndex], &candidates[candidateIndex + 1]));
+				
+				if ((matchesPrevious || matchesNext) && candidates[candidateIndex].size > 0)
+				{
+					roundIndexes[roundCount++] = candidateIndex;
+				}
+				else
+				{
+					// Nothing left to match it with, so it takes no further part
+					candidates[candidateIndex].size = 0;
+				}
+			}
+			
+			
+			dispatch_apply(roundCount, dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^(size_t roundIndex) {
+				TOMDuplicateCandidate *candidate = &candidates[roundIndexes[roundIndex]];
+				
+				if (round == 1)
+				{
+					if (TOMPartialHashFile(candidate->path, candidate->size, &candidate->partialHash) != 0)
+					{
+						candidate->size = 0;
+					}
+				}
+				else if (candidate->size <= TOMDuplicatePartialLength * 2)
+				{
+					// The partial hash already covered all of it
+					candidate->fullHash = candidate->partialHash;
+				}
+				else
+				{
+					@autoreleasepool
+					{
+						NSData *digest = nil;
+						unsigned long long bytesHashed = 0;
+						uint64_t fullHash = 0;
+						
+						// A file that changed size since it was found can't be trusted to match anything
+						if (TOMHashFile(candidate->path, TOMHashAlgorithmXXH64, &digest, &bytesHashed) != 0 || bytesHashed != candidate->size)
+						{
+							candidate->size = 0;
+						}
+						else
+						{
+							[digest getBytes:&fullHash length:sizeof(fullHash)];
+							candidate->fullHash = CFSwapInt64BigToHost(fullHash);
+						}
+					}
+				}
+			});
+			
+			free(roundIndexes);
+		}
+		
+		qsort(candidates, candidateCount, sizeof(TOMDuplicateCandidate), TOMDuplicateCandidateCompare);
+	}
+	
+	
+	unsigned long long duplicatedBytes = 0;
+	size_t groupStart = 0;
+	
+	while (groupStart < candidateCount && candidates[groupStart].size > 0)
+	{
+		size_t groupEnd = groupStart + 1;
+		NSMutableArray *group = [[NSMutableArray alloc] init];
+		
+		while (groupEnd < candidateCount && TOMDuplicateCandidatesMatch(&candidates[groupEnd], &candidates[groupStart]))
+		{
+			groupEnd++;
+		}
+		
+		
+		for (size_t candidateIndex = groupStart; candidateIndex < groupEnd; candidateIndex++)
+		{
+			// Hard links to the same file are already sharing its data, so only one of them is listed
+			if (candidateIndex > groupStart && candidates[candidateIndex].device == candidates[candidateIndex - 1].device && candidates[candidateIndex].inode == candidates[candidateIndex - 1].inode)
+			{
+				continue;
+			}
+			
+			NSString *path = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:candidates[candidateIndex].path length:strlen(candidates[candidateIndex].path)];
+			
+			if (path != nil)
+			{
+				[group addObject:path];
+			}
+		}
+		
+		if ([group count] > 1)
+		{
+			[group sortUsingSelector:@selector(compare:)];
+			[duplicateGroups addObject:group];
+			duplicatedBytes += candidates[groupStart].size * ([group count] - 1);
+		}
+		
+		groupStart = groupEnd;
+	}
+	
+	
+	for (size_t candidateIndex = 0; candidateIndex < candidateCount; candidateIndex++)
+	{
+		free(candidates[candidateIndex].path);
+	}
+	
+	free(candidates);
+	
+	
+	TOMLogInfo(@"[TOMFileManager] INFO: Found %lu groups of duplicate files, wasting %llu bytes, in %.3fs.", (unsigned long)[duplicateGroups count], duplicatedBytes, CFAbsoluteTimeGetCurrent() - startTime);
+	
+	return duplicateGroups;
+}
+
+
+
+
+- (NSUInteger)replaceDuplicateFilesInGroups:(NSArray<NSArray<NSString *> *> *)duplicateGroups withLinkType:(TOMLinkType)linkType
+{
+	TOMMetricsMeasure(TOMMetricsMethodReplaceDuplicates);
+	
+	_Atomic unsigned long replacedCount = 0;
+	_Atomic unsigned long *replacedCountPointer = &replacedCount;
+	
+	
+	dispatch_apply([duplicateGroups count], dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^(size_t groupIndex) {
+		NSArray *group = [duplicateGroups objectAtIndex:groupIndex];
+		NSString *originalPath = [group firstObject];
+		
+		
+		for (NSUInteger pathIndex = 1; pathIndex < [group count]; pathIndex++)
+		{
+			NSString *duplicatePath = [group objectAtIndex:pathIndex];
+			
+			// Hashes can collide, and either file may have changed since they were found
+			if (!TOMFileContentsAreEqual([originalPath fileSystemRepresentation], [duplicatePath fileSystemRepresentation]))
+			{
+				TOMLogError(@"[TOMFileManager] ERROR: Could not replace duplicate file: '%@'.", duplicatePath);
+				TOMLogDebug(@"   MOST LIKELY REASON: It is no longer the same as '%@'.", originalPath);
+				
+				continue;
+			}
+			
+			
+			int linkError = TOMReplaceWithLink([originalPath fileSystemRepresentation], [duplicatePath fileSystemRepresentation], linkType);
+			
+			if (linkError != 0)
+			{
+				TOMLogError(@"[TOMFileManager] ERROR: Could not replace duplicate file: '%@'.", duplicatePath);
+				TOMLogError(@"   RESULTING ERROR: %s", strerror(linkError));
+				
+				if (linkError == EXDEV)
+				{
+					TOMLogDebug(@"   MOST LIKELY REASON: It is on a different volume than '%@'.", originalPath);
+				}
+				
+				continue;
+			}
+			
+			
+			atomic_fetch_add(replacedCountPointer, 1);
+			[self noteChangeAtPath:duplicatePath];
+		}
+	});
+	
+	
+	TOMLogInfo(@"[TOMFileManager] INFO: Replaced %lu duplicate files with %@.", atomic_load(&replacedCount), (linkType == TOMLinkTypeClone) ? @"clones" : @"hard links");
+	
+	return (NSUInteger)atomic_load(&replacedCount);
+}
+
+
+
+
+- (BOOL)writeData:(NSData *)data toFileAtPath:(NSString *)filePath atomically:(BOOL)atomically
+{
+	return [self writeData:data toFileAtPath:filePath options:(atomically ? TOMWriteOptionsAtomic : TOMWriteOptionsNone)];
+}
+
+
+
+
+- (BOOL)writeData:(NSData *)data toFileAtPath:(NSString *)filePath options:(TOMWriteOptions)options
+{
+	TOMMetricsMeasure(TOMMetricsMethodWriteData);
+	
+	CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+	
+	
+	if (![self performWriteOfData:data toFileAtPath:filePath options:options])
+	{
+		return NO;
+	}
+	
+	
+	TOMLogInfo(@"[TOMFileManager] INFO: Wrote file: '%@' (%lu bytes in %.3fs).", filePath, (unsigned long)[data length], CFAbsoluteTimeGetCurrent() - startTime);
+	
+	return YES;
+}
+
+
+
+
+- (NSUInteger)writeDataForFiles:(NSDictionary<NSString *, NSData *> *)dataByFilePath options:(TOMWriteOptions)options
+{
+	TOMMetricsMeasure(TOMMetricsMethodWriteFiles);
+	
+	NSArray *filePaths = [dataByFilePath allKeys];
+	_Atomic NSUInteger numberOfFilesWritten = 0;
+	_Atomic NSUInteger *numberOfFilesWrittenPointer = &numberOfFilesWritten;
+	CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+	
+	
+	// The files are written side by side, so with TOMWriteOptionsGroupCommit they all finish in time to share their flushes
+	dispatch_apply([filePaths count], dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^(size_t fileIndex) {
+		@autoreleasepool
+		{
+			NSString *filePath = [filePaths objectAtIndex:fileIndex];
+			
+			if ([self performWriteOfData:[dataByFilePath objectForKey:filePath] toFileAtPath:filePath options:options])
+			{
+				atomic_fetch_add_explicit(numberOfFilesWrittenPointer, 1, memory_order_relaxed);
+			}
+		}
+	});
+	
+	
+	TOMLogInfo(@"[TOMFileManager] INFO: Wrote %lu of %lu files in %.3fs.", (unsigned long)atomic_load(&numberOfFilesWritten), (unsigned long)[filePaths count], CFAbsoluteTimeGetCurrent() - startTime);
+	
+	return atomic_load(&numberOfFilesWritten);
+}
+
+
+
+
+- (TOMBufferedFileWriter *)bufferedWriterForFileAtPath:(NSString *)filePath
+{
+	return [self bufferedWriterForFileAtPath:filePath bufferSize:TOMBufferedWriterDefaultBufferSize flushInterval:TOMBufferedWriterDefaultFlushInterval];
+}
+
+
+
+
+- (TOMBufferedFileWriter *)bufferedWriterForFileAtPath:(NSString *)filePath bufferSize:(NSUInteger)bufferSize flushInterval:(NSTimeInterval)flushInterval
+{
+	TOMMetricsMeasure(TOMMetricsMethodOpenBufferedWriter);
+	TOMMetricsCount(TOMMetricsCounterOpenCalls, 1);
+	
+	
+	// O_APPEND makes every write land at the current end, even if something else appends to the file too
+	int fileDescriptor = open([filePath fileSystemRepresentation], O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, DEFFILEMODE);
+	
+	if (fileDescriptor < 0)
+	{
+		int openError = errno;
+		
+		TOMLogError(@"[TOMFileManager] ERROR: Could not open file for writing: '%@'.", filePath);
+		TOMLogError(@"   RESULTING ERROR: %s", strerror(openError));
+		
+		if (openError == ENOENT)
+		{
+			TOMLogDebug(@"   MOST LIKELY REASON: Directory does not exist.");
+		}
+		else if (openError == EISDIR)
+		{
+			TOMLogDebug(@"   MOST LIKELY REASON: Path is a directory.");
+		}
+		
+		return nil;
+	}
+	
+	[self noteChangeAtPath:filePath];
+	
+	
+	__weak TOMFileManager *weakSelf = self;
+	
+	// Appending doesn't touch the file's directory entry, so each write out only needs its metadata and size forgotten
+	TOMBufferedFileWriter *writer = [[TOMBufferedFileWriter alloc] initWithFileDescriptor:fileDescriptor filePath:filePath bufferSize:MAX(bufferSize, (NSUInteger)1) flushInterval:flushInterval changeHandler:^{
+		[weakSelf noteContentChangeAtPath:filePath];
+	}];
+	
+	writer.manager = self;
+	
+	if (writer != nil)
+	{
+		TOMLogInfo(@"[TOMFileManager] INFO: Opened buffered writer: '%@' (%lu byte buffer, flushed every %.3fs).", filePath, (unsigned long)[writer bufferSize], flushInterval);
+	}
+	
+	return writer;
+}
+
+
+
+
+- (NSInteger)maximumConcurrentOperations
+{
+	return operationQueue.maxConcurrentOperationCount;
+}
+
+
+
+
+- (void)setMaximumConcurrentOperations:(NSInteger)maximumConcurrentOperations
+{
+	TOMLogInfo(@"[TOMFileManager] INFO: Setting maximum concurrent operations to: '%ld'.", (long)maximumConcurrentOperations);
+	
+	
+	operationQueue.maxConcurrentOperationCount = MAX(maximumConcurrentOperations, 1);
+}
+
+
+
+
+- (void)createDirectoryAtPath:(NSString *)newDirectoryPath completionHandler:(void (^)(BOOL success))completionHandler
+{
+	[self performOperation:^BOOL{
+		return [self createDirectoryAtPath:newDirectoryPath];
+	} completionHandler:completionHandler];
+}
+
+
+
+
+- (void)copyDirectoryFrom:(NSString *)sourceDirectoryPath to:(NSString *)destinationDirectoryPath completionHandler:(void (^)(BOOL success))completionHandler
+{
+	[self performOperation:^BOOL{
+		return [self copyDirectoryFrom:sourceDirectoryPath to:destinationDirectoryPath];
+	} completionHandler:completionHandler];
+}
+
+
+
+
+- (void)moveDirectoryFrom:(NSString *)sourceDirectoryPath to:(NSString *)destinationDirectoryPath completionHandler:(void (^)(BOOL success))completionHandler
+{
+	[self performOperation:^BOOL{
+		return [self moveDirectoryFrom:sourceDirectoryPath to:destinationDirectoryPath];
+	} completionHandler:completionHandler];
+}
+
+
+
+
+- (void)deleteDirectory:(NSString *)directoryPath completionHandler:(void (^)(BOOL success))completionHandler
+{
+	[self performOperation:^BOOL{
+		return [self deleteDirectory:directoryPath];
+	} completionHandler:completionHandler];
+}
+
+
+
+
+- (void)findAndGetPathForFileNamed:(NSString *)filename completionHandler:(void (^)(NSString *filePath))completionHandler
+{
+	[self performOperationReturningObject:^id{
+		return [self findAndGetPathForFileNamed:filename];
+	} completionHandler:completionHandler];
+}
+
+
+
+
+- (void)copyFileAtPath:(NSString *)filePath to:(NSString *)destinationDirectoryPath completionHandler:(void (^)(BOOL success))completionHandler
+{
+	[self performOperation:^BOOL{
+		return [self copyFileAtPath:filePath to:destinationDirectoryPath];
+	} completionHandler:completionHandler];
+}
+
+
+
+
+- (void)moveFileAtPath:(NSString *)filePath to:(NSString *)destinationDirectoryPath completionHandler:(void (^)(BOOL success))completionHandler
+{
+	[self performOperation:^BOOL{
+		return [self moveFileAtPath:filePath to:destinationDirectoryPath];
+	} completionHandler:completionHandler];
+}
+
+
+
+
+- (void)deleteFileAtPath:(NSString *)filePath completionHandler:(void (^)(BOOL success))completionHandler
+{
+	[self performOperation:^BOOL{
+		return [self deleteFileAtPath:filePath];
+	} completionHandler:completionHandler];
+}
+
+
+
+
+- (void)retrieveDataForFileAtPath:(NSString *)filePath completionHandler:(void (^)(NSData *data))completionHandler
+{
+	[self performOperationReturningObject:^id{
+		return [self retrieveDataForFileAtPath:filePath];
+	} completionHandler:completionHandler];
+}
+
+
+
+
+- (void)writeData:(NSData *)data toFileAtPath:(NSString *)filePath options:(TOMWriteOptions)options completionHandler:(void (^)(BOOL success))completionHandler
+{
+	[self performOperation:^BOOL{
+		return [self writeData:data toFileAtPath:filePath options:options];
+	} completionHandler:completionHandler];
+}
+
+
+
+
+- (void)sizeOfDirectoryAtPath:(NSString *)directoryPath completionHandler:(void (^)(TOMDirectorySize *size))completionHandler
+{
+	[self performOperationReturningObject:^id{
+		return [self sizeOfDirectoryAtPath:directoryPath];
+	} completionHandler:completionHandler];
+}
+
+
+
+
+- (void)waitUntilAllOperationsAreFinished
+{
+	[operationQueue waitUntilAllOperationsAreFinished];
+}
+
+
+
+
++ (BOOL)isMetricsEnabled
+{
+	return atomic_load(&TOMMetricsEnabled);
+}
+
+
+
+
++ (void)enableMetrics
+{
+	atomic_store(&TOMMetricsEnabled, YES);
+}
+
+
+
+
++ (void)disableMetrics
+{
+	atomic_store(&TOMMetricsEnabled, NO);
+}
+
+
+
+
++ (void)resetMetrics
+{
+	for (NSInteger counter = 0; counter < TOMMetricsCounterCount; counter++)
+	{
+		atomic_store_explicit(&TOMMetricsCounters[counter], 0, memory_order_relaxed);
+	}
+	
+	for (NSInteger method = 0; method < TOMMetricsMethodCount; method++)
+	{
+		atomic_store_explicit(&TOMMetricsMethods[method].calls, 0, memory_order_relaxed);
+		atomic_store_explicit(&TOMMetricsMethods[method].totalNanoseconds, 0, memory_order_relaxed);
+		
+		for (int bucket = 0; bucket < TOMMetricsLatencyBucketCount; bucket++)
+		{
+			atomic_store_explicit(&TOMMetricsMethods[method].latencyBuckets[bucket], 0, memory_order_relaxed);
+		}
+	}
+}
+
+
+
+
++ (NSDictionary<NSString *, id> *)metricsSnapshot
+{
+	NSMutableDictionary *counters = [[NSMutableDictionary alloc] initWithCapacity:TOMMetricsCounterCount];
+	NSMutableDictionary *methods = [[NSMutableDictionary alloc] init];
+	
+	
+	for (NSInteger counter = 0; counter < TOMMetricsCounterCount; counter++)
+	{
+		[counters setObject:@(atomic_load_explicit(&TOMMetricsCounters[counter], memory_order_relaxed)) forKey:@(TOMMetricsCounterNames[counter])];
+	}
+	
+	
+	for (NSInteger method = 0; method < TOMMetricsMethodCount; method++)
+	{
+		TOMMethodMetrics *metrics = &TOMMetricsMethods[method];
+		unsigned long long buckets[TOMMetricsLatencyBucketCount];
+		unsigned long long calls = 0;
+		
+		// Read the buckets rather than `calls`, so the percentiles are taken over a consistent total
+		for (int bucket = 0; bucket < TOMMetricsLatencyBucketCount; bucket++)
+		{
+			buckets[bucket] = atomic_load_explicit(&metrics->latencyBuckets[bucket], memory_order_relaxed);
+			calls += buckets[bucket];
+		}
+		
+		if (calls == 0)
+		{
+			continue;
+		}
+		
+		
+		NSMutableArray *histogram = [[NSMutableArray alloc] init];
+		unsigned long long medianBound = 0;
+		unsigned long long p99Bound = 0;
+		unsigned long long seen = 0;
+		
+		for (int bucket = 0; bucket < TOMMetricsLatencyBucketCount; bucket++)
+		{
+			if (buckets[bucket] == 0)
+			{
+				continue;
+			}
+			
+			unsigned long long upperBound = 1ULL << (bucket + 1);
+			seen += buckets[bucket];
+			
+			if (medianBound == 0 && seen * 2 >= calls)
+			{
+				medianBound = upperBound;
+			}
+			
+			if (p99Bound == 0 && seen * 100 >= calls * 99)
+			{
+				p99Bound = upperBound;
+			}
+			
+			[histogram addObject:@{ @"upperBoundNanoseconds" : @(upperBound), @"count" : @(buckets[bucket]) }];
+		}
+		
+		
+		unsigned long long totalNanoseconds = atomic_load_explicit(&metrics->totalNanoseconds, memory_order_relaxed);
+		
+		NSDictionary *methodMetrics = @{ @"calls" : @(calls), @"totalNanoseconds" : @(totalNanoseconds), @"meanNanoseconds" : @(totalNanoseconds / calls), @"p50Nanoseconds" : @(medianBound), @"p99Nanoseconds" : @(p99Bound), @"latencyHistogram" : histogram };
+		
+		[methods setObject:methodMetrics forKey:@(TOMMetricsMethodNames[method])];
+	}
+	
+	
+	return @{ @"enabled" : @([self isMetricsEnabled]), @"counters" : counters, @"methods" : methods };
+}
+
+
+
+
++ (NSData *)metricsJSONData
+{
+	// There is no manager to log at, so a failure is only reported by returning nil
+	return [NSJSONSerialization dataWithJSONObject:[self metricsSnapshot] options:NSJSONWritingSortedKeys error:NULL];
+}
+
+
+
+
+- (void)setLogLevel:(TOMLogLevel)logLevel
+{
+	_logLevel = logLevel;
+}
+
+
+
+
++ (void)setLogHandler:(void (^)(TOMLogLevel level, NSString *message))handler
+{
+	void (^handlerCopy)(TOMLogLevel, NSString *) = [handler copy];
+	
+	
+	TOMLogStart();
+	
+	dispatch_sync(TOMLogQueue, ^{
+		TOMLogHandler = handlerCopy;
+	});
+}
+
+
+
+
++ (void)flushLog
+{
+	TOMLogStart();
+	
+	dispatch_sync_f(TOMLogQueue, NULL, TOMLogDrain);
+}
+
+
+
+
+- (void)setDebugMode:(BOOL)enabled
+{
+	[self setLogLevel:enabled ? TOMLogLevelDebug : TOMLogLevelError];
+	
+	TOMLogInfo(@"[TOMFileManager] INFO: Setting debug mode to: '%@'.", enabled ? @"YES" : @"NO");
+}
+
+
+
+
+/*
+ * Walks `directoryPaths` in parallel, handing every entry to `visitor` along with the number of the task that found it.
+ *
+ * Each directory is split into one task for its own entries plus one task per immediate subdirectory, and the tasks are
+ * numbered in search order. The tasks run on a pool as wide as the CPU count. A visitor that keeps only the match from
+ * the lowest numbered task, and stops tasks numbered after it, gets exactly the result a serial walk would have given.
+ */
+- (void)performSearchOfDirectories:(NSArray *)directoryPaths usingVisitor:(TOMWalkAction (^)(long taskIndex, const TOMWalkEntry *entry))visitor
+{
+	NSMutableArray *taskPaths = [[NSMutableArray alloc] init];
+	NSMutableIndexSet *recursiveTasks = [[NSMutableIndexSet alloc] init];
+	
+	
+	for (NSString *directoryPath in directoryPaths)
+	{
+		[taskPaths addObject:directoryPath];
+		
+		TOMWalkDirectory([directoryPath fileSystemRepresentation], NO, ^TOMWalkAction(const TOMWalkEntry *entry) {
+			if (entry->type == DT_DIR && !TOMWalkEntryIsPurgeDirectory(entry))
+			{
+				NSString *subdirectoryPath = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:entry->path length:entry->pathLength];
+				
+				if (subdirectoryPath != nil)
+				{
+					[recursiveTasks addIndex:[taskPaths count]];
+					[taskPaths addObject:subdirectoryPath];
+				}
+			}
+			
+			return TOMWalkActionContinue;
+		});
 	}
-	else
+	
+	
+	dispatch_apply([taskPaths count], dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t taskIndex) {
+		BOOL recursive = [recursiveTasks containsIndex:taskIndex];
+		
+		TOMWalkDirectory([[taskPaths objectAtIndex:taskIndex] fileSystemRepresentation], recursive, ^TOMWalkAction(const TOMWalkEntry *entry) {
+			// A directory's own task only looks at its files - its subdirectories have tasks of their own
+			if (!recursive && entry->type == DT_DIR)
+			{
+				return TOMWalkActionContinue;
+			}
+			
+			// Purge directories can sit at any depth, and nothing in them is still meant to exist
+			if (TOMWalkEntryIsPurgeDirectory(entry))
+			{
+				return TOMWalkActionSkipDescendants;
+			}
+			
+			return visitor((long)taskIndex, entry);
+		});
+	});
+}
+
+
+
+
+/*
+ * Searches `directoryPaths` in parallel for the first file named `filename`. A task that finds a match cancels every task
+ * numbered after it, so the result is deterministic.
+ */
+- (NSString *)searchDirectories:(NSArray *)directoryPaths forFileNamed:(NSString *)filename
+{
+	NSMutableArray *matcherStorage = [[NSMutableArray alloc] init];
+	TOMFilenameMatcher matcher = TOMFilenameMatcherMake(filename, matcherStorage);
+	NSMutableDictionary *taskResults = [[NSMutableDictionary alloc] init];
+	
+	_Atomic long firstMatchingTask = LONG_MAX;
+	_Atomic long *firstMatchingTaskPointer = &firstMatchingTask;
+	
+	
+	[self performSearchOfDirectories:directoryPaths usingVisitor:^TOMWalkAction(long taskIndex, const TOMWalkEntry *entry) {
+		// An earlier task already has a match, so nothing this task finds can win
+		if (atomic_load(firstMatchingTaskPointer) < taskIndex)
+		{
+			return TOMWalkActionStop;
+		}
+		
+		if (entry->type == DT_DIR || !TOMFilenameMatcherMatches(&matcher, entry))
+		{
+			return TOMWalkActionContinue;
+		}
+		
+		
+		NSString *foundPath = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:entry->path length:entry->pathLength];
+		
+		@synchronized (taskResults)
+		{
+			[taskResults setObject:foundPath forKey:@(taskIndex)];
+		}
+		
+		long currentFirst = atomic_load(firstMatchingTaskPointer);
+		
+		while (taskIndex < currentFirst && !atomic_compare_exchange_weak(firstMatchingTaskPointer, &currentFirst, taskIndex))
+		{
+		}
+		
+		return TOMWalkActionStop;
+	}];
+	
+	
+	long winningTask = atomic_load(&firstMatchingTask);
+	
+	if (winningTask == LONG_MAX)
 	{
-		NSLog(@"ERROR: File Found But Not Returned");
-		return NULL;
+		return nil;
 	}
+	
+	return [taskResults objectForKey:@(winningTask)];
 }
 
 
 
 
-- (BOOL)copyFileAtPath:(NSString *)filePath to:(NSString *)destinationDirectoryPath
+/*
+ * Searches `directoryPaths` for every file named in `filenames` in a single parallel pass. Each name keeps the match from
+ * the lowest numbered task, and once every name has a match, the tasks those matches came from and everything after
+ * them stop.
+ */
+- (NSDictionary *)searchDirectories:(NSArray *)directoryPaths forFilesNamed:(NSArray *)filenames
 {
-	return [self copyFileAtPath:filePath to:destinationDirectoryPath regardlessOfType:NO];
+	NSUInteger filenameCount = [filenames count];
+	NSMutableArray *matcherStorage = [[NSMutableArray alloc] init];
+	TOMFilenameSet filenameSet = TOMFilenameSetMake(filenames, matcherStorage);
+	NSMutableArray *foundPaths = [[NSMutableArray alloc] initWithCapacity:filenameCount];
+	__block NSUInteger resolvedCount = 0;
+	
+	_Atomic long *matchingTasks = malloc(MAX(filenameCount, 1) * sizeof(_Atomic long));
+	_Atomic long firstUnneededTask = LONG_MAX;
+	_Atomic long *firstUnneededTaskPointer = &firstUnneededTask;
+	
+	
+	for (NSUInteger filenameIndex = 0; filenameIndex < filenameCount; filenameIndex++)
+	{
+		atomic_init(&matchingTasks[filenameIndex], LONG_MAX);
+		[foundPaths addObject:[NSNull null]];
+	}
+	
+	
+	[self performSearchOfDirectories:directoryPaths usingVisitor:^TOMWalkAction(long taskIndex, const TOMWalkEntry *entry) {
+		if (atomic_load(firstUnneededTaskPointer) <= taskIndex)
+		{
+			return TOMWalkActionStop;
+		}
+		
+		if (entry->type == DT_DIR)
+		{
+			return TOMWalkActionContinue;
+		}
+		
+		
+		size_t probe = SIZE_MAX;
+		NSUInteger filenameIndex;
+		
+		while ((filenameIndex = TOMFilenameSetNextMatch(&filenameSet, entry, &probe)) != NSNotFound)
+		{
+			if (atomic_load(&matchingTasks[filenameIndex]) <= taskIndex)
+			{
+				continue;
+			}
+			
+			NSString *foundPath = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:entry->path length:entry->pathLength];
+			
+			@synchronized (foundPaths)
+			{
+				if (atomic_load(&matchingTasks[filenameIndex]) > taskIndex)
+				{
+					if (atomic_load(&matchingTasks[filenameIndex]) == LONG_MAX)
+					{
+						resolvedCount++;
+					}
+					
+					atomic_store(&matchingTasks[filenameIndex], taskIndex);
+					[foundPaths replaceObjectAtIndex:filenameIndex withObject:foundPath];
+					
+					if (resolvedCount == filenameCount)
+					{
+						long lastMatchingTask = 0;
+						
+						for (NSUInteger resolvedIndex = 0; resolvedIndex < filenameCount; resolvedIndex++)
+						{
+							lastMatchingTask = MAX(lastMatchingTask, atomic_load(&matchingTasks[resolvedIndex]));
+						}
+						
+						// Every name already has its final match, and later matches within a task never replace earlier ones
+						atomic_store(firstUnneededTaskPointer, lastMatchingTask);
+					}
+				}
+			}
+		}
+		
+		return TOMWalkActionContinue;
+	}];
+	
+	
+	NSMutableDictionary *pathsForFilenames = [[NSMutableDictionary alloc] initWithCapacity:resolvedCount];
+	
+	for (NSUInteger filenameIndex = 0; filenameIndex < filenameCount; filenameIndex++)
+	{
+		if ([foundPaths objectAtIndex:filenameIndex] != [NSNull null])
+		{
+			[pathsForFilenames setObject:[foundPaths objectAtIndex:filenameIndex] forKey:[filenames objectAtIndex:filenameIndex]];
+		}
+	}
+	
+	
+	free(matchingTasks);
+	TOMFilenameSetFree(&filenameSet);
+	
+	return pathsForFilenames;
+}
+
+
+
+
+/*
+ * Runs `operation` on the manager's operation queue, then hands its result to `completionHandler` on the main queue.
+ */
+- (void)performOperation:(BOOL (^)(void))operation completionHandler:(void (^)(BOOL success))completionHandler
+{
+	[operationQueue addOperationWithBlock:^{
+		BOOL success = operation();
+		
+		
+		if (completionHandler != nil)
+		{
+			dispatch_async(dispatch_get_main_queue(), ^{
+				completionHandler(success);
+			});
+		}
+	}];
+}
+
+
+
+
+/*
+ * The same as performOperation:completionHandler:, for operations that return an object (or nil on failure).
+ */
+- (void)performOperationReturningObject:(id (^)(void))operation completionHandler:(void (^)(id result))completionHandler
+{
+	[operationQueue addOperationWithBlock:^{
+		id result = operation();
+		
+		
+		if (completionHandler != nil)
+		{
+			dispatch_async(dispatch_get_main_queue(), ^{
+				completionHandler(result);
+			});
+		}
+	}];
+}
+
+
+
+
+/*
+ * Copies the tree at `sourceDirectoryPath` to `destinationDirectoryPath`, which must not exist yet unless `resuming`.
+ *
+ * The calling thread walks the source and creates the destination's directories as it goes, handing every other entry to
+ * a pool of TOMCopyWorkerCount workers, so the walk and the data transfer overlap. Files are copied with copyfile(3),
+ * which clones them when the volume supports it. Directories are created owner-writable and only get the source's mode,
+ * owner and times once everything inside them has been copied.
+ *
+ * With `removeSource` this is the cross-volume half of a move: each file is unlinked as soon as its copy is complete, and
+ * the source's directories are removed at the end. With `resuming` as well, the move's journal says the destination
+ * holds part of the tree from an interrupted run. Its directories are reused, and a file already there with the source's
+ * size and modification time is taken as copied (copyfile sets the time last, so a half written file never matches).
+ * Without a journal, nothing already at the destination can be told apart from the caller's own data, so the transfer
+ * refuses to start.
+ */
+- (BOOL)performTransferOfDirectoryAtPath:(NSString *)sourceDirectoryPath toPath:(NSString *)destinationDirectoryPath removingSource:(BOOL)removeSource resuming:(BOOL)resuming report:(TOMTransferReport **)report
+{
+	const char *sourceRoot = [sourceDirectoryPath fileSystemRepresentation];
+	const char *destinationRoot = [destinationDirectoryPath fileSystemRepresentation];
+	size_t sourceRootLength = strlen(sourceRoot);
+	size_t destinationRootLength = strlen(destinationRoot);
+	char destinationPathBuffer[PATH_MAX];
+	char *destinationPath = destinationPathBuffer;
+	struct stat destinationStat;
+	NSString *operationName = removeSource ? @"move" : @"copy";
+	CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+	
+	
+	// Entry paths start with the source root as the walk sees it, which has no trailing slash
+	while (sourceRootLength > 1 && sourceRoot[sourceRootLength - 1] == '/')
+	{
+		sourceRootLength--;
+	}
+	
+	if (sourceRootLength == 1)
+	{
+		sourceRootLength = 0;
+	}
+	
+	while (destinationRootLength > 1 && destinationRoot[destinationRootLength - 1] == '/')
+	{
+		destinationRootLength--;
+	}
+	
+	
+	if (!resuming)
+	{
+		TOMMetricsCount(TOMMetricsCounterStatCalls, 1);
+		
+		if (lstat(destinationRoot, &destinationStat) == 0)
+		{
+			TOMLogError(@"[TOMFileManager] ERROR: Could not %@ directory: '%@'.", operationName, sourceDirectoryPath);
+			
+			TOMLogDebug(@"   MOST LIKELY REASON: Destination already exists.");
+			
+			return NO;
+		}
+	}
+	
+	int mkdirError = (destinationRootLength >= PATH_MAX) ? ENAMETOOLONG : 0;
+	
+	if (mkdirError == 0)
+	{
+		TOMMetricsCount(TOMMetricsCounterMkdirCalls, 1);
+		
+		if (mkdir(destinationRoot, S_IRWXU) != 0 && !(resuming && errno == EEXIST))
+		{
+			mkdirError = errno;
+		}
+	}
+	
+	if (mkdirError != 0)
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not %@ directory: '%@'.", operationName, sourceDirectoryPath);
+		TOMLogError(@"   RESULTING ERROR: %s", strerror(mkdirError));
+		
+		return NO;
+	}
+	
+	memcpy(destinationPath, destinationRoot, destinationRootLength);
+	destinationPath[destinationRootLength] = '\0';
+	
+	
+	NSMutableArray *copiedDirectories = [[NSMutableArray alloc] initWithObjects:@"", nil];
+	NSMutableArray *failures = [[NSMutableArray alloc] init];
+	dispatch_queue_t workerQueue = dispatch_get_global_queue(QOS_CLASS_UTILITY, 0);
+	dispatch_semaphore_t workerSlots = dispatch_semaphore_create(TOMCopyWorkerCount);
+	dispatch_group_t workers = dispatch_group_create();
+	
+	_Atomic BOOL failed = NO;
+	_Atomic BOOL *failedPointer = &failed;
+	_Atomic unsigned long fileCount = 0;
+	_Atomic unsigned long *fileCountPointer = &fileCount;
+	_Atomic unsigned long long byteCount = 0;
+	_Atomic unsigned long long *byteCountPointer = &byteCount;
+	
+	
+	void (^recordFailure)(const char *, int) = ^(const char *path, int failureError) {
+		NSString *failedPath = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:path length:strlen(path)];
+		
+		@synchronized (failures)
+		{
+			[failures addObject:@[failedPath ?: @"", @(failureError)]];
+		}
+		
+		atomic_store(failedPointer, YES);
+	};
+	
+	
+	TOMWalkDirectory(sourceRoot, YES, ^TOMWalkAction(const TOMWalkEntry *entry) {
+		if (atomic_load(failedPointer))
+		{
+			return TOMWalkActionStop;
+		}
+		
+		size_t relativeLength = entry->pathLength - sourceRootLength;
+		
+		if (destinationRootLength + relativeLength >= PATH_MAX)
+		{
+			recordFailure(entry->path, ENAMETOOLONG);
+			return TOMWalkActionStop;
+		}
+		
+		memcpy(destinationPath + destinationRootLength, entry->path + sourceRootLength, relativeLength + 1);
+		
+		
+		if (entry->type == DT_DIR)
+		{
+			// The walk quietly skips directories it can't open, which a copy can't afford to do
+			TOMMetricsCount(TOMMetricsCounterAccessCalls, 1);
+			
+			if (access(entry->path, R_OK | X_OK) != 0)
+			{
+				recordFailure(entry->path, errno);
+				return TOMWalkActionStop;
+			}
+			
+			TOMMetricsCount(TOMMetricsCounterMkdirCalls, 1);
+			
+			if (mkdir(destinationPath, S_IRWXU) != 0 && !(resuming && errno == EEXIST))
+			{
+				recordFailure(entry->path, errno);
+				return TOMWalkActionStop;
+			}
+			
+			NSString *relativePath = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:entry->path + sourceRootLength length:relativeLength];
+			
+			if (relativePath != nil)
+			{
+				[copiedDirectories addObject:relativePath];
+			}
+			
+			return TOMWalkActionContinue;
+		}
+		
+		
+		char *sourceFilePath = strdup(entry->path);
+		char *destinationFilePath = strdup(destinationPath);
+		
+		dispatch_semaphore_wait(workerSlots, DISPATCH_TIME_FOREVER);
+		
+		dispatch_group_async(workers, workerQueue, ^{
+			struct stat sourceStat;
+			struct stat existingStat;
+			BOOL needsCopy = YES;
+			int copyError = 0;
+			
+			
+			if (!atomic_load(failedPointer))
+			{
+				TOMMetricsCount(TOMMetricsCounterStatCalls, 1);
+				
+				if (lstat(sourceFilePath, &sourceStat) != 0)
+				{
+					copyError = errno;
+				}
+				else if (resuming)
+				{
+					TOMMetricsCount(TOMMetricsCounterStatCalls, 1);
+					
+					// Left over from an interrupted move, so keep it if it's complete and copy it again if it isn't
+					if (lstat(destinationFilePath, &existingStat) == 0)
+					{
+						needsCopy = (existingStat.st_size != sourceStat.st_size || TOMModificationTimeOfStat(&existingStat) != TOMModificationTimeOfStat(&sourceStat));
+						
+						if (needsCopy)
+						{
+							TOMMetricsCount(TOMMetricsCounterUnlinkCalls, 1);
+							
+							if (unlink(destinationFilePath) != 0)
+							{
+								copyError = errno;
+							}
+						}
+					}
+				}
+				
+				if (copyError == 0 && needsCopy)
+				{
+					TOMMetricsCount(TOMMetricsCounterCopyfileCalls, 1);
+					
+					if (copyfile(sourceFilePath, destinationFilePath, NULL, COPYFILE_ALL | COPYFILE_CLONE) != 0)
+					{
+						copyError = errno;
+					}
+				}
+				
+				if (copyError == 0 && removeSource)
+				{
+					TOMMetricsCount(TOMMetricsCounterUnlinkCalls, 1);
+					
+					if (unlink(sourceFilePath) != 0)
+					{
+						copyError = errno;
+					}
+				}
+				
+				
+				if (copyError == 0)
+				{
+					atomic_fetch_add(fileCountPointer, 1);
+					
+					if (S_ISREG(sourceStat.st_mode))
+					{
+						atomic_fetch_add(byteCountPointer, (unsigned long long)sourceStat.st_size);
+						TOMMetricsCount(TOMMetricsCounterBytesWritten, (uint64_t)sourceStat.st_size);
+					}
+				}
+				else
+				{
+					recordFailure(sourceFilePath, copyError);
+				}
+			}
+			
+			free(sourceFilePath);
+			free(destinationFilePath);
+			dispatch_semaphore_signal(workerSlots);
+		});
+		
+		return TOMWalkActionContinue;
+	});
+	
+	
+	dispatch_group_wait(workers, DISPATCH_TIME_FOREVER);
+	
+	
+	// Deepest first, so that setting a directory's times isn't undone by writing into it afterwards
+	for (NSString *relativePath in [copiedDirectories reverseObjectEnumerator])
+	{
+		NSString *sourcePath = [sourceDirectoryPath stringByAppendingString:relativePath];
+		NSString *destinationDirectory = [destinationDirectoryPath stringByAppendingString:relativePath];
+		
+		TOMMetricsCount(TOMMetricsCounterCopyfileCalls, 1);
+		copyfile([sourcePath fileSystemRepresentation], [destinationDirectory fileSystemRepresentation], NULL, COPYFILE_METADATA);
+		
+		if (removeSource && !atomic_load(&failed))
+		{
+			TOMMetricsCount(TOMMetricsCounterUnlinkCalls, 1);
+			
+			if (rmdir([sourcePath fileSystemRepresentation]) != 0)
+			{
+				recordFailure([sourcePath fileSystemRepresentation], errno);
+			}
+		}
+	}
+	
+	
+	if (atomic_load(&failed))
+	{
+		NSArray *failure = [failures firstObject];
+		
+		TOMLogError(@"[TOMFileManager] ERROR: Could not %@ directory: '%@'.", operationName, sourceDirectoryPath);
+		TOMLogError(@"   RESULTING ERROR: Could not %@ '%@': %s", operationName, failure[0], strerror([failure[1] intValue]));
+		
+		return NO;
+	}
+	
+	
+	TOMTransferReport *transferReport = [[TOMTransferReport alloc] init];
+	transferReport.numberOfFiles = atomic_load(&fileCount);
+	transferReport.numberOfBytes = atomic_load(&byteCount);
+	transferReport.duration = CFAbsoluteTimeGetCurrent() - startTime;
+	
+	TOMLogInfo(@"[TOMFileManager] INFO: Finished %@ of directory: '%@' (%@).", operationName, sourceDirectoryPath, transferReport);
+	
+	if (report != NULL)
+	{
+		*report = transferReport;
+	}
+	
+	
+	return YES;
 }
 
 
 
-- (BOOL)copyFileAtPath:(NSString *)filePath to:(NSString *)destinationDirectoryPath regardlessOfType:(BOOL)ignoreType
+
+/*
+ * Brings the tree at `destinationDirectoryPath` up to date with the one at `sourceDirectoryPath`, creating it if needed.
+ *
+ * The calling thread walks the source and creates missing directories as it goes, handing every other entry to a pool of
+ * TOMCopyWorkerCount workers. Each worker compares its entry with whatever is at the same place in the destination, and
+ * only copies it when that is missing or differs. copyfile(3) keeps the source's modification time, so a file copied by
+ * one sync compares equal on the next. With TOMSyncOptionsDeleteExtraneous the destination is walked afterwards, and
+ * anything without a counterpart in the source is removed.
+ */
+- (BOOL)performSyncOfDirectoryAtPath:(NSString *)sourceDirectoryPath toPath:(NSString *)destinationDirectoryPath options:(TOMSyncOptions)options report:(TOMSyncReport **)report
 {
-	NSError *error;
-	BOOL sourceIsDirectory = true;
-	BOOL destinationIsDirectory = true;
-	NSString *correctedDestinationDirectoryPath;
+	const char *sourceRoot = [sourceDirectoryPath fileSystemRepresentation];
+	const char *destinationRoot = [destinationDirectoryPath fileSystemRepresentation];
+	size_t sourceRootLength = strlen(sourceRoot);
+	size_t destinationRootLength = strlen(destinationRoot);
+	char destinationPathBuffer[PATH_MAX];
+	char *destinationPath = destinationPathBuffer;
+	char sourcePathBuffer[PATH_MAX];
+	char *sourcePath = sourcePathBuffer;
+	BOOL compareContents = (options & TOMSyncOptionsCompareContents) != 0;
+	CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
 	
 	
-	if (![[NSFileManager defaultManager] fileExistsAtPath:destinationDirectoryPath isDirectory:&destinationIsDirectory])
+	// Entry paths start with the root as the walk sees it, which has no trailing slash
+	while (sourceRootLength > 1 && sourceRoot[sourceRootLength - 1] == '/')
 	{
-		[self createDirectoryAtPath:destinationDirectoryPath];
-		correctedDestinationDirectoryPath = [destinationDirectoryPath stringByAppendingPathComponent:[filePath lastPathComponent]];
+		sourceRootLength--;
 	}
-	else
+	
+	if (sourceRootLength == 1)
 	{
-		if (destinationIsDirectory)
-		{
-			correctedDestinationDirectoryPath = [destinationDirectoryPath stringByAppendingPathComponent:[filePath lastPathComponent]];
-		}
-		else
-		{
-			correctedDestinationDirectoryPath = destinationDirectoryPath;
-		}
+		sourceRootLength = 0;
 	}
 	
+	while (destinationRootLength > 1 && destinationRoot[destinationRootLength - 1] == '/')
+	{
+		destinationRootLength--;
+	}
 	
-	if (debugMode)
+	if (destinationRootLength == 1)
 	{
-		NSLog(@"[TOMFileManager] INFO: Full path of file copy: '%@'.", correctedDestinationDirectoryPath);
+		destinationRootLength = 0;
 	}
 	
 	
-	if ([[NSFileManager defaultManager] fileExistsAtPath:filePath isDirectory:&sourceIsDirectory])
+	int mkdirError = (sourceRootLength >= PATH_MAX || destinationRootLength >= PATH_MAX) ? ENAMETOOLONG : 0;
+	
+	if (mkdirError == 0)
+	{
+		TOMMetricsCount(TOMMetricsCounterMkdirCalls, 1);
+		
+		if (mkdir(destinationRoot, S_IRWXU) != 0 && errno != EEXIST)
+		{
+			mkdirError = errno;
+		}
+	}
+	
+	if (mkdirError != 0)
 	{
-		if ([[NSFileManager defaultManager] isReadableFileAtPath:filePath])
+		TOMLogError(@"[TOMFileManager] ERROR: Could not sync directory: '%@'.", sourceDirectoryPath);
+		TOMLogError(@"   RESULTING ERROR: %s", strerror(mkdirError));
+		
+		return NO;
+	}
+	
+	memcpy(destinationPath, destinationRoot, destinationRootLength);
+	destinationPath[destinationRootLength] = '\0';
+	memcpy(sourcePath, sourceRoot, sourceRootLength);
+	sourcePath[sourceRootLength] = '\0';
+	
+	
+	NSMutableArray *syncedDirectories = [[NSMutableArray alloc] initWithObjects:@"", nil];
+	NSMutableArray *failures = [[NSMutableArray alloc] init];
+	dispatch_queue_t workerQueue = dispatch_get_global_queue(QOS_CLASS_UTILITY, 0);
+	dispatch_semaphore_t workerSlots = dispatch_semaphore_create(TOMCopyWorkerCount);
+	dispatch_group_t workers = dispatch_group_create();
+	
+	_Atomic BOOL failed = NO;
+	_Atomic BOOL *failedPointer = &failed;
+	_Atomic unsigned long copiedFileCount = 0;
+	_Atomic unsigned long *copiedFileCountPointer = &copiedFileCount;
+	_Atomic unsigned long long copiedByteCount = 0;
+	_Atomic unsigned long long *copiedByteCountPointer = &copiedByteCount;
+	_Atomic unsigned long skippedFileCount = 0;
+	_Atomic unsigned long *skippedFileCountPointer = &skippedFileCount;
+	_Atomic unsigned long long skippedByteCount = 0;
+	_Atomic unsigned long long *skippedByteCountPointer = &skippedByteCount;
+	__block unsigned long deletedCount = 0;
+	
+	
+	void (^recordFailure)(const char *, int) = ^(const char *path, int failureError) {
+		NSString *failedPath = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:path length:strlen(path)];
+		
+		@synchronized (failures)
+		{
+			[failures addObject:@[failedPath ?: @"", @(failureError)]];
+		}
+		
+		atomic_store(failedPointer, YES);
+	};
+	
+	
+	TOMWalkDirectory(sourceRoot, YES, ^TOMWalkAction(const TOMWalkEntry *entry) {
+		if (atomic_load(failedPointer))
+		{
+			return TOMWalkActionStop;
+		}
+		
+		if (TOMWalkEntryIsPurgeDirectory(entry))
+		{
+			return TOMWalkActionSkipDescendants;
+		}
+		
+		size_t relativeLength = entry->pathLength - sourceRootLength;
+		
+		if (destinationRootLength + relativeLength >= PATH_MAX)
+		{
+			recordFailure(entry->path, ENAMETOOLONG);
+			return TOMWalkActionStop;
+		}
+		
+		memcpy(destinationPath + destinationRootLength, entry->path + sourceRootLength, relativeLength + 1);
+		
+		
+		if (entry->type == DT_DIR)
 		{
-			if (!sourceIsDirectory)
+			struct stat existingStat;
+			
+			// The walk quietly skips directories it can't open, which would look like everything in them was deleted
+			TOMMetricsCount(TOMMetricsCounterAccessCalls, 1);
+			
+			if (access(entry->path, R_OK | X_OK) != 0)
 			{
-				if (debugMode)
-				{
-					NSLog(@"[TOMFileManager] INFO: Copying file: '%@'.\nTo: '%@'.", filePath, correctedDestinationDirectoryPath);
-				}
-				
-				[[NSFileManager defaultManager] copyItemAtPath:filePath toPath:destinationDirectoryPath error:&error];
+				recordFailure(entry->path, errno);
+				return TOMWalkActionStop;
+			}
+			
+			// Something that isn't a directory is in the way, left from when the source had a file here
+			TOMMetricsCount(TOMMetricsCounterStatCalls, 1);
+			
+			if (lstat(destinationPath, &existingStat) == 0 && !S_ISDIR(existingStat.st_mode))
+			{
+				int removeError = TOMRemoveEntry(AT_FDCWD, destinationPath, IFTODT(existingStat.st_mode));
 				
-				if (error)
+				if (removeError != 0)
 				{
-					NSLog(@"[TOMFileManager] ERROR: Could not copy file: '%@'.", filePath);
-					NSLog(@"   RESULTING ERROR: %@", error);
-					
-					return NO;
+					recordFailure(destinationPath, removeError);
+					return TOMWalkActionStop;
 				}
-				
-				return YES;
 			}
-			else
+			
+			TOMMetricsCount(TOMMetricsCounterMkdirCalls, 1);
+			
+			if (mkdir(destinationPath, S_IRWXU) != 0 && errno != EEXIST)
 			{
-				if (ignoreType)
+				recordFailure(destinationPath, errno);
+				return TOMWalkActionStop;
+			}
+			
+			NSString *relativePath = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:entry->path + sourceRootLength length:relativeLength];
+			
+			if (relativePath != nil)
+			{
+				[syncedDirectories addObject:relativePath];
+			}
+			
+			return TOMWalkActionContinue;
+		}
+		
+		
+		char *sourceFilePath = strdup(entry->path);
+		char *destinationFilePath = strdup(destinationPath);
+		
+		dispatch_semaphore_wait(workerSlots, DISPATCH_TIME_FOREVER);
+		
+		dispatch_group_async(workers, workerQueue, ^{
+			struct stat sourceStat;
+			struct stat existingStat;
+			BOOL upToDate = NO;
+			int syncError = 0;
+			
+			
+			if (!atomic_load(failedPointer))
+			{
+				TOMMetricsCount(TOMMetricsCounterStatCalls, 1);
+				
+				if (lstat(sourceFilePath, &sourceStat) != 0)
 				{
-					if (debugMode)
-					{
-						NSLog(@"[TOMFileManager] INFO: Copying file: '%@'.\nTo directory: '%@'.", filePath, destinationDirectoryPath);
-					}
-					
-					[[NSFileManager defaultManager] copyItemAtPath:filePath toPath:destinationDirectoryPath error:&error];
+					syncError = errno;
+				}
+				else
+				{
+					TOMMetricsCount(TOMMetricsCounterStatCalls, 1);
 					
-					if (error)
+					if (lstat(destinationFilePath, &existingStat) == 0)
 					{
-						NSLog(@"[TOMFileManager] ERROR: Could not copy file: '%@'.", filePath);
-						NSLog(@"   RESULTING ERROR: %@", error);
+						if ((existingStat.st_mode & S_IFMT) == (sourceStat.st_mode & S_IFMT) && existingStat.st_size == sourceStat.st_size)
+						{
+							if (compareContents && S_ISREG(sourceStat.st_mode))
+							{
+								upToDate = TOMFileContentsAreEqual(sourceFilePath, destinationFilePath);
+								
+								// Give it the source's times, so the next sync without content comparison sees it as unchanged too
+								if (upToDate && TOMModificationTimeOfStat(&existingStat) != TOMModificationTimeOfStat(&sourceStat))
+								{
+									TOMMetricsCount(TOMMetricsCounterCopyfileCalls, 1);
+									copyfile(sourceFilePath, destinationFilePath, NULL, COPYFILE_METADATA);
+								}
+							}
+							else
+							{
+								upToDate = (TOMModificationTimeOfStat(&existingStat) == TOMModificationTimeOfStat(&sourceStat));
+							}
+						}
 						
-						return NO;
+						if (!upToDate)
+						{
+							syncError = TOMRemoveEntry(AT_FDCWD, destinationFilePath, IFTODT(existingStat.st_mode));
+						}
 					}
+				}
+				
+				
+				if (syncError == 0 && !upToDate)
+				{
+					TOMMetricsCount(TOMMetricsCounterCopyfileCalls, 1);
 					
-					return YES;
+					if (copyfile(sourceFilePath, destinationFilePath, NULL, COPYFILE_ALL | COPYFILE_CLONE) != 0)
+					{
+						syncError = errno;
+					}
+				}
+				
+				
+				if (syncError != 0)
+				{
+					recordFailure(sourceFilePath, syncError);
+				}
+				else if (upToDate)
+				{
+					atomic_fetch_add(skippedFileCountPointer, 1);
+					atomic_fetch_add(skippedByteCountPointer, S_ISREG(sourceStat.st_mode) ? (unsigned long long)sourceStat.st_size : 0);
 				}
 				else
 				{
-					NSLog(@"[TOMFileManager] ERROR: Could not copy file: '%@'.", filePath);
+					atomic_fetch_add(copiedFileCountPointer, 1);
 					
-					if (debugMode)
+					if (S_ISREG(sourceStat.st_mode))
 					{
-						NSLog(@"   MOST LIKELY REASON: Source is not a file.");
+						atomic_fetch_add(copiedByteCountPointer, (unsigned long long)sourceStat.st_size);
+						TOMMetricsCount(TOMMetricsCounterBytesWritten, (uint64_t)sourceStat.st_size);
 					}
-					
-					return NO;
 				}
 			}
+			
+			free(sourceFilePath);
+			free(destinationFilePath);
+			dispatch_semaphore_signal(workerSlots);
+		});
+		
+		return TOMWalkActionContinue;
+	});
+	
+	
+	dispatch_group_wait(workers, DISPATCH_TIME_FOREVER);
+	
+	
+	if ((options & TOMSyncOptionsDeleteExtraneous) && !atomic_load(&failed))
+	{
+		TOMWalkDirectory(destinationRoot, YES, ^TOMWalkAction(const TOMWalkEntry *entry) {
+			struct stat sourceStat;
+			size_t relativeLength = entry->pathLength - destinationRootLength;
+			
+			
+			if (TOMWalkEntryIsPurgeDirectory(entry) || sourceRootLength + relativeLength >= PATH_MAX)
+			{
+				return TOMWalkActionSkipDescendants;
+			}
+			
+			memcpy(sourcePath + sourceRootLength, entry->path + destinationRootLength, relativeLength + 1);
+			
+			TOMMetricsCount(TOMMetricsCounterStatCalls, 1);
+			
+			if (lstat(sourcePath, &sourceStat) == 0 || errno != ENOENT)
+			{
+				return TOMWalkActionContinue;
+			}
+			
+			
+			int removeError = TOMRemoveEntry(AT_FDCWD, entry->path, entry->type);
+			
+			if (removeError != 0 && removeError != ENOENT)
+			{
+				recordFailure(entry->path, removeError);
+				return TOMWalkActionStop;
+			}
+			
+			deletedCount++;
+			
+			return TOMWalkActionSkipDescendants;
+		});
+	}
+	
+	
+	// Deepest first, so that setting a directory's times isn't undone by writing into it afterwards
+	for (NSString *relativePath in [syncedDirectories reverseObjectEnumerator])
+	{
+		NSString *sourceDirectory = [sourceDirectoryPath stringByAppendingString:relativePath];
+		NSString *destinationDirectory = [destinationDirectoryPath stringByAppendingString:relativePath];
+		
+		TOMMetricsCount(TOMMetricsCounterCopyfileCalls, 1);
+		
+		copyfile([sourceDirectory fileSystemRepresentation], [destinationDirectory fileSystemRepresentation], NULL, COPYFILE_METADATA);
+	}
+	
+	
+	if (atomic_load(&failed))
+	{
+		NSArray *failure = [failures firstObject];
+		
+		TOMLogError(@"[TOMFileManager] ERROR: Could not sync directory: '%@'.", sourceDirectoryPath);
+		TOMLogError(@"   RESULTING ERROR: Could not sync '%@': %s", failure[0], strerror([failure[1] intValue]));
+		
+		return NO;
+	}
+	
+	
+	TOMSyncReport *syncReport = [[TOMSyncReport alloc] init];
+	syncReport.numberOfFilesCopied = atomic_load(&copiedFileCount);
+	syncReport.numberOfBytesCopied = atomic_load(&copiedByteCount);
+	syncReport.numberOfFilesSkipped = atomic_load(&skippedFileCount);
+	syncReport.numberOfBytesSkipped = atomic_load(&skippedByteCount);
+	syncReport.numberOfItemsDeleted = deletedCount;
+	syncReport.duration = CFAbsoluteTimeGetCurrent() - startTime;
+	
+	TOMLogInfo(@"[TOMFileManager] INFO: Finished sync of directory: '%@' (%@).", sourceDirectoryPath, syncReport);
+	
+	if (report != NULL)
+	{
+		*report = syncReport;
+	}
+	
+	
+	return YES;
+}
+
+
+
+
+/*
+ * Moves the item at `sourcePath` to `destinationPath`, which must not exist yet unless an interrupted move of the same
+ * item left it behind.
+ *
+ * Within a volume this is a single rename, so it is atomic and takes the same time for any size of tree. Across volumes
+ * a file is copied and unlinked, and a directory goes through performTransferOfDirectoryAtPath: with a journal kept in
+ * the Library's Caches directory until the move is done. If the app dies part way through, the next move of the same
+ * item (or resumeInterruptedMoves) finds the journal and picks up where it stopped.
+ */
+- (BOOL)performMoveOfItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath report:(TOMTransferReport **)report
+{
+	NSString *journalPath = [self journalPathForMoveFrom:sourcePath to:destinationPath];
+	NSDictionary *journal = [NSDictionary dictionaryWithContentsOfFile:journalPath];
+	BOOL resuming = [[journal objectForKey:@"Source"] isEqualToString:sourcePath] && [[journal objectForKey:@"Destination"] isEqualToString:destinationPath];
+	TOMTransferReport *transferReport = [[TOMTransferReport alloc] init];
+	CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+	struct stat sourceStat;
+	struct stat destinationStat;
+	
+	
+	TOMMetricsCount(TOMMetricsCounterStatCalls, 1);
+	
+	if (lstat([sourcePath fileSystemRepresentation], &sourceStat) != 0)
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not move: '%@'.", sourcePath);
+		TOMLogError(@"   RESULTING ERROR: %s", strerror(errno));
+		
+		return NO;
+	}
+	
+	
+	if (!resuming)
+	{
+		TOMMetricsCount(TOMMetricsCounterRenameCalls, 1);
+		
+		if (renamex_np([sourcePath fileSystemRepresentation], [destinationPath fileSystemRepresentation], RENAME_EXCL) == 0)
+		{
+			transferReport.numberOfFiles = 1;
+			transferReport.duration = CFAbsoluteTimeGetCurrent() - startTime;
+			transferReport.strategy = TOMCopyStrategyRename;
+			
+			if (report != NULL)
+			{
+				*report = transferReport;
+			}
+			
+			return YES;
 		}
-		else
+		
+		if (errno != EXDEV)
+		{
+			TOMLogError(@"[TOMFileManager] ERROR: Could not move: '%@'.", sourcePath);
+			TOMLogError(@"   RESULTING ERROR: %s", strerror(errno));
+			
+			return NO;
+		}
+		
+		
+		// RENAME_EXCL only protects the destination on the same volume, so the copy has to refuse it just the same
+		TOMMetricsCount(TOMMetricsCounterStatCalls, 1);
+		
+		if (lstat([destinationPath fileSystemRepresentation], &destinationStat) == 0)
+		{
+			TOMLogError(@"[TOMFileManager] ERROR: Could not move: '%@'.", sourcePath);
+			TOMLogError(@"   RESULTING ERROR: %s", strerror(EEXIST));
+			
+			return NO;
+		}
+	}
+	
+	
+	TOMLogInfo(@"[TOMFileManager] INFO: %@ across volumes: '%@'.", resuming ? @"Resuming move" : @"Moving", sourcePath);
+	
+	
+	if (!S_ISDIR(sourceStat.st_mode))
+	{
+		TOMCopyStrategy strategy = TOMCopyStrategyNone;
+		unsigned long long bytesCopied = 0;
+		int moveError = TOMCopyFileContents([sourcePath fileSystemRepresentation], [destinationPath fileSystemRepresentation], &strategy, &bytesCopied);
+		
+		if (moveError == 0)
 		{
-			NSLog(@"[TOMFileManager] ERROR: Could not copy file: '%@'.\nTo: '%@'.", filePath, correctedDestinationDirectoryPath);
+			TOMMetricsCount(TOMMetricsCounterUnlinkCalls, 1);
 			
-			if (debugMode)
+			if (unlink([sourcePath fileSystemRepresentation]) != 0)
 			{
-				NSLog(@"   MOST LIKELY REASON: Permissions Error.");
+				moveError = errno;
 			}
+		}
+		
+		if (moveError != 0)
+		{
+			TOMLogError(@"[TOMFileManager] ERROR: Could not move: '%@'.", sourcePath);
+			TOMLogError(@"   RESULTING ERROR: %s", strerror(moveError));
 			
 			return NO;
 		}
+		
+		transferReport.numberOfFiles = 1;
+		transferReport.numberOfBytes = bytesCopied;
+		transferReport.duration = CFAbsoluteTimeGetCurrent() - startTime;
 	}
 	else
 	{
-		NSLog(@"[TOMFileManager] ERROR: Could not copy file: '%@'.", filePath);
+		if (!resuming)
+		{
+			[[NSFileManager defaultManager] createDirectoryAtPath:[journalPath stringByDeletingLastPathComponent] withIntermediateDirectories:YES attributes:nil error:nil];
+			
+			if (![@{@"Source" : sourcePath, @"Destination" : destinationPath} writeToFile:journalPath atomically:YES])
+			{
+				TOMLogInfo(@"[TOMFileManager] INFO: Could not write move journal, so this move can't be resumed: '%@'.", journalPath);
+			}
+		}
+		
+		if (![self performTransferOfDirectoryAtPath:sourcePath toPath:destinationPath removingSource:YES resuming:resuming report:&transferReport])
+		{
+			return NO;
+		}
+		
+		[[NSFileManager defaultManager] removeItemAtPath:journalPath error:nil];
+	}
+	
+	
+	transferReport.strategy = TOMCopyStrategyCopyAndDelete;
+	
+	if (report != NULL)
+	{
+		*report = transferReport;
+	}
+	
+	
+	return YES;
+}
+
+
+
+
+/*
+ * Journals are named after a hash of the move, so that a retried move finds its own journal without a directory scan.
+ */
+- (NSString *)journalPathForMoveFrom:(NSString *)sourcePath to:(NSString *)destinationPath
+{
+	NSString *moveKey = [NSString stringWithFormat:@"%@\n%@", sourcePath, destinationPath];
+	const char *moveKeyBytes = [moveKey UTF8String];
+	NSString *journalName = [NSString stringWithFormat:@"%016llx.plist", (unsigned long long)TOMHashBytes(moveKeyBytes, strlen(moveKeyBytes))];
+	
+	
+	return [[self moveJournalDirectory] stringByAppendingPathComponent:journalName];
+}
+
+
+
+
+- (NSString *)moveJournalDirectory
+{
+	return [_libraryDirectory stringByAppendingPathComponent:@"Caches/TOMFileManager/Moves"];
+}
+
+
+
+
+/*
+ * In Caches rather than Library itself, so that directories waiting to be purged are never backed up.
+ */
+- (NSString *)purgeDirectoryPath
+{
+	return [[_libraryDirectory stringByAppendingPathComponent:@"Caches"] stringByAppendingPathComponent:@(TOMPurgeDirectoryName)];
+}
+
+
+
+
+/*
+ * Writes `data` to `filePath` with TOMWriteFile, and with TOMWriteOptionsGroupCommit, waits for the group flush that
+ * makes the write durable. Returns once the write is as durable as `options` asked for.
+ */
+- (BOOL)performWriteOfData:(NSData *)data toFileAtPath:(NSString *)filePath options:(TOMWriteOptions)options
+{
+	NSString *directoryPath = [filePath stringByDeletingLastPathComponent];
+	
+	if ([directoryPath length] == 0)
+	{
+		directoryPath = @".";
+	}
+	
+	
+	int writeError = TOMWriteFile([filePath fileSystemRepresentation], [directoryPath fileSystemRepresentation], data, options);
+	
+	if (writeError == 0 && (options & TOMWriteOptionsGroupCommit))
+	{
+		writeError = [groupCommit commitDirectoryAtPath:directoryPath];
+	}
+	
+	
+	// Even a failed write may have replaced the file, if it was only the sync afterwards that failed
+	[self noteChangeAtPath:filePath];
+	
+	if (writeError != 0)
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not write file: '%@'.", filePath);
+		TOMLogError(@"   RESULTING ERROR: %s", strerror(writeError));
 		
-		if (debugMode)
+		if (writeError == ENOENT)
 		{
-			NSLog(@"   MOST LIKELY REASON: File does not exist.");
+			TOMLogDebug(@"   MOST LIKELY REASON: Directory does not exist.");
+		}
+		else if (writeError == EISDIR)
+		{
+			TOMLogDebug(@"   MOST LIKELY REASON: Path is a directory.");
 		}
 		
 		return NO;
 	}
+	
+	
+	return YES;
 }
 
 
 
 
-- (BOOL)findAndCopyFileNamed:(NSString *)filename to:(NSString *)destinationDirectoryPath
+/*
+ * Removes the tree at `directoryPath` with one task per immediate subdirectory, run as wide as the CPU count, the same
+ * way searches are split. The directory's own files, and the directory itself, are removed once the tasks are done.
+ */
+- (BOOL)performParallelRemovalOfDirectoryAtPath:(NSString *)directoryPath
 {
-	NSString *pathOfFile = [self findAndGetPathForFileNamed:filename];
+	TOMMetricsCount(TOMMetricsCounterOpenCalls, 1);
 	
-	if (pathOfFile != nil)
+	int directoryDescriptor = open([directoryPath fileSystemRepresentation], O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+	NSMutableArray *subdirectoryNames = [[NSMutableArray alloc] init];
+	_Atomic int firstError = 0;
+	_Atomic int *firstErrorPointer = &firstError;
+	
+	
+	if (directoryDescriptor < 0)
 	{
-		return [self copyFileAtPath:pathOfFile to:destinationDirectoryPath];
+		TOMLogError(@"[TOMFileManager] ERROR: Could not delete directory: '%@'.", directoryPath);
+		TOMLogError(@"   RESULTING ERROR: %s", strerror(errno));
+		
+		return NO;
+	}
+	
+	
+	TOMWalkDirectory([directoryPath fileSystemRepresentation], NO, ^TOMWalkAction(const TOMWalkEntry *entry) {
+		if (entry->type == DT_DIR)
+		{
+			[subdirectoryNames addObject:[NSData dataWithBytes:entry->name length:entry->nameLength + 1]];
+		}
+		
+		return TOMWalkActionContinue;
+	});
+	
+	
+	dispatch_apply([subdirectoryNames count], dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^(size_t taskIndex) {
+		int removeError = TOMRemoveEntry(directoryDescriptor, [[subdirectoryNames objectAtIndex:taskIndex] bytes], DT_DIR);
+		int noError = 0;
+		
+		if (removeError != 0 && removeError != ENOENT)
+		{
+			atomic_compare_exchange_strong(firstErrorPointer, &noError, removeError);
+		}
+	});
+	
+	
+	int removeError = atomic_load(&firstError);
+	
+	if (removeError == 0)
+	{
+		removeError = TOMRemoveDirectoryContents(directoryDescriptor);
 	}
 	else
 	{
-		NSLog(@"[TOMFileManager] ERROR: Could not find and copy file: '%@'.\nTo: '%@'.", filename, destinationDirectoryPath);
+		close(directoryDescriptor);
+	}
+	
+	if (removeError == 0)
+	{
+		TOMMetricsCount(TOMMetricsCounterUnlinkCalls, 1);
 		
-		if (debugMode)
+		if (rmdir([directoryPath fileSystemRepresentation]) != 0)
 		{
-			NSLog(@"   MOST LIKELY REASON: File was not found.");
+			removeError = errno;
 		}
+	}
+	
+	
+	if (removeError != 0)
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not delete directory: '%@'.", directoryPath);
+		TOMLogError(@"   RESULTING ERROR: %s", strerror(removeError));
 		
 		return NO;
 	}
+	
+	return YES;
 }
 
 
 
 
-- (BOOL)moveFileAtPath:(NSString *)filePath to:(NSString *)destinationDirectoryPath
-{
-	return [self moveFileAtPath:filePath to:destinationDirectoryPath regardlessOfType:NO];
-}
-
-
-
-- (BOOL)moveFileAtPath:(NSString *)filePath to:(NSString *)destinationDirectoryPath regardlessOfType:(BOOL)ignoreType
+/*
+ * Renames `directoryPath` into the purge directory, which takes the same time for any size of tree, and leaves the real
+ * removal to schedulePurge. A directory on another volume than the purge directory can't be renamed into it, so it is
+ * removed in parallel on the spot instead.
+ *
+ * A directory that holds the purge directory (Library, or its Caches) can't be renamed into its own subdirectory, so
+ * everything in it but the way down to the purge directory is renamed in instead, and the directory itself stays.
+ */
+- (BOOL)performDeferredRemovalOfDirectoryAtPath:(NSString *)directoryPath
 {
-	NSError *error;
-	BOOL sourceIsDirectory = true;
-	BOOL destinationIsDirectory = true;
-	NSString *correctedDestinationDirectoryPath;
+	NSString *purgeDirectory = [self purgeDirectoryPath];
+	NSString *purgePath = [purgeDirectory stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+	NSString *standardizedPurgeDirectory = [purgeDirectory stringByStandardizingPath];
+	NSString *standardizedPath = [directoryPath stringByStandardizingPath];
 	
 	
-	if (![[NSFileManager defaultManager] fileExistsAtPath:destinationDirectoryPath isDirectory:&destinationIsDirectory])
-	{
-		[self createDirectoryAtPath:destinationDirectoryPath];
-		correctedDestinationDirectoryPath = [destinationDirectoryPath stringByAppendingPathComponent:[filePath lastPathComponent]];
-	}
-	else
+	TOMMetricsCount(TOMMetricsCounterMkdirCalls, 1);
+	
+	if (mkdir([purgeDirectory fileSystemRepresentation], S_IRWXU) != 0 && errno != EEXIST)
 	{
-		if (destinationIsDirectory)
-		{
-			correctedDestinationDirectoryPath = [destinationDirectoryPath stringByAppendingPathComponent:[filePath lastPathComponent]];
-		}
-		else
-		{
-			correctedDestinationDirectoryPath = destinationDirectoryPath;
-		}
+		TOMLogError(@"[TOMFileManager] ERROR: Could not create purge directory: '%@'.", purgeDirectory);
+		TOMLogError(@"   RESULTING ERROR: %s", strerror(errno));
+		
+		return NO;
 	}
 	
 	
-	if (debugMode)
+	if ([standardizedPurgeDirectory length] > [standardizedPath length] && TOMPathListsOverlap(@[standardizedPath], @[standardizedPurgeDirectory]))
 	{
-		NSLog(@"[TOMFileManager] INFO: Full path of file move: '%@'.", correctedDestinationDirectoryPath);
+		BOOL removed = [self performDeferredRemovalOfEntriesInDirectoryAtPath:standardizedPath keepingPath:standardizedPurgeDirectory];
+		
+		[self schedulePurge];
+		
+		return removed;
 	}
 	
 	
-	if ([[NSFileManager defaultManager] fileExistsAtPath:filePath isDirectory:&sourceIsDirectory])
+	TOMMetricsCount(TOMMetricsCounterRenameCalls, 1);
+	
+	if (rename([directoryPath fileSystemRepresentation], [purgePath fileSystemRepresentation]) != 0)
 	{
-		if ([[NSFileManager defaultManager] isReadableFileAtPath:filePath])
-		{
-			if (!sourceIsDirectory)
-			{
-				if (debugMode)
-				{
-					NSLog(@"[TOMFileManager] INFO: Moving file: '%@'.\nTo: '%@'.", filePath, correctedDestinationDirectoryPath);
-				}
-				
-				[[NSFileManager defaultManager] moveItemAtPath:filePath toPath:destinationDirectoryPath error:&error];
-				
-				if (error)
-				{
-					NSLog(@"[TOMFileManager] ERROR: Could not move file: '%@'.", filePath);
-					NSLog(@"   RESULTING ERROR: %@", error);
-					
-					return NO;
-				}
-				
-				return YES;
-			}
-			else
-			{
-				if (ignoreType)
-				{
-					if (debugMode)
-					{
-						NSLog(@"[TOMFileManager] INFO: Moving file: '%@'.\nTo directory: '%@'.", filePath, destinationDirectoryPath);
-					}
-					
-					[[NSFileManager defaultManager] moveItemAtPath:filePath toPath:destinationDirectoryPath error:&error];
-					
-					if (error)
-					{
-						NSLog(@"[TOMFileManager] ERROR: Could not move file: '%@'.", filePath);
-						NSLog(@"   RESULTING ERROR: %@", error);
-						
-						return NO;
-					}
-					
-					return YES;
-				}
-				else
-				{
-					NSLog(@"[TOMFileManager] ERROR: Could not move file: '%@'.", filePath);
-					
-					if (debugMode)
-					{
-						NSLog(@"   MOST LIKELY REASON: Source is not a file.");
-					}
-					
-					return NO;
-				}
-			}
-		}
-		else
+		if (errno == EXDEV)
 		{
-			NSLog(@"[TOMFileManager] ERROR: Could not move file: '%@'.\nTo: '%@'.", filePath, correctedDestinationDirectoryPath);
+			TOMLogInfo(@"[TOMFileManager] INFO: Directory is on another volume, so it can't be deferred: '%@'.", directoryPath);
 			
-			if (debugMode)
-			{
-				NSLog(@"   MOST LIKELY REASON: Permissions Error.");
-			}
-			
-			return NO;
+			return [self performParallelRemovalOfDirectoryAtPath:directoryPath];
 		}
-	}
-	else
-	{
-		NSLog(@"[TOMFileManager] ERROR: Could not move file: '%@'.", filePath);
 		
-		if (debugMode)
-		{
-			NSLog(@"   MOST LIKELY REASON: File does not exist.");
-		}
+		TOMLogError(@"[TOMFileManager] ERROR: Could not delete directory: '%@'.", directoryPath);
+		TOMLogError(@"   RESULTING ERROR: %s", strerror(errno));
 		
 		return NO;
 	}
+	
+	
+	[self schedulePurge];
+	
+	return YES;
 }
 
 
 
 
-- (BOOL)findAndMoveFileNamed:(NSString *)filename to:(NSString *)destinationDirectoryPath
+/*
+ * Renames every entry in `directoryPath` into the purge directory, except `keptPath` and the directories on the way down
+ * to it, whose own entries are renamed in instead. Leaves the purge itself to the caller.
+ */
+- (BOOL)performDeferredRemovalOfEntriesInDirectoryAtPath:(NSString *)directoryPath keepingPath:(NSString *)keptPath
 {
-	NSString *pathOfFile = [self findAndGetPathForFileNamed:filename];
+	NSString *purgeDirectory = [self purgeDirectoryPath];
+	NSMutableArray *entryNames = [[NSMutableArray alloc] init];
 	
-	if (pathOfFile != nil)
-	{
-		return [self moveFileAtPath:pathOfFile to:destinationDirectoryPath];
-	}
-	else
+	
+	TOMWalkDirectory([directoryPath fileSystemRepresentation], NO, ^TOMWalkAction(const TOMWalkEntry *entry) {
+		NSString *entryName = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:entry->name length:entry->nameLength];
+		
+		if (entryName != nil)
+		{
+			[entryNames addObject:entryName];
+		}
+		
+		return TOMWalkActionContinue;
+	});
+	
+	
+	for (NSString *entryName in entryNames)
 	{
-		NSLog(@"[TOMFileManager] ERROR: Could not find and move file: '%@'.\nTo: '%@'.", filename, destinationDirectoryPath);
+		NSString *entryPath = [directoryPath stringByAppendingPathComponent:entryName];
+		NSString *purgePath = [purgeDirectory stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
 		
-		if (debugMode)
+		if ([entryPath isEqualToString:keptPath])
 		{
-			NSLog(@"   MOST LIKELY REASON: File was not found.");
+			continue;
 		}
 		
-		return NO;
+		if (TOMPathListsOverlap(@[entryPath], @[keptPath]))
+		{
+			if (![self performDeferredRemovalOfEntriesInDirectoryAtPath:entryPath keepingPath:keptPath])
+			{
+				return NO;
+			}
+			
+			continue;
+		}
+		
+		
+		TOMMetricsCount(TOMMetricsCounterRenameCalls, 1);
+		
+		if (rename([entryPath fileSystemRepresentation], [purgePath fileSystemRepresentation]) != 0)
+		{
+			TOMLogError(@"[TOMFileManager] ERROR: Could not delete directory: '%@'.", directoryPath);
+			TOMLogError(@"   RESULTING ERROR: Could not delete '%@': %s", entryPath, strerror(errno));
+			
+			return NO;
+		}
 	}
+	
+	
+	return YES;
 }
 
 
 
 
-- (BOOL)deleteFileAtPath:(NSString *)filePath
+/*
+ * Empties the purge directory on a background queue. Every manager in the process shares one serial queue for this, and
+ * since a manager schedules a purge when it is created, anything left over from an earlier run is picked up too.
+ */
+- (void)schedulePurge
 {
-	return [self deleteFileAtPath:filePath regardlessOfType:NO];
+	static dispatch_queue_t purgeQueue;
+	static dispatch_once_t onceToken;
+	NSString *purgeDirectory = [self purgeDirectoryPath];
+	
+	
+	dispatch_once(&onceToken, ^{
+		purgeQueue = dispatch_queue_create("TOMFileManager.purge", dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_BACKGROUND, 0));
+	});
+	
+	
+	dispatch_async(purgeQueue, ^{
+		int directoryDescriptor = open([purgeDirectory fileSystemRepresentation], O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+		
+		if (directoryDescriptor < 0)
+		{
+			return;
+		}
+		
+		
+		int removeError = TOMRemoveDirectoryContents(directoryDescriptor);
+		
+		if (removeError != 0)
+		{
+			TOMLogError(@"[TOMFileManager] ERROR: Could not purge deleted directories: '%@'.", purgeDirectory);
+			TOMLogError(@"   RESULTING ERROR: %s", strerror(removeError));
+		}
+		else
+		{
+			TOMLogInfo(@"[TOMFileManager] INFO: Purged deleted directories: '%@'.", purgeDirectory);
+		}
+	});
 }
 
 
 
 
-- (BOOL)deleteFileAtPath:(NSString *)filePath regardlessOfType:(BOOL)ignoreType
+/*
+ * Runs one operation of a batch, trusting the metadata performOperations: already resolved instead of checking again.
+ */
+- (BOOL)executeOperation:(TOMFileOperation *)operation targetPath:(NSString *)targetPath source:(TOMResolvedPath)source destination:(TOMResolvedPath)destination
 {
-	NSError *error;
-	BOOL sourceIsDirectory = false;
+	NSString *operationName = @[@"copy", @"move", @"delete"][operation.type];
+	
+	
+	if (!source.exists || (operation.type != TOMFileOperationTypeDelete && !source.isReadable))
+	{
+		TOMLogError(@"[TOMFileManager] ERROR: Could not %@: '%@'.", operationName, operation.sourcePath);
+		
+		TOMLogDebug(@"   MOST LIKELY REASON: %@", source.exists ? @"Permissions Error." : @"File does not exist.");
+		
+		return NO;
+	}
+	
+	
+	if (operation.type != TOMFileOperationTypeDelete && !destination.exists)
+	{
+		[[NSFileManager defaultManager] createDirectoryAtPath:operation.destinationDirectoryPath withIntermediateDirectories:YES attributes:nil error:nil];
+	}
 	
 	
-	if ([[NSFileManager defaultManager] fileExistsAtPath:filePath isDirectory:&sourceIsDirectory])
+	switch (operation.type)
 	{
-		if (!sourceIsDirectory)
+		case TOMFileOperationTypeCopy:
 		{
-			if (debugMode)
+			if (source.isDirectory)
 			{
-				NSLog(@"[TOMFileManager] INFO: Deleting file: '%@'.\n", filePath);
+				if (TOMPathListsOverlap(@[[operation.sourcePath stringByStandardizingPath]], @[[targetPath stringByStandardizingPath]]))
+				{
+					TOMLogError(@"[TOMFileManager] ERROR: Could not copy directory: '%@'.", operation.sourcePath);
+					
+					TOMLogDebug(@"   MOST LIKELY REASON: One directory is inside the other.");
+					
+					return NO;
+				}
+				
+				return [self performTransferOfDirectoryAtPath:operation.sourcePath toPath:targetPath removingSource:NO resuming:NO report:NULL];
 			}
 			
-			[[NSFileManager defaultManager] removeItemAtPath:filePath error:&error];
+			TOMCopyStrategy strategy;
+			unsigned long long bytesCopied;
+			int copyError = TOMCopyFileContents([operation.sourcePath fileSystemRepresentation], [targetPath fileSystemRepresentation], &strategy, &bytesCopied);
 			
-			if (error)
+			if (copyError != 0)
 			{
-				NSLog(@"[TOMFileManager] ERROR: Could not delete directory: '%@'.", filePath);
-				NSLog(@"   RESULTING ERROR: %@", error);
+				TOMLogError(@"[TOMFileManager] ERROR: Could not copy file: '%@'.", operation.sourcePath);
+				TOMLogError(@"   RESULTING ERROR: %s", strerror(copyError));
 				
 				return NO;
 			}
 			
 			return YES;
 		}
-		else
+		
+		case TOMFileOperationTypeMove:
+			return [self performMoveOfItemAtPath:operation.sourcePath toPath:targetPath report:NULL];
+		
+		case TOMFileOperationTypeDelete:
 		{
-			if (ignoreType)
+			if (source.isDirectory)
 			{
-				if (debugMode)
-				{
-					NSLog(@"[TOMFileManager] INFO: Deleting file: '%@'.\n", filePath);
-				}
-				
-				[[NSFileManager defaultManager] removeItemAtPath:filePath error:&error];
-				
-				if (error)
-				{
-					NSLog(@"[TOMFileManager] ERROR: Could not delete file: '%@'.", filePath);
-					NSLog(@"   RESULTING ERROR: %@", error);
-					
-					return NO;
-				}
-				
-				return YES;
+				return [self performParallelRemovalOfDirectoryAtPath:operation.sourcePath];
 			}
-			else
+			
+			TOMMetricsCount(TOMMetricsCounterUnlinkCalls, 1);
+			
+			if (unlink([operation.sourcePath fileSystemRepresentation]) != 0)
 			{
-				NSLog(@"[TOMFileManager] ERROR: Could not delete directory: '%@'.", filePath);
+				int unlinkError = errno;
 				
-				if (debugMode)
-				{
-					NSLog(@"   MOST LIKELY REASON: It is not a directory.");
-				}
+				TOMLogError(@"[TOMFileManager] ERROR: Could not delete file: '%@'.", operation.sourcePath);
+				TOMLogError(@"   RESULTING ERROR: %s", strerror(unlinkError));
 				
 				return NO;
 			}
+			
+			return YES;
 		}
 	}
-	else
-	{
-		NSLog(@"[TOMFileManager] ERROR: Could not delete file: '%@'.", filePath);
-		
-		if (debugMode)
-		{
-			NSLog(@"   MOST LIKELY REASON: File does not exist.");
-		}
-		
-		return NO;
-	}
+	
+	
+	return NO;
 }
 
 
 
 
-- (BOOL)findAndDeleteFileNamed:(NSString *)filename
+/*
+ * Existence, type and readability of a path, from the metadata cache when it is enabled and has a live entry.
+ */
+- (TOMFileMetadata)metadataForPath:(NSString *)path
 {
-	NSString *pathOfFile = [self findAndGetPathForFileNamed:filename];
+	TOMFileMetadata metadata = {0};
+	TOMMetadataCache *cache = metadataCache;
 	
 	
-	if (pathOfFile != nil)
+	if ([path length] == 0)
 	{
-		return [self deleteFileAtPath:pathOfFile];
+		return metadata;
 	}
-	else
+	
+	// Keyed the same way changes are noted, so "a//b" or "a/./b" can't hide a stale entry from them
+	NSString *standardizedPath = [path stringByStandardizingPath];
+	
+	if ([cache getMetadata:&metadata forPath:standardizedPath])
 	{
-		NSLog(@"[TOMFileManager] ERROR: Could not find and delte file: '%@'.", filename);
-		
-		if (debugMode)
-		{
-			NSLog(@"   MOST LIKELY REASON: File was not found.");
-		}
-		
-		return NO;
+		return metadata;
 	}
+	
+	
+	metadata = TOMFileMetadataAtPath([path fileSystemRepresentation]);
+	[cache setMetadata:metadata forPath:standardizedPath];
+	
+	return metadata;
 }
 
 
 
 
-- (BOOL)fileExistsAtPath:(NSString *)filePath
-{
-	return [[NSFileManager defaultManager] fileExistsAtPath:filePath];
-}
-
-
-
-
-- (NSUInteger)numberOfFilesInDirectoryAtPath:(NSString *)directoryPath
+/*
+ * Called with the directories a watch saw change, whoever changed them. Each of them only had entries added, removed or
+ * renamed, so the filename index and size cache only need to look at the directory itself.
+ */
+- (void)noteChangesInDirectoriesAtPaths:(NSSet *)directoryPaths
 {
-	return [[[NSFileManager defaultManager] contentsOfDirectoryAtPath:directoryPath error:nil] count];
+	for (NSString *directoryPath in directoryPaths)
+	{
+		[filenameIndex noteChangeInDirectoryAtPath:directoryPath];
+		[metadataCache noteChangeAtPath:directoryPath];
+		[directorySizeCache removeEntryForPath:directoryPath];
+	}
 }
 
 
 
 
-- (NSData*)retrieveDataForFileAtPath:(NSString *)filePath
+/*
+ * Called after every successful mutation, so that state the manager keeps about the sandbox stays current.
+ */
+- (void)noteChangeAtPath:(NSString *)path
 {
-	if ([self fileExistsAtPath:filePath])
-	{
-		return [NSData dataWithContentsOfFile:filePath];
-	}
-	else
-	{
-		return NULL;
-	}
+	[filenameIndex noteChangeAtPath:path];
+	[metadataCache noteChangeAtPath:path];
+	[directorySizeCache noteChangeAtPath:[path stringByStandardizingPath]];
 }
 
 
 
 
-- (void)setDebugMode:(BOOL *)debugMode
+/*
+ * Called after data was written into the file at `path` without adding, removing or renaming anything. The directory
+ * is unchanged, so only the file's metadata and the size of its directory are stale.
+ */
+- (void)noteContentChangeAtPath:(NSString *)path
 {
-	if (debugMode)
-	{
-		NSLog(@"[TOMFileManager] INFO: Setting debug mode to: '%@'.", debugMode ? @"YES" : @"NO");
-	}
-	
-	
-	self.debugMode = debugMode;
+	[metadataCache removeMetadataForPath:path];
+	[directorySizeCache removeEntryForPath:[[path stringByStandardizingPath] stringByDeletingLastPathComponent]];
 }
 
 
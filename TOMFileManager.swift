@@ -40,6 +40,38 @@ class TOMFileManager : NSObject
 	
 	/// This property enables or disables additional logging
 	var debugMode : Bool
+	{
+		get
+		{
+			return logLevel >= .info
+		}
+		
+		set
+		{
+			logLevel = newValue ? .debug : .error
+		}
+	}
+	
+	/// How much this manager logs. Defaults to `.error`, and `debugMode` switches between `.error` and `.debug`.
+	var logLevel : TOMLogLevel = .error
+	
+	/// The maximum number of `async` operations this manager runs at once. Defaults to 4, and can't be less than 1.
+	var maximumConcurrentOperations : Int
+	{
+		get
+		{
+			return operationQueue.maxConcurrentOperationCount
+		}
+		
+		set
+		{
+			operationQueue.maxConcurrentOperationCount = max(newValue, 1)
+		}
+	}
+	
+	
+	/// The queue the `async` operations run on
+	private let operationQueue : OperationQueue
 	
 	
 	
@@ -61,9 +93,6 @@ class TOMFileManager : NSObject
 		var paths : Array<Any>
 		
 		
-		debugMode = false
-		
-		
 		paths =  NSSearchPathForDirectoriesInDomains(.documentDirectory, .userDomainMask, true)
 		documentsDirectory = paths[0] as! String
 		
@@ -76,6 +105,12 @@ class TOMFileManager : NSObject
 		
 		
 		tempDirectory = FileManager.default.temporaryDirectory.path
+		
+		
+		operationQueue = OperationQueue()
+		operationQueue.name = "TOMFileManager.operations"
+		operationQueue.qualityOfService = .utility
+		operationQueue.maxConcurrentOperationCount = 4
 	}
 	
 	
@@ -110,11 +145,11 @@ class TOMFileManager : NSObject
 		}
 		else
 		{
-			NSLog("[TOMFileManager] ERROR: Could not create directory: '%@'.", newDirectoryPath)
+			logMessage(.error, "[TOMFileManager] ERROR: Could not create directory: '%@'.", newDirectoryPath)
 			
 			if debugMode
 			{
-				NSLog("   MOST LIKELY REASON: Directory already exists.");
+				logMessage(.debug, "   MOST LIKELY REASON: Directory already exists.");
 			}
 		}
 	}
@@ -219,7 +254,7 @@ class TOMFileManager : NSObject
 			{
 				if debugMode
 				{
-					NSLog("[TOMFileManager] INFO: Copying contents of directory: '%@'.\nTo directory: '%@'.", sourceDirectoryPath, destinationDirectoryPath)
+					logMessage(.info, "[TOMFileManager] INFO: Copying contents of directory: '%@'.\nTo directory: '%@'.", sourceDirectoryPath, destinationDirectoryPath)
 				}
 				
 				try FileManager.default.copyItem(atPath: sourceDirectoryPath, toPath: destinationDirectoryPath)
@@ -230,29 +265,29 @@ class TOMFileManager : NSObject
 				{
 					if debugMode
 					{
-						NSLog("[TOMFileManager] INFO: Copying contents of directory: '%@'.\nTo directory: '%@'.", sourceDirectoryPath, destinationDirectoryPath);
+						logMessage(.info, "[TOMFileManager] INFO: Copying contents of directory: '%@'.\nTo directory: '%@'.", sourceDirectoryPath, destinationDirectoryPath);
 					}
 					
 					try FileManager.default.copyItem(atPath: sourceDirectoryPath, toPath: destinationDirectoryPath)
 				}
 				else
 				{
-					NSLog("[TOMFileManager] ERROR: Could not copy directory: '%@'.", sourceDirectoryPath)
+					logMessage(.error, "[TOMFileManager] ERROR: Could not copy directory: '%@'.", sourceDirectoryPath)
 					
 					if debugMode
 					{
-						NSLog("   MOST LIKELY REASON: Source is not a directory.")
+						logMessage(.debug, "   MOST LIKELY REASON: Source is not a directory.")
 					}
 				}
 			}
 		}
 		else
 		{
-			NSLog("[TOMFileManager] ERROR: Could not copy directory: '%@'.", sourceDirectoryPath)
+			logMessage(.error, "[TOMFileManager] ERROR: Could not copy directory: '%@'.", sourceDirectoryPath)
 			
 			if debugMode
 			{
-				NSLog("   MOST LIKELY REASON: Directory does not exist.")
+				logMessage(.debug, "   MOST LIKELY REASON: Directory does not exist.")
 			}
 		}
 	}
@@ -319,7 +354,7 @@ class TOMFileManager : NSObject
 			{
 				if (debugMode)
 				{
-					NSLog("[TOMFileManager] INFO: Moving contents of directory: '%@'.\nTo directory: '%@'.", sourceDirectoryPath, destinationDirectoryPath);
+					logMessage(.info, "[TOMFileManager] INFO: Moving contents of directory: '%@'.\nTo directory: '%@'.", sourceDirectoryPath, destinationDirectoryPath);
 				}
 				
 				try FileManager.default.moveItem(atPath: sourceDirectoryPath, toPath: destinationDirectoryPath)
@@ -330,29 +365,29 @@ class TOMFileManager : NSObject
 				{
 					if (debugMode)
 					{
-						NSLog("[TOMFileManager] INFO: Moving contents of directory: '%@'.\nTo directory: '%@'.", sourceDirectoryPath, destinationDirectoryPath);
+						logMessage(.info, "[TOMFileManager] INFO: Moving contents of directory: '%@'.\nTo directory: '%@'.", sourceDirectoryPath, destinationDirectoryPath);
 					}
 					
 					try FileManager.default.moveItem(atPath: sourceDirectoryPath, toPath: destinationDirectoryPath)
 				}
 				else
 				{
-					NSLog("[TOMFileManager] ERROR: Could not move directory: '%@'.", sourceDirectoryPath)
+					logMessage(.error, "[TOMFileManager] ERROR: Could not move directory: '%@'.", sourceDirectoryPath)
 					
 					if debugMode
 					{
-						NSLog("   MOST LIKELY REASON: Source is not a directory.");
+						logMessage(.debug, "   MOST LIKELY REASON: Source is not a directory.");
 					}
 				}
 			}
 		}
 		else
 		{
-			NSLog("[TOMFileManager] ERROR: Could not move directory: '%@'.", sourceDirectoryPath)
+			logMessage(.error, "[TOMFileManager] ERROR: Could not move directory: '%@'.", sourceDirectoryPath)
 			
 			if debugMode
 			{
-				NSLog("   MOST LIKELY REASON: Directory does not exist.");
+				logMessage(.debug, "   MOST LIKELY REASON: Directory does not exist.");
 			}
 		}
 	}
@@ -396,7 +431,7 @@ class TOMFileManager : NSObject
 	manager.renameDirectory(atPath: directoryToRename, to: "RenamedDirectory", regardlessOfType: true);
 	```
 	
-	- Remark: Under the hood, what this really does is creates a new directory at the same level as `directoryPath` with the name of `newName`, then moves the contents of `directoryPath` to `newName`'s directory.
+	- Remark: The rename is a single atomic system call, and fails if something named `newName` already exists.
 	
 	- Warning: Do not attempt to use this method to rename files.
 	- Warning: Ignoring the type if not recommended. Do so at your own risk.
@@ -430,11 +465,10 @@ class TOMFileManager : NSObject
 			{
 				if debugMode
 				{
-					NSLog("[TOMFileManager] INFO: Renaming directory: '%@'.\nTo: '%@'.", directoryPath, pathOfNewName);
+					logMessage(.info, "[TOMFileManager] INFO: Renaming directory: '%@'.\nTo: '%@'.", directoryPath, pathOfNewName);
 				}
 				
-				try createDirectory(atPath: pathOfNewName)
-				try moveDirectory(from: directoryPath, to: pathOfNewName)
+				try renameItem(atPath: directoryPath, toPath: pathOfNewName, options: .noReplace)
 			}
 			else
 			{
@@ -442,30 +476,87 @@ class TOMFileManager : NSObject
 				{
 					if debugMode
 					{
-						NSLog("[TOMFileManager] INFO: Renaming directory: '%@'.\nTo: '%@'.", directoryPath, pathOfNewName);
+						logMessage(.info, "[TOMFileManager] INFO: Renaming directory: '%@'.\nTo: '%@'.", directoryPath, pathOfNewName);
 					}
 					
-					try createDirectory(atPath: pathOfNewName)
-					try moveDirectory(from: directoryPath, to: pathOfNewName, regardlessOfType: true)
+					try renameItem(atPath: directoryPath, toPath: pathOfNewName, options: .noReplace)
 				}
 				else
 				{
-					NSLog("[TOMFileManager] ERROR: Could not rename directory: '%@'.", directoryPath)
+					logMessage(.error, "[TOMFileManager] ERROR: Could not rename directory: '%@'.", directoryPath)
 					
 					if debugMode
 					{
-						NSLog("   MOST LIKELY REASON: Path is not a directory.");
+						logMessage(.debug, "   MOST LIKELY REASON: Path is not a directory.");
 					}
 				}
 			}
 		}
 		else
 		{
-			NSLog("[TOMFileManager] ERROR: Could not rename directory: '%@'.", directoryPath)
+			logMessage(.error, "[TOMFileManager] ERROR: Could not rename directory: '%@'.", directoryPath)
+			
+			if debugMode
+			{
+				logMessage(.debug, "   MOST LIKELY REASON: Directory does not exist.");
+			}
+		}
+	}
+	
+	
+	
+	
+	/**
+	Renames the directory located at `directoryPath` to `newName`, using `options`.
+	
+	Renames the directory with a single atomic system call, so it is never half renamed and nothing is ever copied. With `.exchange` this publishes a freshly built directory over a live one, without any moment where readers see a half built tree.
+	
+	```
+	// Build the new version next to the live one, then swap them
+	try manager.renameDirectory(atPath: stagingDirectoryPath, to: "Live", options: .exchange)
+	try manager.deleteDirectory(atPath: stagingDirectoryPath)
+	```
+	
+	- Note: After an exchange, `directoryPath` holds what used to be at `newName`.
+	
+	- Parameter directoryPath: The path of the directory you'd like to rename.
+	- Parameter newName: The new name you'd like to give the directory.
+	- Parameter options: Whether an existing directory named `newName` may be replaced, or should be exchanged with.
+	
+	- Returns: `Void` - Nothing to return since errors are handled with `try` / `catch`.
+	*/
+	func renameDirectory(atPath directoryPath : String, to newName : String, options : TOMRenameOptions) throws
+	{
+		var sourceIsDirectory : ObjCBool = false
+		var pathOfNewName : String
+		
+		
+		if newName.hasPrefix("/")
+		{
+			pathOfNewName = ((directoryPath as NSString).deletingLastPathComponent as NSString).appending(newName)
+		}
+		else
+		{
+			pathOfNewName = ((directoryPath as NSString).deletingLastPathComponent as NSString).appendingPathComponent(newName)
+		}
+		
+		
+		if FileManager.default.fileExists(atPath: directoryPath, isDirectory: &sourceIsDirectory) && sourceIsDirectory.boolValue
+		{
+			if debugMode
+			{
+				logMessage(.info, "[TOMFileManager] INFO: Renaming directory: '%@'.\nTo: '%@'.", directoryPath, pathOfNewName);
+			}
+			
+			try renameItem(atPath: directoryPath, toPath: pathOfNewName, options: options)
+		}
+		else
+		{
+			logMessage(.error, "[TOMFileManager] ERROR: Could not rename directory: '%@'.", directoryPath)
 			
 			if debugMode
 			{
-				NSLog("   MOST LIKELY REASON: Directory does not exist.");
+				logMessage(.debug, "   MOST LIKELY REASON: Directory does not exist, or it is not a directory.");
 			}
 		}
 	}
@@ -524,7 +615,7 @@ class TOMFileManager : NSObject
 			{
 				if debugMode
 				{
-					NSLog("[TOMFileManager] INFO: Deleting directory: '%@'.", directoryPath);
+					logMessage(.info, "[TOMFileManager] INFO: Deleting directory: '%@'.", directoryPath);
 				}
 				
 				try FileManager.default.removeItem(atPath: directoryPath)
@@ -535,29 +626,29 @@ class TOMFileManager : NSObject
 				{
 					if debugMode
 					{
-						NSLog("[TOMFileManager] INFO: Deleting directory: '%@'.", directoryPath);
+						logMessage(.info, "[TOMFileManager] INFO: Deleting directory: '%@'.", directoryPath);
 					}
 					
 					try FileManager.default.removeItem(atPath: directoryPath)
 				}
 				else
 				{
-					NSLog("[TOMFileManager] ERROR: Could not delete directory: '%@'.", directoryPath)
+					logMessage(.error, "[TOMFileManager] ERROR: Could not delete directory: '%@'.", directoryPath)
 					
 					if debugMode
 					{
-						NSLog("   MOST LIKELY REASON: It is not a directory.");
+						logMessage(.debug, "   MOST LIKELY REASON: It is not a directory.");
 					}
 				}
 			}
 		}
 		else
 		{
-			NSLog("[TOMFileManager] ERROR: Could not delete directory: '%@'.", directoryPath)
+			logMessage(.error, "[TOMFileManager] ERROR: Could not delete directory: '%@'.", directoryPath)
 			
 			if debugMode
 			{
-				NSLog("   MOST LIKELY REASON: Directory does not exist.");
+				logMessage(.debug, "   MOST LIKELY REASON: Directory does not exist.");
 			}
 		}
 	}
@@ -593,13 +684,13 @@ class TOMFileManager : NSObject
 		{
 			if !isDirectory.boolValue
 			{
-				NSLog("[TOMFileManager] ERROR: Search Location is not a directory.")
+				logMessage(.error, "[TOMFileManager] ERROR: Search Location is not a directory.")
 				return nil
 			}
 		}
 		else
 		{
-			NSLog("[TOMFileManager] ERROR: Search Location does not exist.")
+			logMessage(.error, "[TOMFileManager] ERROR: Search Location does not exist.")
 			return nil
 		}
 		
@@ -611,7 +702,7 @@ class TOMFileManager : NSObject
 		
 		if debugMode
 		{
-			NSLog("[TOMFileManager] INFO: Retrieving file: '%@'.\nFrom directory: '%@'.", filename, directoryPath)
+			logMessage(.info, "[TOMFileManager] INFO: Retrieving file: '%@'.\nFrom directory: '%@'.", filename, directoryPath)
 		}
 		
 		
@@ -619,7 +710,7 @@ class TOMFileManager : NSObject
 		{
 			if !(try url.resourceValues(forKeys: Set(keys)).isDirectory!)
 			{
-				if url.absoluteString.hasSuffix(filename)
+				if fileURL(url, matchesFilename: filename)
 				{
 					fileFound = true
 					return url.path
@@ -630,13 +721,13 @@ class TOMFileManager : NSObject
 		
 		if !fileFound
 		{
-			NSLog("[TOMFileManager] ERROR: File not found.")
+			logMessage(.error, "[TOMFileManager] ERROR: File not found.")
 			return nil
 		}
 		else
 		{
 			// This should never be the case - but just to be safe
-			NSLog("[TOMFileManager] ERROR: File found, but not returned.")
+			logMessage(.error, "[TOMFileManager] ERROR: File found, but not returned.")
 			return nil
 		}
 	}
@@ -688,18 +779,18 @@ class TOMFileManager : NSObject
 		
 		if debugMode
 		{
-			NSLog("[TOMFileManager] INFO: Searching Documents Directory for file: '%@'.", filename)
+			logMessage(.info, "[TOMFileManager] INFO: Searching Documents Directory for file: '%@'.", filename)
 		}
 		
 		for case let url as URL in documentsEnumerator!
 		{
 			if !(try url.resourceValues(forKeys: Set(keys)).isDirectory!)
 			{
-				if url.absoluteString.hasSuffix(filename)
+				if fileURL(url, matchesFilename: filename)
 				{
 					if debugMode
 					{
-						NSLog("[TOMFileManager] INFO: File found at path: '%@'.", url.path)
+						logMessage(.info, "[TOMFileManager] INFO: File found at path: '%@'.", url.path)
 					}
 					
 					fileFound = true
@@ -711,18 +802,18 @@ class TOMFileManager : NSObject
 		
 		if debugMode
 		{
-			NSLog("[TOMFileManager] INFO: Searching Resources Directory for file: '%@'.", filename);
+			logMessage(.info, "[TOMFileManager] INFO: Searching Resources Directory for file: '%@'.", filename);
 		}
 		
 		for case let url as URL in resourcesEnumerator!
 		{
 			if !(try url.resourceValues(forKeys: Set(keys)).isDirectory!)
 			{
-				if url.absoluteString.hasSuffix(filename)
+				if fileURL(url, matchesFilename: filename)
 				{
 					if debugMode
 					{
-						NSLog("[TOMFileManager] INFO: File found at path: '%@'.", url.path);
+						logMessage(.info, "[TOMFileManager] INFO: File found at path: '%@'.", url.path);
 					}
 					
 					fileFound = true
@@ -734,18 +825,18 @@ class TOMFileManager : NSObject
 		
 		if debugMode
 		{
-			NSLog("[TOMFileManager] INFO: Searching Library Directory for file: '%@'.", filename);
+			logMessage(.info, "[TOMFileManager] INFO: Searching Library Directory for file: '%@'.", filename);
 		}
 		
 		for case let url as URL in libraryEnumerator!
 		{
 			if !(try url.resourceValues(forKeys: Set(keys)).isDirectory!)
 			{
-				if url.absoluteString.hasSuffix(filename)
+				if fileURL(url, matchesFilename: filename)
 				{
 					if debugMode
 					{
-						NSLog("[TOMFileManager] INFO: File found at path: '%@'.", url.path);
+						logMessage(.info, "[TOMFileManager] INFO: File found at path: '%@'.", url.path);
 					}
 					
 					fileFound = true
@@ -757,18 +848,18 @@ class TOMFileManager : NSObject
 		
 		if debugMode
 		{
-			NSLog("[TOMFileManager] INFO: Searching Temp Directory for file: '%@'.", filename);
+			logMessage(.info, "[TOMFileManager] INFO: Searching Temp Directory for file: '%@'.", filename);
 		}
 		
 		for case let url as URL in tempEnumerator!
 		{
 			if !(try url.resourceValues(forKeys: Set(keys)).isDirectory!)
 			{
-				if url.absoluteString.hasSuffix(filename)
+				if fileURL(url, matchesFilename: filename)
 				{
 					if debugMode
 					{
-						NSLog("[TOMFileManager] INFO: File found at path: '%@'.", url.path);
+						logMessage(.info, "[TOMFileManager] INFO: File found at path: '%@'.", url.path);
 					}
 					
 					fileFound = true
@@ -780,13 +871,13 @@ class TOMFileManager : NSObject
 		
 		if !fileFound
 		{
-			NSLog("[TOMFileManager] ERROR: File not found.")
+			logMessage(.error, "[TOMFileManager] ERROR: File not found.")
 			return nil
 		}
 		else
 		{
 			// This should never be the case - but just to be safe
-			NSLog("[TOMFileManager] ERROR: File found, but not returned.")
+			logMessage(.error, "[TOMFileManager] ERROR: File found, but not returned.")
 			return nil
 		}
 	}
@@ -865,7 +956,7 @@ class TOMFileManager : NSObject
 		
 		if debugMode
 		{
-			NSLog("[TOMFileManager] INFO: Full path of file copy: '%@'.", correctedDestinationDirectoryPath)
+			logMessage(.info, "[TOMFileManager] INFO: Full path of file copy: '%@'.", correctedDestinationDirectoryPath)
 		}
 		
 		
@@ -877,7 +968,7 @@ class TOMFileManager : NSObject
 				{
 					if debugMode
 					{
-						NSLog("[TOMFileManager] INFO: Copying file: '%@'.\nTo: '%@'.", filePath, correctedDestinationDirectoryPath);
+						logMessage(.info, "[TOMFileManager] INFO: Copying file: '%@'.\nTo: '%@'.", filePath, correctedDestinationDirectoryPath);
 					}
 					
 					try FileManager.default.copyItem(atPath: filePath, toPath: correctedDestinationDirectoryPath)
@@ -888,39 +979,39 @@ class TOMFileManager : NSObject
 					{
 						if debugMode
 						{
-							NSLog("[TOMFileManager] INFO: Copying file: '%@'.\nTo: '%@'.", filePath, correctedDestinationDirectoryPath);
+							logMessage(.info, "[TOMFileManager] INFO: Copying file: '%@'.\nTo: '%@'.", filePath, correctedDestinationDirectoryPath);
 						}
 						
 						try FileManager.default.copyItem(atPath: filePath, toPath: correctedDestinationDirectoryPath)
 					}
 					else
 					{
-						NSLog("[TOMFileManager] ERROR: Could not copy file: '%@'.\nTo: '%@'.", filePath, correctedDestinationDirectoryPath)
+						logMessage(.error, "[TOMFileManager] ERROR: Could not copy file: '%@'.\nTo: '%@'.", filePath, correctedDestinationDirectoryPath)
 						
 						if debugMode
 						{
-							NSLog("   MOST LIKELY REASON: Source is not a file.");
+							logMessage(.debug, "   MOST LIKELY REASON: Source is not a file.");
 						}
 					}
 				}
 			}
 			else
 			{
-				NSLog("[TOMFileManager] ERROR: Could not copy file: '%@'.\nTo: '%@'.", filePath, correctedDestinationDirectoryPath)
+				logMessage(.error, "[TOMFileManager] ERROR: Could not copy file: '%@'.\nTo: '%@'.", filePath, correctedDestinationDirectoryPath)
 				
 				if debugMode
 				{
-					NSLog("   MOST LIKELY REASON: Permissions Error.");
+					logMessage(.debug, "   MOST LIKELY REASON: Permissions Error.");
 				}
 			}
 		}
 		else
 		{
-			NSLog("[TOMFileManager] ERROR: Could not copy file: '%@'.", filePath)
+			logMessage(.error, "[TOMFileManager] ERROR: Could not copy file: '%@'.", filePath)
 			
 			if debugMode
 			{
-				NSLog("   MOST LIKELY REASON: File Does Not Exist.");
+				logMessage(.debug, "   MOST LIKELY REASON: File Does Not Exist.");
 			}
 		}
 	}
@@ -957,11 +1048,11 @@ class TOMFileManager : NSObject
 		}
 		else
 		{
-			NSLog("[TOMFileManager] ERROR: Could not find and copy file: '%@'.\nTo: '%@'.", filename, destinationDirectoryPath)
+			logMessage(.error, "[TOMFileManager] ERROR: Could not find and copy file: '%@'.\nTo: '%@'.", filename, destinationDirectoryPath)
 			
 			if debugMode
 			{
-				NSLog("   MOST LIKELY REASON: File was not found.");
+				logMessage(.debug, "   MOST LIKELY REASON: File was not found.");
 			}
 		}
 	}
@@ -1042,7 +1133,7 @@ class TOMFileManager : NSObject
 		
 		if debugMode
 		{
-			NSLog("[TOMFileManager] INFO: Full path of file move: '%@'.", correctedDestinationDirectoryPath)
+			logMessage(.info, "[TOMFileManager] INFO: Full path of file move: '%@'.", correctedDestinationDirectoryPath)
 		}
 		
 		
@@ -1054,7 +1145,7 @@ class TOMFileManager : NSObject
 				{
 					if debugMode
 					{
-						NSLog("[TOMFileManager] INFO: Moving file: '%@'.\nTo: '%@'.", filePath, correctedDestinationDirectoryPath)
+						logMessage(.info, "[TOMFileManager] INFO: Moving file: '%@'.\nTo: '%@'.", filePath, correctedDestinationDirectoryPath)
 					}
 					
 					try FileManager.default.moveItem(atPath: filePath, toPath: correctedDestinationDirectoryPath)
@@ -1065,39 +1156,39 @@ class TOMFileManager : NSObject
 					{
 						if debugMode
 						{
-							NSLog("[TOMFileManager] INFO: Moving file: '%@'.\nTo: '%@'.", filePath, correctedDestinationDirectoryPath);
+							logMessage(.info, "[TOMFileManager] INFO: Moving file: '%@'.\nTo: '%@'.", filePath, correctedDestinationDirectoryPath);
 						}
 						
 						try FileManager.default.moveItem(atPath: filePath, toPath: correctedDestinationDirectoryPath)
 					}
 					else
 					{
-						NSLog("[TOMFileManager] ERROR: Could not move file: '%@'.\nTo: '%@'.", filePath, correctedDestinationDirectoryPath)
+						logMessage(.error, "[TOMFileManager] ERROR: Could not move file: '%@'.\nTo: '%@'.", filePath, correctedDestinationDirectoryPath)
 						
 						if debugMode
 						{
-							NSLog("   MOST LIKELY REASON: Source is not a file");
+							logMessage(.debug, "   MOST LIKELY REASON: Source is not a file");
 						}
 					}
 				}
 			}
 			else
 			{
-				NSLog("[TOMFileManager] ERROR: Could not move file: '%@'.", filePath)
+				logMessage(.error, "[TOMFileManager] ERROR: Could not move file: '%@'.", filePath)
 				
 				if debugMode
 				{
-					NSLog("   MOST LIKELY REASON: Permissions error.");
+					logMessage(.debug, "   MOST LIKELY REASON: Permissions error.");
 				}
 			}
 		}
 		else
 		{
-			NSLog("[TOMFileManager] ERROR: Could not move file: '%@'.", filePath)
+			logMessage(.error, "[TOMFileManager] ERROR: Could not move file: '%@'.", filePath)
 			
 			if debugMode
 			{
-				NSLog("   MOST LIKELY REASON: File does not exist.");
+				logMessage(.debug, "   MOST LIKELY REASON: File does not exist.");
 			}
 		}
 	}
@@ -1134,11 +1225,11 @@ class TOMFileManager : NSObject
 		}
 		else
 		{
-			NSLog("[TOMFileManager] ERROR: Could not find and move file: '%@'.\nTo: '%@'.", filename, destinationDirectoryPath)
+			logMessage(.error, "[TOMFileManager] ERROR: Could not find and move file: '%@'.\nTo: '%@'.", filename, destinationDirectoryPath)
 			
 			if debugMode
 			{
-				NSLog("   MOST LIKELY REASON: File was not found.");
+				logMessage(.debug, "   MOST LIKELY REASON: File was not found.");
 			}
 		}
 	}
@@ -1198,7 +1289,7 @@ class TOMFileManager : NSObject
 				{
 					if debugMode
 					{
-						NSLog("[TOMFileManager] INFO: Deleting file: '%@'.", filePath);
+						logMessage(.info, "[TOMFileManager] INFO: Deleting file: '%@'.", filePath);
 					}
 					
 					try FileManager.default.removeItem(atPath: filePath)
@@ -1209,39 +1300,39 @@ class TOMFileManager : NSObject
 					{
 						if debugMode
 						{
-							NSLog("[TOMFileManager] INFO: Deleting file: '%@'.", filePath);
+							logMessage(.info, "[TOMFileManager] INFO: Deleting file: '%@'.", filePath);
 						}
 						
 						try FileManager.default.removeItem(atPath: filePath)
 					}
 					else
 					{
-						NSLog("[TOMFileManager] ERROR: Could not delete file: '%@'.", filePath)
+						logMessage(.error, "[TOMFileManager] ERROR: Could not delete file: '%@'.", filePath)
 						
 						if debugMode
 						{
-							NSLog("   MOST LIKELY REASON: Source is not a file.");
+							logMessage(.debug, "   MOST LIKELY REASON: Source is not a file.");
 						}
 					}
 				}
 			}
 			else
 			{
-				NSLog("[TOMFileManager] ERROR: Could not delete file: '%@'.", filePath)
+				logMessage(.error, "[TOMFileManager] ERROR: Could not delete file: '%@'.", filePath)
 				
 				if debugMode
 				{
-					NSLog("   MOST LIKELY REASON: Permissions error.");
+					logMessage(.debug, "   MOST LIKELY REASON: Permissions error.");
 				}
 			}
 		}
 		else
 		{
-			NSLog("[TOMFileManager] ERROR: Could not delete file: '%@'.", filePath)
+			logMessage(.error, "[TOMFileManager] ERROR: Could not delete file: '%@'.", filePath)
 			
 			if debugMode
 			{
-				NSLog("   MOST LIKELY REASON: File does not exist.");
+				logMessage(.debug, "   MOST LIKELY REASON: File does not exist.");
 			}
 		}
 	}
@@ -1273,11 +1364,11 @@ class TOMFileManager : NSObject
 		}
 		else
 		{
-			NSLog("[TOMFileManager] ERROR: Could not find and delte file: '%@'.", filename)
+			logMessage(.error, "[TOMFileManager] ERROR: Could not find and delte file: '%@'.", filename)
 			
 			if debugMode
 			{
-				NSLog("   MOST LIKELY REASON: File was not found.");
+				logMessage(.debug, "   MOST LIKELY REASON: File was not found.");
 			}
 		}
 	}
@@ -1310,7 +1401,7 @@ class TOMFileManager : NSObject
 	/**
 	Returns the number of files in a directory.
 	
-	Returns the number of files in `directoryPath`.
+	Returns the number of files in `directoryPath`. The same as `numberOfItemsInDirectory(atPath:options:)` with no options.
 	
 	```
 	let fileCount = manager.numberOfFilesInDirectory(atPath: manager.documentsDirectory)
@@ -1322,7 +1413,55 @@ class TOMFileManager : NSObject
 	*/
 	func numberOfFilesInDirectory(atPath directoryPath : String) -> Int
 	{
-		return FileManager.default.contents(atPath: directoryPath)?.count ?? 0
+		return numberOfItemsInDirectory(atPath: directoryPath, options: [])
+	}
+	
+	
+	
+	
+	/**
+	Returns the number of items in a directory that match `options`.
+	
+	Reads the directory's entries and counts them as they go by, instead of building a list of their names, so counting a directory with a million entries takes no more memory than counting one with ten. With `.recursive`, each subdirectory is counted in parallel.
+	
+	```
+	let cachesPath = (manager.libraryDirectory as NSString).appendingPathComponent("Caches")
+	let fileCount = manager.numberOfItemsInDirectory(atPath: cachesPath, options: [.recursive, .files])
+	```
+	
+	- Note: Symbolic links are counted, but never followed. Directories that can't be read are skipped.
+	
+	- Parameter directoryPath: The path you'd like to count the contents of.
+	- Parameter options: Whether to count inside subdirectories, which types of item to count, and whether to skip hidden items.
+	
+	- Returns: `Int` - The number of matching items, or 0 if `directoryPath` is not a directory.
+	*/
+	func numberOfItemsInDirectory(atPath directoryPath : String, options : TOMCountOptions) -> Int
+	{
+		var subdirectoryPaths : [String] = []
+		var count = countEntries(inDirectory: directoryPath, options: options, recursive: false) { subdirectoryPaths.append($0) }
+		
+		
+		if options.contains(.recursive) && !subdirectoryPaths.isEmpty
+		{
+			var nestedCounts = [Int](repeating: 0, count: subdirectoryPaths.count)
+			
+			nestedCounts.withUnsafeMutableBufferPointer { counts in
+				DispatchQueue.concurrentPerform(iterations: subdirectoryPaths.count) { index in
+					counts[index] = countEntries(inDirectory: subdirectoryPaths[index], options: options, recursive: true)
+				}
+			}
+			
+			count += nestedCounts.reduce(0, +)
+		}
+		
+		
+		if debugMode
+		{
+			logMessage(.info, "[TOMFileManager] INFO: Counted %ld items in directory: '%@'.", count, directoryPath)
+		}
+		
+		return count
 	}
 	
 	
@@ -1358,30 +1497,1091 @@ class TOMFileManager : NSObject
 	
 	
 	/**
-	Sets the TOMFileManager object into Debug Mode.
-	
-	Sets the TOMFileManager object into Debug Mode.
+	Reads the file at `filePath` in fixed-size chunks.
 	
-	This will log more information than just errors.
+	Reads the file at `filePath` from start to finish, handing each chunk to `block` as it's read. Only one chunk is ever held in memory, so the memory used stays the same no matter how large the file is.
 	
 	```
-	manager.setDebugMode(to: true)
+	let exampleFilePath = (manager.documentsDirectory as NSString).appendingPathComponent("example.bin")
+	try manager.readFile(atPath: exampleFilePath, chunkSize: 1024 * 1024) { chunk, stop in
+		hasher.update(data: chunk)
+	}
 	```
 	
-	- Note: By default, Debug Mode is off.
+	- Note: Every chunk is exactly `chunkSize` bytes long, except for the last one.
 	
-	- Parameter debugMode: A Boolean that if `true` sets Debug Mode on, if `false` sets Debug Mode off
+	- Warning: The same buffer is reused for every chunk, so `chunk` is only valid until `block` returns. Copy it if you need to keep it.
 	
-	- Returns: `Void` - Nothing to return.
+	- Parameter filePath: The path to the file you'd like to read.
+	- Parameter chunkSize: The number of bytes to read at a time. Pass `0` to use the default of 1 MB.
+	- Parameter block: The block to call with each chunk. Set `stop` to `true` to stop reading early.
+	
+	- Returns: `Void` - Nothing to return since errors are handled with `try` / `catch`.
 	*/
-	func setDebugMode(to debugMode : Bool)
+	func readFile(atPath filePath : String, chunkSize : Int = TOMFileChunkReader.defaultChunkSize, using block : (Data, inout Bool) throws -> Void) throws
 	{
-		if self.debugMode
+		let reader = TOMFileChunkReader(filePath: filePath, chunkSize: chunkSize)
+		var stop : Bool = false
+		
+		
+		if debugMode
 		{
-			NSLog("[TOMFileManager] INFO: Setting debug mode to: '%@'.", debugMode.description)
+			logMessage(.info, "[TOMFileManager] INFO: Reading file in %ld byte chunks: '%@'.", chunkSize, filePath)
 		}
 		
 		
-		self.debugMode = debugMode
+		while !stop, let chunk = try reader.nextChunk()
+		{
+			try block(chunk, &stop)
+		}
+	}
+	
+	
+	
+	
+	/**
+	Returns the file at `filePath` as an asynchronous sequence of fixed-size chunks.
+	
+	The file is opened when iteration starts and read on a queue of its own, one chunk ahead of the iteration, so hashing, parsing, or uploading each chunk overlaps with reading the next one, and at most two chunks are held in memory no matter how large the file is.
+	
+	```
+	let exampleFilePath = (manager.documentsDirectory as NSString).appendingPathComponent("example.bin")
+	for try await chunk in manager.chunks(ofFileAtPath: exampleFilePath)
+	{
+		try await upload(chunk)
+	}
+	```
+	
+	- Note: Every chunk is exactly `chunkSize` bytes long, except for the last one. Unlike `readFile(atPath:chunkSize:using:)`, each chunk is a copy of its own, so it can be kept.
+	
+	- Parameter filePath: The path to the file you'd like to read.
+	- Parameter chunkSize: The number of bytes to read at a time. Pass `0` to use the default of 1 MB.
+	
+	- Returns: `TOMFileChunkSequence` - A sequence of the file's chunks, which throws if the file can't be read.
+	*/
+	@available(iOS 13.0, macOS 10.15, *)
+	func chunks(ofFileAtPath filePath : String, chunkSize : Int = TOMFileChunkReader.defaultChunkSize) -> TOMFileChunkSequence
+	{
+		return TOMFileChunkSequence(filePath: filePath, chunkSize: chunkSize)
+	}
+	
+	
+	
+	
+	/**
+	Asynchronously creates a new directory at `newDirectoryPath`.
+	
+	The `async` version of `createDirectory(atPath:)`. The operation runs on this manager's operation queue, which runs at most `maximumConcurrentOperations` operations at once, so the calling task is suspended instead of blocking a thread.
+	
+	```
+	try await manager.createDirectoryAsync(atPath: newDirectoryPath)
+	```
+	
+	- Parameter newDirectoryPath: The path of the directory you'd like to create.
+	
+	- Returns: `Void` - Nothing to return since errors are handled with `try` / `catch`.
+	*/
+	@available(iOS 13.0, macOS 10.15, *)
+	func createDirectoryAsync(atPath newDirectoryPath : String) async throws
+	{
+		return try await performOperation {
+			try self.createDirectory(atPath: newDirectoryPath)
+		}
+	}
+	
+	
+	
+	
+	/**
+	Asynchronously creates a new directory named `subdirectoryName` inside `existingDirectoryPath`.
+	
+	The `async` version of `createSubdirectory(named:in:)`. The operation runs on this manager's operation queue, which runs at most `maximumConcurrentOperations` operations at once, so the calling task is suspended instead of blocking a thread.
+	
+	```
+	try await manager.createSubdirectoryAsync(named: "Downloads", in: manager.documentsDirectory)
+	```
+	
+	- Parameter subdirectoryName: The name of the directory you'd like to create.
+	- Parameter existingDirectoryPath: The path of the directory you'd like to create it in.
+	
+	- Returns: `Void` - Nothing to return since errors are handled with `try` / `catch`.
+	*/
+	@available(iOS 13.0, macOS 10.15, *)
+	func createSubdirectoryAsync(named subdirectoryName : String, in existingDirectoryPath : String) async throws
+	{
+		return try await performOperation {
+			try self.createSubdirectory(named: subdirectoryName, in: existingDirectoryPath)
+		}
+	}
+	
+	
+	
+	
+	/**
+	Asynchronously copies the directory at `sourceDirectoryPath` into `destinationDirectoryPath`.
+	
+	The `async` version of `copyDirectory(from:to:regardlessOfType:)`. The operation runs on this manager's operation queue, which runs at most `maximumConcurrentOperations` operations at once, so the calling task is suspended instead of blocking a thread.
+	
+	```
+	try await manager.copyDirectoryAsync(from: sourceDirectoryPath, to: destinationDirectoryPath)
+	```
+	
+	- Parameter sourceDirectoryPath: The path of the directory you'd like to copy.
+	- Parameter destinationDirectoryPath: The path of the directory you'd like to copy it into.
+	- Parameter ignoreType: If `true`, continue with copying, even if `sourceDirectoryPath` is not a directory. Defaults to `false`.
+	
+	- Returns: `Void` - Nothing to return since errors are handled with `try` / `catch`.
+	*/
+	@available(iOS 13.0, macOS 10.15, *)
+	func copyDirectoryAsync(from sourceDirectoryPath : String, to destinationDirectoryPath : String, regardlessOfType ignoreType : Bool = false) async throws
+	{
+		return try await performOperation {
+			try self.copyDirectory(from: sourceDirectoryPath, to: destinationDirectoryPath, regardlessOfType: ignoreType)
+		}
+	}
+	
+	
+	
+	
+	/**
+	Asynchronously moves the directory at `sourceDirectoryPath` into `destinationDirectoryPath`.
+	
+	The `async` version of `moveDirectory(from:to:regardlessOfType:)`. The operation runs on this manager's operation queue, which runs at most `maximumConcurrentOperations` operations at once, so the calling task is suspended instead of blocking a thread.
+	
+	```
+	try await manager.moveDirectoryAsync(from: sourceDirectoryPath, to: destinationDirectoryPath)
+	```
+	
+	- Parameter sourceDirectoryPath: The path of the directory you'd like to move.
+	- Parameter destinationDirectoryPath: The path of the directory you'd like to move it into.
+	- Parameter ignoreType: If `true`, continue with moving, even if `sourceDirectoryPath` is not a directory. Defaults to `false`.
+	
+	- Returns: `Void` - Nothing to return since errors are handled with `try` / `catch`.
+	*/
+	@available(iOS 13.0, macOS 10.15, *)
+	func moveDirectoryAsync(from sourceDirectoryPath : String, to destinationDirectoryPath : String, regardlessOfType ignoreType : Bool = false) async throws
+	{
+		return try await performOperation {
+			try self.moveDirectory(from: sourceDirectoryPath, to: destinationDirectoryPath, regardlessOfType: ignoreType)
+		}
+	}
+	
+	
+	
+	
+	/**
+	Asynchronously renames the directory at `directoryPath` to `newName`.
+	
+	The `async` version of `renameDirectory(atPath:to:regardlessOfType:)`. The operation runs on this manager's operation queue, which runs at most `maximumConcurrentOperations` operations at once, so the calling task is suspended instead of blocking a thread.
+	
+	```
+	try await manager.renameDirectoryAsync(atPath: directoryPath, to: "RenamedDirectory")
+	```
+	
+	- Parameter directoryPath: The path of the directory you'd like to rename.
+	- Parameter newName: The new name you'd like to give the directory.
+	- Parameter ignoreType: If `true`, continue with renaming even if the `directoryPath` is not a directory. Defaults to `false`.
+	
+	- Returns: `Void` - Nothing to return since errors are handled with `try` / `catch`.
+	*/
+	@available(iOS 13.0, macOS 10.15, *)
+	func renameDirectoryAsync(atPath directoryPath : String, to newName : String, regardlessOfType ignoreType : Bool = false) async throws
+	{
+		return try await performOperation {
+			try self.renameDirectory(atPath: directoryPath, to: newName, regardlessOfType: ignoreType)
+		}
+	}
+	
+	
+	
+	
+	/**
+	Asynchronously renames the directory at `directoryPath` to `newName`, using `options`.
+	
+	The `async` version of `renameDirectory(atPath:to:options:)`. The operation runs on this manager's operation queue, which runs at most `maximumConcurrentOperations` operations at once, so the calling task is suspended instead of blocking a thread.
+	
+	```
+	try await manager.renameDirectoryAsync(atPath: stagingDirectoryPath, to: "Live", options: .exchange)
+	```
+	
+	- Parameter directoryPath: The path of the directory you'd like to rename.
+	- Parameter newName: The new name you'd like to give the directory.
+	- Parameter options: Whether an existing directory named `newName` may be replaced, or should be exchanged with.
+	
+	- Returns: `Void` - Nothing to return since errors are handled with `try` / `catch`.
+	*/
+	@available(iOS 13.0, macOS 10.15, *)
+	func renameDirectoryAsync(atPath directoryPath : String, to newName : String, options : TOMRenameOptions) async throws
+	{
+		return try await performOperation {
+			try self.renameDirectory(atPath: directoryPath, to: newName, options: options)
+		}
+	}
+	
+	
+	
+	
+	/**
+	Asynchronously deletes the directory at `directoryPath`.
+	
+	The `async` version of `deleteDirectory(atPath:regardlessOfType:)`. The operation runs on this manager's operation queue, which runs at most `maximumConcurrentOperations` operations at once, so the calling task is suspended instead of blocking a thread.
+	
+	```
+	try await manager.deleteDirectoryAsync(atPath: directoryPath)
+	```
+	
+	- Parameter directoryPath: The path of the directory you'd like to delete.
+	- Parameter ignoreType: If `true`, continue with deleting, even if `directoryPath` is not a directory. Defaults to `false`.
+	
+	- Returns: `Void` - Nothing to return since errors are handled with `try` / `catch`.
+	*/
+	@available(iOS 13.0, macOS 10.15, *)
+	func deleteDirectoryAsync(atPath directoryPath : String, regardlessOfType ignoreType : Bool = false) async throws
+	{
+		return try await performOperation {
+			try self.deleteDirectory(atPath: directoryPath, regardlessOfType: ignoreType)
+		}
+	}
+	
+	
+	
+	
+	/**
+	Asynchronously returns the path of a file named `filename` in the directory `directoryPath`.
+	
+	The `async` version of `getPathForFile(named:inDirectory:)`. The operation runs on this manager's operation queue, which runs at most `maximumConcurrentOperations` operations at once, so the calling task is suspended instead of blocking a thread.
+	
+	```
+	let fullPath = try await manager.getPathForFileAsync(named: "sample.png", inDirectory: manager.documentsDirectory)
+	```
+	
+	- Parameter filename: The name of the file who's full path you'd like to retrieve.
+	- Parameter directoryPath: The path of the directory which contains the file `filename`.
+	
+	- Returns: `String` - The full path of the desired file, or `nil` if it wasn't found.
+	*/
+	@available(iOS 13.0, macOS 10.15, *)
+	func getPathForFileAsync(named filename : String, inDirectory directoryPath : String) async throws -> String?
+	{
+		return try await performOperation {
+			try self.getPathForFile(named: filename, inDirectory: directoryPath)
+		}
+	}
+	
+	
+	
+	
+	/**
+	Asynchronously searches the sandbox for a file named `filename`.
+	
+	The `async` version of `findAndGetPathForFile(named:)`. The operation runs on this manager's operation queue, which runs at most `maximumConcurrentOperations` operations at once, so the calling task is suspended instead of blocking a thread.
+	
+	```
+	let exampleFilePath = try await manager.findAndGetPathForFileAsync(named: "sample.png")
+	```
+	
+	- Parameter filename: The name of the file you'd like to find.
+	
+	- Returns: `String` - The full path of the desired file, or `nil` if it wasn't found.
+	*/
+	@available(iOS 13.0, macOS 10.15, *)
+	func findAndGetPathForFileAsync(named filename : String) async throws -> String?
+	{
+		return try await performOperation {
+			try self.findAndGetPathForFile(named: filename)
+		}
+	}
+	
+	
+	
+	
+	/**
+	Asynchronously copies the file at `filePath` into `destinationDirectoryPath`.
+	
+	The `async` version of `copyFile(atPath:to:regardlessOfType:)`. The operation runs on this manager's operation queue, which runs at most `maximumConcurrentOperations` operations at once, so the calling task is suspended instead of blocking a thread.
+	
+	```
+	try await manager.copyFileAsync(atPath: exampleFilePath, to: manager.tempDirectory)
+	```
+	
+	- Parameter filePath: The path of the file you'd like to copy.
+	- Parameter destinationDirectoryPath: The path of the directory you'd like to copy it into.
+	- Parameter ignoreType: If `true`, continue with copying, even if `filePath` is not a file. Defaults to `false`.
+	
+	- Returns: `Void` - Nothing to return since errors are handled with `try` / `catch`.
+	*/
+	@available(iOS 13.0, macOS 10.15, *)
+	func copyFileAsync(atPath filePath : String, to destinationDirectoryPath : String, regardlessOfType ignoreType : Bool = false) async throws
+	{
+		return try await performOperation {
+			try self.copyFile(atPath: filePath, to: destinationDirectoryPath, regardlessOfType: ignoreType)
+		}
+	}
+	
+	
+	
+	
+	/**
+	Asynchronously searches the sandbox for a file named `filename`, and copies it into `destinationDirectoryPath`.
+	
+	The `async` version of `findAndCopyFile(named:to:)`. The operation runs on this manager's operation queue, which runs at most `maximumConcurrentOperations` operations at once, so the calling task is suspended instead of blocking a thread.
+	
+	```
+	try await manager.findAndCopyFileAsync(named: "sample.png", to: manager.tempDirectory)
+	```
+	
+	- Parameter filename: The name of the file you'd like to find and copy.
+	- Parameter destinationDirectoryPath: The path of the directory you'd like to copy it into, once found.
+	
+	- Returns: `Void` - Nothing to return since errors are handled with `try` / `catch`.
+	*/
+	@available(iOS 13.0, macOS 10.15, *)
+	func findAndCopyFileAsync(named filename : String, to destinationDirectoryPath : String) async throws
+	{
+		return try await performOperation {
+			try self.findAndCopyFile(named: filename, to: destinationDirectoryPath)
+		}
+	}
+	
+	
+	
+	
+	/**
+	Asynchronously moves the file at `filePath` into `destinationDirectoryPath`.
+	
+	The `async` version of `moveFile(atPath:to:regardlessOfType:)`. The operation runs on this manager's operation queue, which runs at most `maximumConcurrentOperations` operations at once, so the calling task is suspended instead of blocking a thread.
+	
+	```
+	try await manager.moveFileAsync(atPath: exampleFilePath, to: manager.tempDirectory)
+	```
+	
+	- Parameter filePath: The path of the file you'd like to move.
+	- Parameter destinationDirectoryPath: The path of the directory you'd like to move it into.
+	- Parameter ignoreType: If `true`, continue with moving, even if `filePath` is not a file. Defaults to `false`.
+	
+	- Returns: `Void` - Nothing to return since errors are handled with `try` / `catch`.
+	*/
+	@available(iOS 13.0, macOS 10.15, *)
+	func moveFileAsync(atPath filePath : String, to destinationDirectoryPath : String, regardlessOfType ignoreType : Bool = false) async throws
+	{
+		return try await performOperation {
+			try self.moveFile(atPath: filePath, to: destinationDirectoryPath, regardlessOfType: ignoreType)
+		}
+	}
+	
+	
+	
+	
+	/**
+	Asynchronously searches the sandbox for a file named `filename`, and moves it into `destinationDirectoryPath`.
+	
+	The `async` version of `findAndMoveFile(named:to:)`. The operation runs on this manager's operation queue, which runs at most `maximumConcurrentOperations` operations at once, so the calling task is suspended instead of blocking a thread.
+	
+	```
+	try await manager.findAndMoveFileAsync(named: "sample.png", to: manager.tempDirectory)
+	```
+	
+	- Parameter filename: The name of the file you'd like to find and move.
+	- Parameter destinationDirectoryPath: The path of the directory you'd like to move it into, once found.
+	
+	- Returns: `Void` - Nothing to return since errors are handled with `try` / `catch`.
+	*/
+	@available(iOS 13.0, macOS 10.15, *)
+	func findAndMoveFileAsync(named filename : String, to destinationDirectoryPath : String) async throws
+	{
+		return try await performOperation {
+			try self.findAndMoveFile(named: filename, to: destinationDirectoryPath)
+		}
+	}
+	
+	
+	
+	
+	/**
+	Asynchronously deletes the file at `filePath`.
+	
+	The `async` version of `deleteFile(atPath:regardlessOfType:)`. The operation runs on this manager's operation queue, which runs at most `maximumConcurrentOperations` operations at once, so the calling task is suspended instead of blocking a thread.
+	
+	```
+	try await manager.deleteFileAsync(atPath: exampleFilePath)
+	```
+	
+	- Parameter filePath: The path of the file you'd like to delete.
+	- Parameter ignoreType: If `true`, continue with deleting, even if `filePath` is not a file. Defaults to `false`.
+	
+	- Returns: `Void` - Nothing to return since errors are handled with `try` / `catch`.
+	*/
+	@available(iOS 13.0, macOS 10.15, *)
+	func deleteFileAsync(atPath filePath : String, regardlessOfType ignoreType : Bool = false) async throws
+	{
+		return try await performOperation {
+			try self.deleteFile(atPath: filePath, regardlessOfType: ignoreType)
+		}
+	}
+	
+	
+	
+	
+	/**
+	Asynchronously searches the sandbox for a file named `filename`, and deletes it.
+	
+	The `async` version of `findAndDeleteFile(named:)`. The operation runs on this manager's operation queue, which runs at most `maximumConcurrentOperations` operations at once, so the calling task is suspended instead of blocking a thread.
+	
+	```
+	try await manager.findAndDeleteFileAsync(named: "sample.png")
+	```
+	
+	- Parameter filename: The name of the file you'd like to find and delete.
+	
+	- Returns: `Void` - Nothing to return since errors are handled with `try` / `catch`.
+	*/
+	@available(iOS 13.0, macOS 10.15, *)
+	func findAndDeleteFileAsync(named filename : String) async throws
+	{
+		return try await performOperation {
+			try self.findAndDeleteFile(named: filename)
+		}
+	}
+	
+	
+	
+	
+	/**
+	Asynchronously returns the number of items in a directory that match `options`.
+	
+	The `async` version of `numberOfItemsInDirectory(atPath:options:)`. The operation runs on this manager's operation queue, which runs at most `maximumConcurrentOperations` operations at once, so the calling task is suspended instead of blocking a thread.
+	
+	```
+	let fileCount = await manager.numberOfItemsInDirectoryAsync(atPath: cachesPath, options: [.recursive, .files])
+	```
+	
+	- Parameter directoryPath: The path you'd like to count the contents of.
+	- Parameter options: Whether to count inside subdirectories, which types of item to count, and whether to skip hidden items.
+	
+	- Returns: `Int` - The number of matching items, or 0 if `directoryPath` is not a directory.
+	*/
+	@available(iOS 13.0, macOS 10.15, *)
+	func numberOfItemsInDirectoryAsync(atPath directoryPath : String, options : TOMCountOptions) async -> Int
+	{
+		return await withCheckedContinuation { continuation in
+			operationQueue.addOperation {
+				continuation.resume(returning: self.numberOfItemsInDirectory(atPath: directoryPath, options: options))
+			}
+		}
+	}
+	
+	
+	
+	
+	/**
+	Asynchronously reads the contents of the file at `filePath`.
+	
+	The `async` version of `retrieveDataForFile(atPath:)`. The operation runs on this manager's operation queue, which runs at most `maximumConcurrentOperations` operations at once, so the calling task is suspended instead of blocking a thread.
+	
+	```
+	let data = await manager.retrieveDataForFileAsync(atPath: exampleFilePath)
+	```
+	
+	- Parameter filePath: The path of the file you'd like to read.
+	
+	- Returns: `NSData` - The contents of the file, or `nil` if it couldn't be read.
+	*/
+	@available(iOS 13.0, macOS 10.15, *)
+	func retrieveDataForFileAsync(atPath filePath : String) async -> NSData?
+	{
+		return await withCheckedContinuation { continuation in
+			operationQueue.addOperation {
+				continuation.resume(returning: self.retrieveDataForFile(atPath: filePath))
+			}
+		}
+	}
+	
+	
+	
+	
+	/**
+	Runs `operation` on the manager's operation queue, and suspends the calling task until it has finished.
+	*/
+	@available(iOS 13.0, macOS 10.15, *)
+	private func performOperation<T>(_ operation : @escaping () throws -> T) async throws -> T
+	{
+		return try await withCheckedThrowingContinuation { continuation in
+			operationQueue.addOperation {
+				continuation.resume(with: Result { try operation() })
+			}
+		}
+	}
+	
+	
+	
+	
+	/**
+	Renames `sourcePath` to `destinationPath` with a single `renamex_np` call.
+	*/
+	private func renameItem(atPath sourcePath : String, toPath destinationPath : String, options : TOMRenameOptions) throws
+	{
+		var renameFlags : UInt32 = 0
+		
+		
+		if options.contains(.noReplace)
+		{
+			renameFlags |= UInt32(RENAME_EXCL)
+		}
+		
+		if options.contains(.exchange)
+		{
+			renameFlags |= UInt32(RENAME_SWAP)
+		}
+		
+		
+		if renamex_np(sourcePath, destinationPath, renameFlags) != 0
+		{
+			let renameError = errno
+			
+			logMessage(.error, "[TOMFileManager] ERROR: Could not rename: '%@'.", sourcePath)
+			
+			throw POSIXError(POSIXErrorCode(rawValue: renameError) ?? .EIO)
+		}
+	}
+	
+	
+	
+	
+	/**
+	Counts the entries of `directoryPath` that match `options` with `readdir`, without building any names but those of the directories it still has to read.
+	
+	Without `recursive`, each subdirectory is handed to `foundSubdirectory` instead of being read.
+	*/
+	private func countEntries(inDirectory directoryPath : String, options : TOMCountOptions, recursive : Bool, foundSubdirectory : ((String) -> Void)? = nil) -> Int
+	{
+		let nameOffset = MemoryLayout<dirent>.offset(of: \dirent.d_name)!
+		let typeOptions = options.intersection([.files, .directories, .symbolicLinks])
+		var pendingPaths : [String] = [directoryPath]
+		var count = 0
+		
+		
+		while let path = pendingPaths.popLast()
+		{
+			guard let directory = opendir(path) else
+			{
+				continue
+			}
+			
+			
+			while let entry = readdir(directory)
+			{
+				let name = UnsafeRawPointer(entry).advanced(by: nameOffset).assumingMemoryBound(to: CChar.self)
+				let nameLength = Int(entry.pointee.d_namlen)
+				var type = Int32(entry.pointee.d_type)
+				
+				if name[0] == 0x2E && (nameLength == 1 || (nameLength == 2 && name[1] == 0x2E))
+				{
+					continue
+				}
+				
+				if options.contains(.skipHiddenFiles) && name[0] == 0x2E
+				{
+					continue
+				}
+				
+				
+				let entryPath = (type == DT_DIR || type == DT_UNKNOWN) ? (path as NSString).appendingPathComponent(String(cString: name)) : nil
+				
+				if type == DT_UNKNOWN, let entryPath = entryPath
+				{
+					var entryStat = stat()
+					
+					if lstat(entryPath, &entryStat) == 0
+					{
+						type = Int32((entryStat.st_mode & S_IFMT) >> 12)
+					}
+				}
+				
+				
+				switch type
+				{
+					case DT_REG:
+						count += (typeOptions.isEmpty || typeOptions.contains(.files)) ? 1 : 0
+					
+					case DT_DIR:
+						count += (typeOptions.isEmpty || typeOptions.contains(.directories)) ? 1 : 0
+					
+					case DT_LNK:
+						count += (typeOptions.isEmpty || typeOptions.contains(.symbolicLinks)) ? 1 : 0
+					
+					default:
+						count += typeOptions.isEmpty ? 1 : 0
+				}
+				
+				
+				if type == DT_DIR, let entryPath = entryPath
+				{
+					if recursive
+					{
+						pendingPaths.append(entryPath)
+					}
+					else
+					{
+						foundSubdirectory?(entryPath)
+					}
+				}
+			}
+			
+			closedir(directory)
+		}
+		
+		
+		return count
+	}
+	
+	
+	
+	
+	/**
+	Checks if `url` points at a file named `filename`.
+	
+	Compares the last path component - and, if `filename` has more than one component, the end of the path - rather than the percent-encoded URL string, so names with spaces match and `xfoo.png` doesn't match `foo.png`.
+	
+	- Parameter url: The URL of the directory entry being checked.
+	- Parameter filename: The name of the file being searched for.
+	
+	- Returns: `Bool` - `true` if the entry is the file being searched for.
+	*/
+	private func fileURL(_ url : URL, matchesFilename filename : String) -> Bool
+	{
+		if url.lastPathComponent != (filename as NSString).lastPathComponent
+		{
+			return false
+		}
+		
+		if filename.contains("/")
+		{
+			return url.path.hasSuffix(filename.hasPrefix("/") ? filename : "/" + filename)
+		}
+		
+		return true
+	}
+	
+	
+	
+	
+	/**
+	Sets the TOMFileManager object into Debug Mode.
+	
+	Sets the TOMFileManager object into Debug Mode.
+	
+	This will log more information than just errors.
+	
+	```
+	manager.setDebugMode(to: true)
+	```
+	
+	- Note: By default, Debug Mode is off.
+	
+	- Parameter debugMode: A Boolean that if `true` sets Debug Mode on, if `false` sets Debug Mode off
+	
+	- Returns: `Void` - Nothing to return.
+	*/
+	func setDebugMode(to debugMode : Bool)
+	{
+		self.debugMode = debugMode
+		
+		logMessage(.info, "[TOMFileManager] INFO: Setting debug mode to: '%@'.", debugMode.description)
+	}
+	
+	
+	
+	
+	/**
+	Hands a message to `TOMLog` if `level` is enabled for this manager. The arguments are only formatted into the message on the logging queue.
+	*/
+	private func logMessage(_ level : TOMLogLevel, _ format : String, _ arguments : CVarArg...)
+	{
+		if level <= TOMLog.maximumLevel && level <= logLevel
+		{
+			TOMLog.write(level, format, arguments)
+		}
+	}
+}
+
+
+
+
+
+/**
+# TOMFileChunkReader
+Reads a file one chunk at a time into a single buffer that is reused for every chunk.
+
+Each chunk it returns is a view of that buffer, so it is only valid until the next chunk is read.
+*/
+final class TOMFileChunkReader
+{
+	/// The chunk size used when a caller doesn't pick one
+	static let defaultChunkSize : Int = 1024 * 1024
+	
+	
+	private let filePath : String
+	private let chunkSize : Int
+	private let buffer : UnsafeMutableRawPointer
+	private var fileDescriptor : Int32 = -1
+	private var finished : Bool = false
+	
+	
+	
+	
+	init(filePath : String, chunkSize : Int)
+	{
+		self.filePath = filePath
+		self.chunkSize = (chunkSize > 0) ? chunkSize : TOMFileChunkReader.defaultChunkSize
+		self.buffer = UnsafeMutableRawPointer.allocate(byteCount: self.chunkSize, alignment: 16)
+	}
+	
+	
+	
+	
+	deinit
+	{
+		if fileDescriptor >= 0
+		{
+			close(fileDescriptor)
+		}
+		
+		buffer.deallocate()
+	}
+	
+	
+	
+	
+	/**
+	Reads the next chunk of the file.
+	
+	- Returns: `Data` - The next chunk, or `nil` once the whole file has been read.
+	*/
+	func nextChunk() throws -> Data?
+	{
+		if finished
+		{
+			return nil
+		}
+		
+		
+		if fileDescriptor < 0
+		{
+			fileDescriptor = open(filePath, O_RDONLY | O_CLOEXEC)
+			
+			if fileDescriptor < 0
+			{
+				let openError = errno
+				finished = true
+				TOMLog.write(.error, "[TOMFileManager] ERROR: Could not read file: '%@'.", [filePath])
+				
+				throw POSIXError(POSIXErrorCode(rawValue: openError) ?? .EIO)
+			}
+		}
+		
+		
+		var bytesRead : Int = 0
+		
+		// Fill the whole chunk, so that every chunk but the last is exactly chunkSize long
+		while bytesRead < chunkSize
+		{
+			let result = read(fileDescriptor, buffer + bytesRead, chunkSize - bytesRead)
+			
+			if result < 0
+			{
+				if errno == EINTR
+				{
+					continue
+				}
+				
+				let readError = errno
+				finished = true
+				TOMLog.write(.error, "[TOMFileManager] ERROR: Could not read file: '%@'.", [filePath])
+				
+				throw POSIXError(POSIXErrorCode(rawValue: readError) ?? .EIO)
+			}
+			
+			if result == 0
+			{
+				finished = true
+				break
+			}
+			
+			bytesRead += result
+		}
+		
+		
+		if bytesRead == 0
+		{
+			return nil
+		}
+		
+		return Data(bytesNoCopy: buffer, count: bytesRead, deallocator: .none)
+	}
+}
+
+
+
+
+
+/**
+# TOMFileChunkSequence
+An asynchronous sequence of the fixed-size chunks of a file, returned by `TOMFileManager.chunks(ofFileAtPath:chunkSize:)`.
+*/
+@available(iOS 13.0, macOS 10.15, *)
+struct TOMFileChunkSequence : AsyncSequence
+{
+	typealias Element = Data
+	
+	
+	let filePath : String
+	let chunkSize : Int
+	
+	
+	
+	
+	struct AsyncIterator : AsyncIteratorProtocol
+	{
+		fileprivate let prefetcher : TOMFileChunkPrefetcher
+		
+		
+		func next() async throws -> Data?
+		{
+			return try await prefetcher.next()
+		}
+	}
+	
+	
+	
+	
+	func makeAsyncIterator() -> AsyncIterator
+	{
+		return AsyncIterator(prefetcher: TOMFileChunkPrefetcher(reader: TOMFileChunkReader(filePath: filePath, chunkSize: chunkSize)))
+	}
+}
+
+
+
+
+
+/**
+# TOMFileChunkPrefetcher
+Reads a `TOMFileChunkReader` on a serial queue of its own, one chunk ahead of whoever is asking for them.
+
+The blocking reads never run on the cooperative thread pool, and each chunk is copied out of the reader's buffer, so it stays valid while the next one is read into it.
+*/
+@available(iOS 13.0, macOS 10.15, *)
+private final class TOMFileChunkPrefetcher
+{
+	private let reader : TOMFileChunkReader
+	private let queue = DispatchQueue(label: "TOMFileManager.chunks", qos: .utility)
+	
+	// Only touched on `queue`
+	private var readAhead : Result<Data?, Error>? = nil
+	
+	
+	
+	
+	init(reader : TOMFileChunkReader)
+	{
+		self.reader = reader
+	}
+	
+	
+	
+	
+	func next() async throws -> Data?
+	{
+		return try await withCheckedThrowingContinuation { continuation in
+			queue.async {
+				let result = self.readAhead ?? self.readChunk()
+				self.readAhead = nil
+				
+				continuation.resume(with: result)
+				
+				// Read the next chunk while the caller works on this one. It's done in this same block, so the next call
+				// to next() can't be queued in front of it.
+				if case .success(.some) = result
+				{
+					self.readAhead = self.readChunk()
+				}
+			}
+		}
+	}
+	
+	
+	
+	
+	private func readChunk() -> Result<Data?, Error>
+	{
+		return Result {
+			try reader.nextChunk().map { chunk in
+				chunk.withUnsafeBytes { Data($0) }
+			}
+		}
+	}
+}
+
+
+
+
+
+/**
+# TOMRenameOptions
+Options for `TOMFileManager.renameDirectory(atPath:to:options:)`. With no options, an existing empty directory with the new name is replaced.
+*/
+struct TOMRenameOptions : OptionSet
+{
+	let rawValue : UInt
+	
+	
+	/// The rename fails if anything with the new name already exists
+	static let noReplace = TOMRenameOptions(rawValue: 1 << 0)
+	
+	/// The directory and whatever has the new name swap places in one atomic step. Both must exist.
+	static let exchange = TOMRenameOptions(rawValue: 1 << 1)
+}
+
+
+
+
+
+/**
+# TOMCountOptions
+Options for `TOMFileManager.numberOfItemsInDirectory(atPath:options:)`. If none of `.files`, `.directories`, or `.symbolicLinks` is set, every type of item is counted.
+*/
+struct TOMCountOptions : OptionSet
+{
+	let rawValue : UInt
+	
+	
+	/// Items inside subdirectories are counted too
+	static let recursive = TOMCountOptions(rawValue: 1 << 0)
+	
+	/// Regular files are counted
+	static let files = TOMCountOptions(rawValue: 1 << 1)
+	
+	/// Directories are counted
+	static let directories = TOMCountOptions(rawValue: 1 << 2)
+	
+	/// Symbolic links are counted
+	static let symbolicLinks = TOMCountOptions(rawValue: 1 << 3)
+	
+	/// Items whose names begin with a period aren't counted, and neither is anything inside them
+	static let skipHiddenFiles = TOMCountOptions(rawValue: 1 << 4)
+}
+
+
+
+
+
+/**
+# TOMLogLevel
+How much a `TOMFileManager` logs.
+*/
+enum TOMLogLevel : Int, Comparable
+{
+	/// Nothing is logged
+	case none = 0
+	
+	/// Only errors are logged
+	case error
+	
+	/// Errors, and what each method is doing, are logged
+	case info
+	
+	/// Everything is logged, including the most likely reason for each error
+	case debug
+	
+	
+	static func < (lhs : TOMLogLevel, rhs : TOMLogLevel) -> Bool
+	{
+		return lhs.rawValue < rhs.rawValue
+	}
+}
+
+
+
+
+
+/**
+# TOMLog
+Formats log messages and hands them to `handler` on a background queue, so a method that logs never waits on `NSLog`.
+
+Messages are queued on a serial dispatch queue, which takes them without locking, and are delivered one at a time and in order.
+
+Building with `-D TOM_LOG_ERRORS_ONLY` compiles out every message above `.error`.
+*/
+enum TOMLog
+{
+	#if TOM_LOG_ERRORS_ONLY
+	/// Messages above this level are never logged
+	static let maximumLevel : TOMLogLevel = .error
+	#else
+	/// Messages above this level are never logged
+	static let maximumLevel : TOMLogLevel = .debug
+	#endif
+	
+	
+	private static let queue = DispatchQueue(label: "TOMFileManager.log", qos: .utility)
+	
+	private static var handler : ((TOMLogLevel, String) -> Void)? = nil
+	
+	
+	
+	
+	/**
+	Sets the block every log message is handed to, or goes back to `NSLog` if `handler` is `nil`.
+	
+	```
+	TOMLog.setHandler { level, message in
+		os_log("%{public}@", message)
+	}
+	```
+	
+	- Note: The handler is shared by every `TOMFileManager` in the process, and is called on a background queue.
+	
+	- Parameter handler: The block to hand log messages to.
+	*/
+	static func setHandler(_ handler : ((TOMLogLevel, String) -> Void)?)
+	{
+		queue.sync
+		{
+			self.handler = handler
+		}
+	}
+	
+	
+	
+	
+	/**
+	Waits until every log message so far has been handed to the handler.
+	*/
+	static func flush()
+	{
+		queue.sync {}
+	}
+	
+	
+	
+	
+	/**
+	Formats `format` with `arguments` on the logging queue, and hands the result to the handler.
+	*/
+	static func write(_ level : TOMLogLevel, _ format : String, _ arguments : [CVarArg])
+	{
+		queue.async
+		{
+			let message = String(format: format, arguments: arguments)
+			
+			if let handler = handler
+			{
+				handler(level, message)
+			}
+			else
+			{
+				NSLog("%@", message)
+			}
+		}
 	}
 }